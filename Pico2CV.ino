@@ -9,7 +9,6 @@
 #define CV4_PWM_PIN 5   // Envelope
 // Adjust pins as needed for your hardware
 // --- Audio & DSP ---
-#include <Adafruit_NeoPixel.h>
 
 
 #include "src/dsp/adsr.h"
@@ -21,6 +20,8 @@
 
 // --- Sequencer ---
 #include "src/sequencer/Sequencer.h"
+#include "src/audio/CVOutput.h"
+#include "src/audio/AudioEngine.h"
 
 #include <Melopero_VL53L1X.h>
 
@@ -36,6 +37,19 @@
 // --- Touch Matrix ---
 #include "src/matrix/Matrix.h"
 #include <Adafruit_MPR121.h> // https://github.com/adafruit/Adafruit_MPR121_Library
+
+// --- Profiling ---
+#include "src/profiler/Profiler.h"
+
+// --- Persistence ---
+#include "src/state/SystemState.h"
+#include "src/storage/PicoFlash.h"
+#include "src/storage/Persistence.h"
+
+// --- Step LEDs ---
+#include "src/LEDMatrix/ledMatrix.h"
+#include "src/LEDMatrix/PioLedTransmitter.h"
+#include "src/LEDMatrix/LedUi.h"
  // -----------------------------------------------------------------------------
 // 2. CONSTANTS & GLOBALS
 // -----------------------------------------------------------------------------
@@ -50,11 +64,40 @@ Melopero_VL53L1X sensor;
 
 #define IRQ_PIN 1
 
-#define NOTE_LENGTH    12 // min: 1 max: 23 DO NOT EDIT BEYOND!!! 12 = 50% on 96ppqn, same as original \
-     // tb303. 62.5% for triplets time signature
-
 // --- Sequencer ---
 Sequencer seq;
+CVOutput cvOutput;
+
+// --- Persistence ---
+// Flash writes run on core 1; core 0 (audio) is parked while they do
+void pauseAudioCore() { rp2040.idleOtherCore(); }
+void resumeAudioCore() { rp2040.resumeOtherCore(); }
+
+PicoFlash flash(PicoFlash::defaultOffset(), PERSIST_FLASH_SECTORS,
+                pauseAudioCore, resumeAudioCore);
+Persistence persistence(flash, seq, SystemState::getInstance().getQuantizer());
+
+// Factory pattern: scale degree, velocity (0-127) and filter (Hz) per step
+struct FactoryStep {
+  uint8_t note;
+  uint8_t velocity;
+  float filter;
+};
+
+const FactoryStep FACTORY_PATTERN[SEQUENCER_NUM_STEPS] = {
+    {0, 64, 1222.f}, {0, 64, 1222.f}, {1, 64, 1000.f}, {2, 64, 888.f},
+    {0, 64, 700.f},  {1, 64, 700.f},  {2, 64, 888.f},  {3, 64, 700.f},
+    {4, 64, 888.f},  {5, 64, 700.f},  {6, 64, 700.f},  {7, 64, 700.f},
+    {8, 64, 500.f},  {9, 64, 700.f},  {10, 64, 700.f}, {11, 64, 700.f},
+};
+
+void loadFactoryPattern() {
+  for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; i++) {
+    seq.setStepNote(i, FACTORY_PATTERN[i].note);
+    seq.setStepVelocity(i, FACTORY_PATTERN[i].velocity);
+    seq.setStepFiltFreq(i, FACTORY_PATTERN[i].filter);
+  }
+}
 
 // --- MIDI & Clock ---
 Adafruit_USBD_MIDI raw_usb_midi;
@@ -67,6 +110,11 @@ uint8_t bpm_blink_timer = 1;
 const int PIN_TOUCH_IRQ = 6;
 Adafruit_MPR121 touchSensor = Adafruit_MPR121();
 
+// --- Step LEDs ---
+PioLedTransmitter ledOutput(LEDMatrix::DATA_PIN);
+LEDMatrix ledMatrix(ledOutput);
+LedUi ledUi(ledMatrix);
+
 // --- Multicore Counication ---
 volatile int note1 = 48, note2 = 48;
 volatile bool  trigenv1, trigenv2, dualEnvFlag;
@@ -289,24 +337,15 @@ void onStepCallback(uint32_t step) { // uClock provides the current step number
   // Access current step data
   const Step& currentStep = seq.getStep(wrapped_step);
 
-  // Helper lambdas for mapping to PWM (0–65535 for 0–5V)
-  auto mapToPWM = [](float norm) -> uint16_t {
-    if (norm < 0.0f) norm = 0.0f;
-    if (norm > 1.0f) norm = 1.0f;
-    return static_cast<uint16_t>(norm * 65535.0f);
-  };
-  // Pitch mapping: map note (0–24) to 0–5V (full range)
-  auto noteToPWM = [](int note) -> uint16_t {
-    float v = (note < 0) ? 0.0f : (note > 24 ? 1.0f : note / 24.0f);
-    return static_cast<uint16_t>(v * 65535.0f);
-  };
-
-  // CV1: Pitch
-  analogWrite(CV1_PWM_PIN, noteToPWM(currentStep.note));
+  // CV1: Pitch, 1V/octave over the 0-5V range; the step holds a scale
+  // degree, so it goes through the quantizer to a semitone offset first
+  const int semitone = SystemState::getInstance().getQuantizer().getNote(currentStep.note);
+  analogWrite(CV1_PWM_PIN, cvOutput.process(CV_CHANNEL_PITCH,
+                                            semitone / static_cast<float>(PITCH_CV_RANGE_SEMITONES)));
   // CV2: Velocity
-  analogWrite(CV2_PWM_PIN, mapToPWM(currentStep.velocity));
-  // CV3: Filter
-  analogWrite(CV3_PWM_PIN, mapToPWM(currentStep.filter));
+  analogWrite(CV2_PWM_PIN, cvOutput.process(CV_CHANNEL_VELOCITY, currentStep.velocity));
+  // CV3: Filter, stored in Hz
+  analogWrite(CV3_PWM_PIN, cvOutput.process(CV_CHANNEL_FILTER, currentStep.filter / FILTER_CV_MAX_HZ));
 
   // --- One-shot parameter record at the beginning of each step ---
   static int lastStepIndex = -1;
@@ -325,8 +364,9 @@ void initEnvelopeTriggers() {
 
 
 void setup() {
-analogWriteFreq(120000);
-analogWriteResolution(16);
+analogWriteFreq(CV_PWM_FREQUENCY);
+analogWriteRange(CV_PWM_RANGE);
+cvOutput.setRange(CV_PWM_RANGE);
 
 initEnvelopeTriggers();
 }
@@ -396,49 +436,16 @@ Serial.print(" CORE1 SETUP1 ... ");
   Matrix_setEventHandler(matrixEventHandler); // Register the event handler
 
   pinMode(PIN_TOUCH_IRQ, INPUT);
+  ledMatrix.begin();
 #ifndef DEBUG
   Serial.println("Core 1: Setup1 complete.");
 #endif
   delay(100);
-        seq.setStepFiltFreq(0, 1222.f);
-        seq.setStepFiltFreq(8, 888.f); 
-            seq.setStepFiltFreq(12, 500.f);
-        seq.setStepFiltFreq(2, 1000.f);       seq.setStepFiltFreq(1, 1222.f);
-        seq.setStepFiltFreq(3, 888.f); 
-            seq.setStepFiltFreq(12, 500.f);
-        seq.setStepFiltFreq(6, 888.f);
-        seq.setStepNote(1, 0);
-        seq.setStepNote(2, 1);
-        seq.setStepNote(3, 2);
-        seq.setStepNote(4, 0);
-        seq.setStepNote(5, 1);
-        seq.setStepNote(6, 2);
-        seq.setStepNote(7, 3);
-        seq.setStepNote(8, 4);
-        seq.setStepNote(9, 5);
-        seq.setStepNote(10, 6);
-        seq.setStepNote(11, 7);
-        seq.setStepNote(12, 8);
-        seq.setStepNote(13, 9);
-        seq.setStepNote(14, 10);
-        seq.setStepNote(15, 11);
-        seq.setStepNote(16, 12);
-    seq.setStepVelocity(0, 0.5f);
-    seq.setStepVelocity(1, 0.5f);
-    seq.setStepVelocity(2, 0.5f);
-    seq.setStepVelocity(3, 0.5f);
-    seq.setStepVelocity(4, 0.5f);
-    seq.setStepVelocity(5, 0.5f);
-    seq.setStepVelocity(6, 0.5f);
-    seq.setStepVelocity(7, 0.5f);
-    seq.setStepVelocity(8, 0.5f);
-    seq.setStepVelocity(9, 0.5f);
-    seq.setStepVelocity(10, 0.5f);
-    seq.setStepVelocity(11, 0.5f);
-    seq.setStepVelocity(12, 0.5f);
-    seq.setStepVelocity(13, 0.5f);
-    seq.setStepVelocity(14, 0.5f);
-    seq.setStepVelocity(15, 0.5f);
+  // Restore saved patterns; the factory pattern is only used until the
+  // first save
+  if (!persistence.begin()) {
+    loadFactoryPattern();
+  }
 
 }
 
@@ -460,42 +467,17 @@ void update() {
 void loop() {
 //  Use this loop to write to the PWM Outputs
 }
+// Render the step LEDs at 60Hz from the published pattern snapshot and
+// send the frame once the previous one has gone out
 void doLEDStuff() {
-
-  // --- LED Pulsing Cyan Feedback for Selected Step ---
-  static int lastSelectedStep = -1;
-  static bool ledWasActive = false;
-
-  if (selectedStepForEdit != -1) {
-    // Check if selected step is currently playing and gate is ON
-    bool isPlayhead = (seq.getState().playhead == selectedStepForEdit);
-    bool gateOn = seq.getStep(selectedStepForEdit).gate;
-
-    if (isPlayhead && gateOn) {
-      // Gate state indication should override cyan pulse (example: white)
-      setStepLedColor((uint8_t)selectedStepForEdit, 255, 255, 255);
-      // Debug
-      // Serial.println("[LED] Selected step is playhead and gate is ON: white.");
-    } else {
-      // Smooth pulse: sine wave, 1.5 Hz
-      float t = millis() / 1000.0f;
-      float pulse = 0.5f * (1.0f + sinf(2.0f * 3.1415926f * 1.5f * t)); // 0..1
-      uint8_t brightness = (uint8_t)(pulse * 255.0f);
-
-      // Cyan: (0, brightness, brightness)
-      setStepLedColor((uint8_t)selectedStepForEdit, 0, brightness, brightness);
-      // Debug
-      // Serial.println("[LED] Selected step LED pulsing cyan.");
-    }
-
-    lastSelectedStep = selectedStepForEdit;
-    ledWasActive = true;
-  } else if (ledWasActive && lastSelectedStep != -1) {
-    // Turn off or restore LED when deselected
-    setStepLedColor((uint8_t)lastSelectedStep, 0, 0, 0);
-    ledWasActive = false;
-    lastSelectedStep = -1;
+  const uint32_t now = micros();
+  if (ledUi.isFrameDue(now)) {
+    LedUiInput input;
+    input.selectedStep = selectedStepForEdit;
+    input.barView = ledBarViewForButtons(button16Held, button17Held, button18Held);
+    ledUi.render(now, seq.getSnapshot(), input);
   }
+  ledMatrix.show(now);
 }
 void loop1() {
   usb_midi.read();
@@ -506,9 +488,21 @@ void loop1() {
 
         previousMillis = currentMillis;
 
-    update();
+    {
+      PROFILE_SCOPE(PROFILE_SENSOR_READ);
+      update();
+    }
 doLEDStuff();
-    Matrix_scan(); // Add this line to process touch matrix events
+    {
+      PROFILE_SCOPE(PROFILE_MATRIX_SCAN);
+      Matrix_scan(); // Add this line to process touch matrix events
+    }
+
+    // Edits come from this core: follow pattern switches, publish while stopped
+    seq.update();
+
+    // One flash page per call at most; sector erases only while stopped
+    persistence.update(currentMillis, !seq.isRunning());
   
 }
 }
\ No newline at end of file
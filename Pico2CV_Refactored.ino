@@ -16,6 +16,10 @@
 #define CV3_PWM_PIN 4   // Filter
 #define CV4_PWM_PIN 5   // Envelope
 
+// --- Clock Input ---
+#define CLOCK_IN_PIN 7  // Analog clock input (rising edge)
+#define MIDI_DIN_TX_PIN 8 // DIN MIDI output (UART1 TX, MIDI_DIN_SERIAL)
+
 // --- Core Includes ---
 #include <Adafruit_TinyUSB.h>
 #include <MIDI.h>
@@ -23,15 +27,26 @@
 #include <Wire.h>
 
 // --- Modular Components ---
-#include "src/sequencer/Sequencer.h"
+#include "src/sequencer/BasicSequencer.h"
 #include "src/interfaces/HardwareSequencerIO.h"
 #include "src/state/SystemState.h"
 #include "src/input/InputManager.h"
 #include "src/audio/AudioEngine.h"
+#include "src/audio/CVOutput.h"
 #include "src/clock/ClockManager.h"
+#include "src/profiler/Profiler.h"
+#include "src/midi/SysEx.h"
+#include "src/midi/SysExTransfer.h"
+#include "src/midi/MidiInput.h"
+#include "src/storage/PicoFlash.h"
+#include "src/storage/Persistence.h"
+#include <pico/multicore.h>
 
 // --- Hardware Interfaces ---
 #include "src/matrix/Matrix.h"
+#include "src/LEDMatrix/ledMatrix.h"
+#include "src/LEDMatrix/PioLedTransmitter.h"
+#include "src/LEDMatrix/LedUi.h"
 #include <Adafruit_MPR121.h>
 #include <Melopero_VL53L1X.h>
 
@@ -51,20 +66,61 @@ midi::MidiInterface<midi::SerialMIDI<Adafruit_USBD_MIDI>> usb_midi(serial_usb_mi
 
 // --- Modular Components ---
 HardwareSequencerIO sequencerIO;
-Sequencer sequencer(&sequencerIO);
+BasicSequencer<HardwareSequencerIO> sequencer(&sequencerIO);
 InputManager inputManager;
 AudioEngine audioEngine;
+CVOutput cvOutput;
 ClockManager clockManager;
 
+// --- Persistence ---
+// The audio core runs from flash, so it is parked while flash is written.
+// Before it has been launched there is nothing to park.
+void pauseAudioCore() {
+    if (multicore_lockout_victim_is_initialized(1)) {
+        multicore_lockout_start_blocking();
+    }
+}
+
+void resumeAudioCore() {
+    if (multicore_lockout_victim_is_initialized(1)) {
+        multicore_lockout_end_blocking();
+    }
+}
+
+PicoFlash flash(PicoFlash::defaultOffset(), PERSIST_FLASH_SECTORS, pauseAudioCore, resumeAudioCore);
+Persistence persistence(flash, sequencer, SystemState::getInstance().getQuantizer());
+
+// --- Pattern Dumps ---
+void sendSysEx(const uint8_t* data, size_t length) {
+    usb_midi.sendSysEx(length, data, true);
+}
+
+SysExTransfer sysExTransfer(sequencer, SystemState::getInstance().getQuantizer(), sendSysEx);
+
+// --- MIDI Input ---
+MidiInput midiInput(sequencer, SystemState::getInstance().getQuantizer());
+
 // --- Hardware Interfaces ---
 Adafruit_MPR121 touchSensor;
+// Touch pads on the MPR121 (electrodes 0-11)
+#define TOUCH_PAD_COUNT 12
+// Capacitance drop (baseline - filtered) read as full MPE pressure
+#define MPE_PAD_PRESSURE_FULL 120
 Melopero_VL53L1X distanceSensor;
+// Step LEDs; frames go out by PIO/DMA without blocking the loop
+PioLedTransmitter ledOutput(LEDMatrix::DATA_PIN);
+LEDMatrix ledMatrix(ledOutput);
+LedUi ledUi(ledMatrix);
 
 // --- DSP Components ---
 daisysp::LadderFilter filter;
 daisysp::Adsr env1;
 daisysp::Adsr env2;
 
+// --- Profiling ---
+// Time available for one audio sample at 8kHz
+#define AUDIO_SAMPLE_BUDGET_US 125
+
 // --- Audio Buffer Pool ---
 audio_buffer_pool_t *producer_pool = nullptr;
 
@@ -77,15 +133,26 @@ audio_buffer_pool_t *producer_pool = nullptr;
  * Handles real-time audio processing at 8kHz
  */
 void core0_audio_loop() {
+    // Allow the other core to park this one during flash writes
+    multicore_lockout_victim_init();
+
+    const uint32_t budgetTicks = AUDIO_SAMPLE_BUDGET_US * Profiler::ticksPerMicrosecond();
+
     while (true) {
+        uint32_t sampleStart = Profiler::now();
+
         // Process one audio sample
         audioEngine.processSample();
         
-        // Update CV outputs via PWM
-        analogWrite(CV1_PWM_PIN, audioEngine.getCV1() * 255);
-        analogWrite(CV2_PWM_PIN, audioEngine.getCV2() * 255);
-        analogWrite(CV3_PWM_PIN, audioEngine.getCV3() * 255);
-        analogWrite(CV4_PWM_PIN, audioEngine.getCV4() * 255);
+        // Update CV outputs via PWM (calibrated, dithered)
+        analogWrite(CV1_PWM_PIN, cvOutput.process(CV_CHANNEL_PITCH, audioEngine.getCV1()));
+        analogWrite(CV2_PWM_PIN, cvOutput.process(CV_CHANNEL_VELOCITY, audioEngine.getCV2()));
+        analogWrite(CV3_PWM_PIN, cvOutput.process(CV_CHANNEL_FILTER, audioEngine.getCV3()));
+        analogWrite(CV4_PWM_PIN, cvOutput.process(CV_CHANNEL_ENVELOPE, audioEngine.getCV4()));
+
+        if (Profiler::record(PROFILE_AUDIO_SAMPLE, sampleStart) > budgetTicks) {
+            Profiler::countDeadlineMiss();
+        }
         
         // Wait for next sample (125μs for 8kHz)
         delayMicroseconds(125);
@@ -97,40 +164,63 @@ void core0_audio_loop() {
 // -----------------------------------------------------------------------------
 
 /**
- * @brief Clock callback for step advancement
- * Called by uClock on each 16th note
+ * @brief Clock listener that drives the sequencer
+ *
+ * Dispatched statically from ClockManager::update(), so both handlers are
+ * direct calls with no heap-allocated callbacks.
  */
-void onClockStep() {
-    uint8_t currentStep = clockManager.getCurrentStep();
-    
-    // Advance sequencer step (pure step logic)
-    sequencer.advanceStep(currentStep);
-    
-    // Handle live parameter recording separately
-    SystemState& state = SystemState::getInstance();
-    sequencer.recordLiveParameters(
-        state.getMM(),
-        state.getButton16Held(),
-        state.getButton17Held(),
-        state.getButton18Held(),
-        state.getSelectedStepForEdit()
-    );
-}
+struct SequencerClockListener {
+    /**
+     * @brief Called on each 16th note step
+     * @param step Current step (0-15)
+     */
+    void onClockStep(uint8_t step) {
+        // Advance sequencer step (pure step logic)
+        sequencer.advanceStep(step);
+        
+        // Handle live parameter recording separately
+        SystemState& state = SystemState::getInstance();
+        sequencer.recordLiveParameters(
+            state.getMM(),
+            state.getButton16Held(),
+            state.getButton17Held(),
+            state.getButton18Held(),
+            state.getSelectedStepForEdit()
+        );
+    }
 
-/**
- * @brief Clock callback for general timing
- * Called by uClock on each clock tick (96 PPQN)
- */
-void onClockTick() {
-    // Handle note duration tracking
-    sequencer.tickNoteDuration();
-}
+    /**
+     * @brief Called on each clock tick (96 PPQN)
+     */
+    void onClockTick() {
+        // Handle note duration tracking
+        sequencer.tickNoteDuration();
+
+        // Capture / play back motion at tick resolution
+        sequencer.tickMotion();
+
+        // MIDI clock output (divided per port)
+        sequencerIO.getMidiRouter().clockTick();
+    }
+
+    /**
+     * @brief Timing offset of a step (swing + micro-timing) in ticks
+     * @param step Step about to be scheduled (0-15)
+     */
+    int8_t getStepOffset(uint8_t step) {
+        return sequencer.getStepTickOffset(step);
+    }
+};
+
+SequencerClockListener sequencerClockListener;
+ClockListeners<SequencerClockListener> clockListeners(sequencerClockListener);
 
 /**
  * @brief uClock start callback
  */
 void onClockStart() {
     sequencer.start();
+    sequencerIO.getMidiRouter().start();
 }
 
 /**
@@ -138,6 +228,67 @@ void onClockStart() {
  */
 void onClockStop() {
     sequencer.stop();
+    sequencerIO.getMidiRouter().stop();
+}
+
+/**
+ * @brief Analog clock input edge timestamps (ISR -> loop)
+ */
+static volatile uint32_t clockInEdges[8];
+static volatile uint8_t clockInHead = 0;
+static uint8_t clockInTail = 0;
+
+/**
+ * @brief Clock input ISR: only timestamps the edge
+ */
+void onClockInEdge() {
+    clockInEdges[clockInHead & 7] = micros();
+    clockInHead++;
+}
+
+/**
+ * @brief Forward queued clock input edges to the clock manager
+ */
+void processClockInEdges() {
+    while (clockInTail != clockInHead) {
+        clockManager.onExternalPulse(clockInEdges[clockInTail & 7]);
+        clockInTail++;
+    }
+}
+
+/**
+ * @brief Every incoming MIDI message goes through the MIDI input dispatch
+ * table (SysEx additionally arrives in onSysEx)
+ */
+void onMidiMessage(const decltype(usb_midi)::MidiMessage& message) {
+    midiInput.handleMessage(message.type, message.channel, message.data1, message.data2);
+}
+
+/**
+ * @brief MIDI clock (24 PPQN) from the USB host
+ */
+void onMidiClock() {
+    clockManager.onExternalPulse(micros());
+}
+
+/**
+ * @brief MIDI Start/Continue: restart the grid on the next clock pulse
+ */
+void onMidiStart() {
+    if (clockManager.getClockSource() != CLOCK_SOURCE_MIDI) return;
+    clockManager.start();
+    sequencer.start();
+    sequencerIO.getMidiRouter().start();
+}
+
+/**
+ * @brief MIDI Stop
+ */
+void onMidiStop() {
+    if (clockManager.getClockSource() != CLOCK_SOURCE_MIDI) return;
+    clockManager.stop();
+    sequencer.stop();
+    sequencerIO.getMidiRouter().stop();
 }
 
 // -----------------------------------------------------------------------------
@@ -152,23 +303,41 @@ void setup() {
     pinMode(CV2_PWM_PIN, OUTPUT);
     pinMode(CV3_PWM_PIN, OUTPUT);
     pinMode(CV4_PWM_PIN, OUTPUT);
+    analogWriteFreq(CV_PWM_FREQUENCY);
+    analogWriteRange(CV_PWM_RANGE);
+    cvOutput.setRange(CV_PWM_RANGE);
+    cvOutput.setDither(true);
     
     // Initialize modular components
     inputManager.init();
     audioEngine.init();
     clockManager.init();
     sequencer.init();
+
+    // Restore saved patterns and settings (first boot keeps the defaults)
+    if (!persistence.begin()) {
+        Serial.println("No saved patterns, using defaults");
+    }
     
     // Initialize MIDI
     usb_midi.begin(MIDI_CHANNEL_OMNI);
+    MIDI_DIN_SERIAL.setTX(MIDI_DIN_TX_PIN);
+    MIDI_DIN_SERIAL.begin(31250);
+    usb_midi.setHandleSystemExclusive(onSysEx);
+    usb_midi.setHandleMessage(onMidiMessage);
+    midiInput.setRealtimeHandler(MIDI_STATUS_CLOCK, onMidiClock);
+    midiInput.setRealtimeHandler(MIDI_STATUS_START, onMidiStart);
+    midiInput.setRealtimeHandler(MIDI_STATUS_CONTINUE, onMidiStart);
+    midiInput.setRealtimeHandler(MIDI_STATUS_STOP, onMidiStop);
+
+    // Analog clock input
+    pinMode(CLOCK_IN_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(CLOCK_IN_PIN), onClockInEdge, RISING);
     
     // Initialize uClock
     uClock.init();
     uClock.setTempo(120);
-    
-    // Set up clock callbacks
-    clockManager.setStepCallback(onClockStep);
-    clockManager.setClockCallback(onClockTick);
+    clockManager.setBPM(120);
     
     // Set up uClock callbacks
     uClock.setOnClockStartOutput(onClockStart);
@@ -184,6 +353,8 @@ void setup() {
     if (!distanceSensor.begin()) {
         Serial.println("VL53L1X not found, check wiring?");
     }
+
+    ledMatrix.begin();
     
     // Start Core 0 audio processing
     multicore_launch_core1(core0_audio_loop);
@@ -201,19 +372,53 @@ void setup() {
 
 void loop() {
     // Update input manager (handles all input sources)
-    inputManager.update();
+    {
+        PROFILE_SCOPE(PROFILE_SENSOR_READ);
+        inputManager.update();
+    }
     
     // Update clock manager
-    clockManager.update();
+    processClockInEdges();
+    clockManager.update(micros(), clockListeners);
+
+    // Follow a pattern switch the clock just made before anything edits
+    // the pattern; while stopped this also publishes the edits
+    sequencer.update();
+
+    // MIDI produced by this clock update goes out as one batch; whatever
+    // a port cannot take yet follows on later passes
+    sequencerIO.flushMidi();
     
-    // Handle MIDI input
-    usb_midi.read();
+    // Handle MIDI input; a burst of messages is spread over several passes
+    // so it cannot hold up the clock or the touch scan
+    for (uint8_t i = 0; i < MIDI_INPUT_MAX_PER_LOOP && usb_midi.read(); i++) {
+    }
+    midiInput.update(millis());
+    sysExTransfer.update(millis());
     
     // Handle touch matrix events
-    handleTouchEvents();
+    {
+        PROFILE_SCOPE(PROFILE_MATRIX_SCAN);
+        handleTouchEvents();
+    }
+
+    // Per-note expression for MPE output
+    updateMpeExpression();
+
+    // Step LEDs: render at 60Hz, send the frame if it changed and the last
+    // one has gone out
+    updateLeds();
+    ledMatrix.show(micros());
+
+    // Handle debug commands from the serial console
+    handleSerialCommands();
+
+    // Autosave: one flash page per call at most, sector erases only while stopped
+    persistence.update(millis(), !sequencer.isRunning());
     
-    // Small delay to prevent overwhelming the system
-    delay(1);
+    // Sleep until the next clock deadline, but keep polling inputs at least every 1ms
+    uint32_t waitMicros = clockManager.getMicrosUntilNextTick(micros());
+    delayMicroseconds(waitMicros < 1000 ? waitMicros : 1000);
 }
 
 // -----------------------------------------------------------------------------
@@ -242,6 +447,45 @@ void handleTouchEvents() {
     lastTouched = currentTouched;
 }
 
+/**
+ * @brief Feed the distance sensor and the held pad's pressure to MPE output
+ *
+ * The pad capacitance is an I2C read, so it is only done when MpeOutput
+ * would send an update; in between the last reading is reused.
+ */
+void updateMpeExpression() {
+    static uint8_t padPressure = 0;
+    MpeOutput& mpe = sequencerIO.getMpe();
+    const uint32_t now = millis();
+
+    if (mpe.isUpdateDue(now)) {
+        const int pad = SystemState::getInstance().getSelectedStepForEdit();
+        padPressure = 0;
+        if (pad >= 0 && pad < TOUCH_PAD_COUNT) {
+            const int delta = touchSensor.baselineData(pad) - touchSensor.filteredData(pad);
+            if (delta > 0) {
+                padPressure = delta >= MPE_PAD_PRESSURE_FULL ? 127 : delta * 127 / MPE_PAD_PRESSURE_FULL;
+            }
+        }
+    }
+    mpe.update(now, SystemState::getInstance().getMM(), padPressure);
+}
+
+/**
+ * @brief Render the LED UI from the pattern snapshot when a frame is due
+ */
+void updateLeds() {
+    const uint32_t now = micros();
+    if (!ledUi.isFrameDue(now)) return;
+
+    SystemState& state = SystemState::getInstance();
+    LedUiInput input;
+    input.selectedStep = state.getSelectedStepForEdit();
+    input.barView = ledBarViewForButtons(state.getButton16Held(), state.getButton17Held(),
+                                         state.getButton18Held());
+    ledUi.render(now, sequencer.getSnapshot(), input);
+}
+
 /**
  * @brief Handle step touch events
  * @param stepIndex Step that was touched (0-15)
@@ -272,6 +516,111 @@ void onStepRelease(uint8_t stepIndex) {
     }
 }
 
+/**
+ * @brief Handle single-character debug commands from the serial console
+ * 'p' prints profiling statistics, 'r' resets them, 's' prints system status,
+ * 'q' selects the next scale and 't' transposes the scale root up a semitone,
+ * 'u' undoes the last pattern edit and 'y' redoes it, 'm' toggles motion
+ * recording of the filter, 'c' clears all recorded motion, 'w' saves
+ * changes to flash now, 'n' toggles MIDI step recording, 'e' toggles
+ * MPE output and 'k' selects the next clock source (internal, MIDI clock,
+ * clock input).
+ */
+void handleSerialCommands() {
+    if (!Serial.available()) return;
+
+    switch (Serial.read()) {
+    case 'p':
+        Profiler::dump(Serial);
+        break;
+    case 'r':
+        Profiler::reset();
+        Serial.println("Profiler reset");
+        break;
+    case 's':
+        printSystemStatus();
+        break;
+    case 'q': {
+        Quantizer& quantizer = SystemState::getInstance().getQuantizer();
+        quantizer.setScale(static_cast<ScaleId>((quantizer.getScale() + 1) % SCALE_COUNT));
+        Serial.print("Scale: ");
+        Serial.println(Quantizer::getScaleName(quantizer.getScale()));
+        break;
+    }
+    case 'm':
+        if (sequencer.isMotionRecording()) {
+            sequencer.disarmMotionRecord();
+            Serial.println("Motion recording off");
+        } else {
+            Serial.println(sequencer.armMotionRecord(MOTION_DEST_FILTER) ?
+                           "Motion recording filter" : "No motion lane available");
+        }
+        break;
+    case 'c':
+        sequencer.clearMotion();
+        Serial.println("Motion cleared");
+        break;
+    case 'w':
+        persistence.requestSave();
+        Serial.println("Saving");
+        break;
+    case 'n':
+        midiInput.setStepRecord(!midiInput.isStepRecording());
+        Serial.println(midiInput.isStepRecording() ? "Step record on" : "Step record off");
+        break;
+    case 'e':
+        sequencerIO.setMpeEnabled(!sequencerIO.getMpe().isEnabled());
+        Serial.println(sequencerIO.getMpe().isEnabled() ? "MPE on" : "MPE off");
+        break;
+    case 'u':
+        Serial.println(sequencer.undo() ? "Undo" : "Nothing to undo");
+        break;
+    case 'y':
+        Serial.println(sequencer.redo() ? "Redo" : "Nothing to redo");
+        break;
+    case 't': {
+        Quantizer& quantizer = SystemState::getInstance().getQuantizer();
+        quantizer.setRoot(quantizer.getRoot() + 1);
+        Serial.print("Scale root: ");
+        Serial.println(quantizer.getRoot());
+        break;
+    }
+    case 'k':
+        clockManager.setClockSource(static_cast<ClockSource>((clockManager.getClockSource() + 1) % CLOCK_SOURCE_COUNT));
+        Serial.print("Clock source: ");
+        Serial.println(getClockSourceName(clockManager.getClockSource()));
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Handle incoming MIDI SysEx messages
+ * @param data Complete message including F0/F7
+ * @param length Message length
+ */
+void onSysEx(uint8_t* data, unsigned length) {
+    switch (sysExGetCommand(data, length)) {
+    case SYSEX_CMD_PROFILE_DUMP_REQUEST: {
+        static uint8_t reply[768];
+        size_t replyLength = Profiler::encodeSysEx(reply, sizeof(reply));
+        if (replyLength > 0) {
+            // Framing bytes are already included in the reply
+            usb_midi.sendSysEx(replyLength, reply, true);
+        }
+        break;
+    }
+    case SYSEX_CMD_PROFILE_RESET:
+        Profiler::reset();
+        break;
+    default:
+        // Pattern dump import/export
+        sysExTransfer.handleMessage(data, length, millis());
+        break;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // 8. UTILITY FUNCTIONS
 // -----------------------------------------------------------------------------
@@ -296,5 +645,54 @@ void printSystemStatus() {
     Serial.println(state.getNote1());
     Serial.print("Velocity: ");
     Serial.println(state.getVel1());
+    Serial.print("Clock: ");
+    Serial.print(getClockSourceName(clockManager.getClockSource()));
+    Serial.print(", ");
+    Serial.print(clockManager.getBPM());
+    Serial.print(" BPM");
+    if (clockManager.getClockSource() != CLOCK_SOURCE_INTERNAL) {
+        Serial.print(clockManager.isExternalLocked() ? ", locked" : ", not locked");
+    }
+    Serial.println();
+
+    static const char* const PORT_NAMES[MIDI_PORT_COUNT] = {"USB", "DIN"};
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        const MidiOutStats& midi = sequencerIO.getMidiRouter().getStats(static_cast<MidiPort>(port));
+        Serial.print("MIDI out ");
+        Serial.print(PORT_NAMES[port]);
+        Serial.print(": ");
+        Serial.print(midi.messagesQueued);
+        Serial.print(" msgs, ");
+        Serial.print(midi.messagesCoalesced);
+        Serial.print(" coalesced, ");
+        Serial.print(midi.bytesWritten);
+        Serial.print(" bytes in ");
+        Serial.print(midi.batches);
+        Serial.print(" batches, ");
+        Serial.print(midi.statusBytesSaved);
+        Serial.print(" status bytes saved, ");
+        Serial.print(midi.earlyFlushes);
+        Serial.print(" early flushes, ");
+        Serial.print(midi.partialWrites);
+        Serial.print(" partial writes, ");
+        Serial.print(midi.messagesDropped);
+        Serial.println(" dropped");
+    }
+    const LedFrameStats& leds = ledMatrix.getStats();
+    Serial.print("LEDs: ");
+    Serial.print(leds.frames);
+    Serial.print(" frames at ");
+    Serial.print(leds.framesPerSecond());
+    Serial.print(" fps, ");
+    Serial.print(leds.wireMicros);
+    Serial.print("us on the wire, ");
+    Serial.print(leds.skipped);
+    Serial.print(" unchanged, ");
+    Serial.print(leds.deferred);
+    Serial.print(" deferred, UI ");
+    Serial.print(ledUi.getStats().frames);
+    Serial.print(" frames, ");
+    Serial.print(ledUi.getStats().lateFrames);
+    Serial.println(" late");
     Serial.println("====================");
 }
@@ -0,0 +1,71 @@
+/**
+ * @file HostLedTransmitter.h
+ * @brief LedTransmitter stand-in for running the LED code on the host
+ *
+ * Copies each frame as the pixels would receive it and stays busy for the
+ * frame's wire time on a SimulatedClock, so the renderer's skip/defer
+ * behaviour can be checked without hardware. As on real WS2812 strings,
+ * pixels beyond the end of a shorter frame keep their previous colour.
+ *
+ * Example:
+ *   SimulatedClock time;
+ *   HostLedTransmitter<128> output(time);
+ *   LEDMatrix matrix(output);
+ *   matrix.begin();
+ *   matrix.setLED(0, 0, CRGB::Red);
+ *   matrix.show(time.micros());
+ *   time.advance(10000);
+ *   uint32_t word = output.getPixel(0);
+ */
+
+#ifndef HOST_LED_TRANSMITTER_H
+#define HOST_LED_TRANSMITTER_H
+
+#include <string.h>
+#include "LedTransmitter.h"
+#include "../clock/SimulatedClock.h"
+
+template <uint16_t PixelCount>
+class HostLedTransmitter : public LedTransmitter {
+public:
+    explicit HostLedTransmitter(const SimulatedClock& time) : time(time) {
+        memset(pixels, 0, sizeof(pixels));
+    }
+
+    void begin() override {}
+
+    void transmit(const uint32_t* frame, uint16_t count) override {
+        if (count > PixelCount) count = PixelCount;
+        if (isBusy()) overlaps++;
+        memcpy(pixels, frame, count * sizeof(uint32_t));
+        startMicros = time.micros();
+        wireMicros = ledWireMicros(count);
+        lastCount = count;
+        frames++;
+        pixelsSent += count;
+    }
+
+    bool isBusy() override { return time.micros() - startMicros < wireMicros; }
+
+    // Colour latched into a pixel (wire word)
+    uint32_t getPixel(uint16_t index) const { return pixels[index]; }
+
+    uint32_t getFrameCount() const { return frames; }
+    uint32_t getPixelsSent() const { return pixelsSent; }
+    uint16_t getLastCount() const { return lastCount; }
+
+    // Frames started while the previous one was still on the wire (a bug)
+    uint32_t getOverlapCount() const { return overlaps; }
+
+private:
+    const SimulatedClock& time;
+    uint32_t pixels[PixelCount];
+    uint32_t startMicros = 0;
+    uint32_t wireMicros = 0;
+    uint16_t lastCount = 0;
+    uint32_t frames = 0;
+    uint32_t pixelsSent = 0;
+    uint32_t overlaps = 0;
+};
+
+#endif // HOST_LED_TRANSMITTER_H
@@ -1,4 +1,10 @@
+/**
+ * @file LEDmatrix.cpp
+ * @brief Framebuffer, dirty tracking and frame statistics for the LED matrix.
+ */
+
 #include "ledMatrix.h"
+#include "../profiler/Profiler.h"
 
 const CRGB CRGB::Black = CRGB(0, 0, 0);
 const CRGB CRGB::Blue  = CRGB(0, 0, 255);
@@ -9,44 +15,124 @@ const CRGB LEDMatrix::blue  = CRGB::Blue;
 const CRGB LEDMatrix::red   = CRGB::Red;
 const CRGB LEDMatrix::green = CRGB::Green;
 
-LEDMatrix::LEDMatrix()
-    : strip(WIDTH * HEIGHT, DATA_PIN, NEO_GRB + NEO_KHZ800)
-{
-    // No need to clear here; handled in begin()
+// Weight of a new frame interval in the smoothed value (1/8)
+constexpr uint8_t FRAME_INTERVAL_SMOOTHING_SHIFT = 3;
+
+LEDMatrix::LEDMatrix(LedTransmitter& output) : output(output) {
+    for (uint8_t i = 0; i < PIXEL_COUNT; ++i) {
+        wire[i] = 0;
+    }
 }
 
 void LEDMatrix::begin(uint8_t brightness) {
-    strip.begin();
-    strip.setBrightness(brightness);
+    output.begin();
+    this->brightness = brightness;
     clear();
-    show();
+    // The pixels' power-on state is unknown, so the first frame is complete
+    invalidate();
+    show(0);
+    lastFrameMicros = 0;
+    stats = LedFrameStats();
+}
+
+void LEDMatrix::setBrightness(uint8_t brightness) {
+    if (brightness == this->brightness) return;
+    this->brightness = brightness;
+    invalidate();
+}
+
+uint32_t LEDMatrix::toWire(const CRGB& color) const {
+    const uint16_t scale = static_cast<uint16_t>(brightness) + 1;
+    return ledWireWord(static_cast<uint8_t>((color.r * scale) >> 8),
+                       static_cast<uint8_t>((color.g * scale) >> 8),
+                       static_cast<uint8_t>((color.b * scale) >> 8));
+}
+
+void LEDMatrix::markDirty(uint8_t x, uint8_t y) {
+    if (!dirty) {
+        dirty = true;
+        dirtyX0 = dirtyX1 = x;
+        dirtyY0 = dirtyY1 = y;
+        return;
+    }
+    if (x < dirtyX0) dirtyX0 = x;
+    if (x > dirtyX1) dirtyX1 = x;
+    if (y < dirtyY0) dirtyY0 = y;
+    if (y > dirtyY1) dirtyY1 = y;
 }
 
-void LEDMatrix::setPixelColorInternal(int idx, const CRGB& color) {
-    strip.setPixelColor(idx, strip.Color(color.r, color.g, color.b));
+void LEDMatrix::invalidate() {
+    dirty = true;
+    dirtyX0 = 0;
+    dirtyY0 = 0;
+    dirtyX1 = WIDTH - 1;
+    dirtyY1 = HEIGHT - 1;
 }
 
 void LEDMatrix::setLED(int x, int y, const CRGB& color) {
     if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
-    int idx = x + y * WIDTH;
-    setPixelColorInternal(idx, color);
+    CRGB& pixel = pixels[x + y * WIDTH];
+    if (pixel == color) return;
+    pixel = color;
+    markDirty(static_cast<uint8_t>(x), static_cast<uint8_t>(y));
 }
 
-void LEDMatrix::setAll(const CRGB& color) {
-    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
-        setPixelColorInternal(i, color);
-    }
+CRGB LEDMatrix::getLED(int x, int y) const {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return CRGB::Black;
+    return pixels[x + y * WIDTH];
 }
 
-void LEDMatrix::show() {
-    strip.show();
+void LEDMatrix::setAll(const CRGB& color) {
+    for (uint8_t y = 0; y < HEIGHT; ++y) {
+        for (uint8_t x = 0; x < WIDTH; ++x) {
+            setLED(x, y, color);
+        }
+    }
 }
 
 void LEDMatrix::clear() {
     setAll(CRGB::Black);
 }
 
+bool LEDMatrix::show(uint32_t nowMicros) {
+    if (!dirty) {
+        stats.skipped++;
+        return false;
+    }
+    // The transmitter may still be reading the wire buffer
+    if (output.isBusy()) {
+        stats.deferred++;
+        return false;
+    }
+
+    PROFILE_SCOPE(PROFILE_LED_SHOW);
+    for (uint8_t y = dirtyY0; y <= dirtyY1; ++y) {
+        for (uint8_t x = dirtyX0; x <= dirtyX1; ++x) {
+            const uint8_t i = x + y * WIDTH;
+            wire[i] = toWire(pixels[i]);
+        }
+    }
+    // Pixels after the last dirty one keep their colour, so stop there
+    const uint16_t count = dirtyX1 + dirtyY1 * WIDTH + 1;
+    output.transmit(wire, count);
+    dirty = false;
+
+    if (stats.frames > 0) {
+        const int32_t interval = static_cast<int32_t>(nowMicros - lastFrameMicros);
+        if (stats.frameIntervalMicros == 0) {
+            stats.frameIntervalMicros = interval;
+        } else {
+            stats.frameIntervalMicros += (interval - static_cast<int32_t>(stats.frameIntervalMicros)) >>
+                                         FRAME_INTERVAL_SMOOTHING_SHIFT;
+        }
+    }
+    lastFrameMicros = nowMicros;
+    stats.frames++;
+    stats.pixelsSent += count;
+    stats.wireMicros = ledWireMicros(count);
+    return true;
+}
+
 CRGB* LEDMatrix::getLeds() {
-    // Not supported with NeoPixel, return nullptr for compatibility
-    return nullptr;
-}
\ No newline at end of file
+    return pixels;
+}
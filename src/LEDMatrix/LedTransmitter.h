@@ -0,0 +1,55 @@
+/**
+ * @file LedTransmitter.h
+ * @brief Abstract asynchronous WS2812 (NeoPixel) frame transmitter
+ *
+ * transmit() starts sending a frame and returns at once; the pixel words
+ * must stay untouched until isBusy() returns false. PioLedTransmitter feeds
+ * a PIO state machine by DMA on the RP2040/RP2350; HostLedTransmitter
+ * stands in for it on the host.
+ *
+ * Pixels are wire words: 0xGGRRBB00, i.e. the 24 bits in WS2812 order,
+ * left aligned so a PIO shifting out MSB first sends them as they are.
+ */
+
+#ifndef LED_TRANSMITTER_H
+#define LED_TRANSMITTER_H
+
+#include <stdint.h>
+
+// Time on the wire per pixel at 800kHz (24 bits x 1.25us)
+constexpr uint32_t LED_PIXEL_MICROS = 30;
+
+// Low time that latches a frame into the pixels (> 50us, > 280us on newer parts)
+constexpr uint32_t LED_LATCH_MICROS = 300;
+
+/**
+ * @brief Time for one frame of count pixels, including the latch
+ */
+constexpr uint32_t ledWireMicros(uint16_t count) {
+    return count * LED_PIXEL_MICROS + LED_LATCH_MICROS;
+}
+
+// Pack a colour into a wire word
+constexpr uint32_t ledWireWord(uint8_t r, uint8_t g, uint8_t b) {
+    return (static_cast<uint32_t>(g) << 24) | (static_cast<uint32_t>(r) << 16) |
+           (static_cast<uint32_t>(b) << 8);
+}
+
+class LedTransmitter {
+public:
+    virtual ~LedTransmitter() {}
+
+    virtual void begin() = 0;
+
+    /**
+     * @brief Start sending pixels 0 to count-1. Only call while not busy.
+     */
+    virtual void transmit(const uint32_t* pixels, uint16_t count) = 0;
+
+    /**
+     * @brief True until the frame has been sent and latched
+     */
+    virtual bool isBusy() = 0;
+};
+
+#endif // LED_TRANSMITTER_H
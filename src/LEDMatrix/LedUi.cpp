@@ -0,0 +1,129 @@
+/**
+ * @file LedUi.cpp
+ * @brief Layer drawing and frame scheduling for the LED step UI.
+ */
+
+#include "LedUi.h"
+#include "../profiler/Profiler.h"
+
+// One period of a raised cosine, 0-255 (64 entries)
+static const uint8_t PULSE_TABLE[64] = {
+      0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115,
+    127, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+    255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+    128, 115, 103,  90,  79,  67,  57,  47,  37,  29,  21,  15,  10,   5,   2,   1,
+};
+constexpr uint32_t PULSE_TABLE_STEP_MICROS = LED_UI_PULSE_MICROS / 64;
+
+// Layer colours (before the matrix brightness)
+static const CRGB GATE_COLOR(0, 0, 160);
+static const CRGB SLIDE_COLOR(96, 0, 160);
+static const CRGB PLAYHEAD_COLOR(40, 40, 40);
+static const CRGB PLAYHEAD_GATE_COLOR(255, 255, 255);
+static const CRGB PLAYHEAD_BAR_COLOR(48, 48, 48);
+static const CRGB BAR_COLORS[3] = {
+    CRGB(0, 160, 0),  // Note
+    CRGB(160, 80, 0), // Velocity
+    CRGB(160, 0, 80), // Filter
+};
+
+// Highest scale degree shown as a full note bar
+constexpr int BAR_NOTE_MAX = RECORD_NOTE_RANGE;
+
+static_assert(SEQUENCER_NUM_STEPS <= LEDMatrix::WIDTH, "One column per step");
+
+LedUi::LedUi(LEDMatrix& matrix) : matrix(matrix) {}
+
+void LedUi::add(uint8_t x, uint8_t y, const CRGB& color) {
+    CRGB& p = pixel(x, y);
+    p.r = (p.r + color.r > 255) ? 255 : p.r + color.r;
+    p.g = (p.g + color.g > 255) ? 255 : p.g + color.g;
+    p.b = (p.b + color.b > 255) ? 255 : p.b + color.b;
+}
+
+void LedUi::drawBars(const SequencerState& view, LedBarView barView) {
+    const CRGB& color = BAR_COLORS[barView];
+    // Muted steps' bars are drawn at a quarter
+    const CRGB muted(color.r >> 2, color.g >> 2, color.b >> 2);
+
+    for (uint8_t x = 0; x < SEQUENCER_NUM_STEPS; x++) {
+        const Step& step = view.steps[x];
+        float level;
+        switch (barView) {
+        case LED_BAR_VELOCITY:
+            level = step.velocity;
+            break;
+        case LED_BAR_FILTER:
+            level = (step.filter - RECORD_FILTER_MIN_HZ) / (RECORD_FILTER_MAX_HZ - RECORD_FILTER_MIN_HZ);
+            break;
+        default:
+            level = static_cast<float>(step.note) / BAR_NOTE_MAX;
+            break;
+        }
+        // Rounded to whole rows, bottom up
+        int height = static_cast<int>(level * BAR_ROWS + 0.5f);
+        if (height < 0) height = 0;
+        if (height > BAR_ROWS) height = BAR_ROWS;
+        for (int i = 0; i < height; i++) {
+            pixel(x, LEDMatrix::HEIGHT - 1 - i) = step.gate ? color : muted;
+        }
+    }
+}
+
+void LedUi::drawGrid(const SequencerState& view) {
+    for (uint8_t x = 0; x < SEQUENCER_NUM_STEPS; x++) {
+        const Step& step = view.steps[x];
+        if (step.gate) {
+            pixel(x, 0) = step.slide ? SLIDE_COLOR : GATE_COLOR;
+        }
+    }
+}
+
+void LedUi::drawPlayhead(const SequencerState& view) {
+    if (!view.running || view.playhead >= SEQUENCER_NUM_STEPS) return;
+    const uint8_t x = view.playhead;
+    pixel(x, 0) = view.steps[x].gate ? PLAYHEAD_GATE_COLOR : PLAYHEAD_COLOR;
+    for (uint8_t y = 1; y < LEDMatrix::HEIGHT; y++) {
+        add(x, y, PLAYHEAD_BAR_COLOR);
+    }
+}
+
+void LedUi::drawSelection(uint32_t nowMicros, const SequencerState& view, int selectedStep) {
+    if (selectedStep < 0 || selectedStep >= SEQUENCER_NUM_STEPS) return;
+    const uint8_t x = static_cast<uint8_t>(selectedStep);
+
+    // A selected step that is sounding shows white over the pulse
+    if (view.running && view.playhead == x && view.steps[x].gate) {
+        pixel(x, 0) = PLAYHEAD_GATE_COLOR;
+        return;
+    }
+    const uint8_t level = PULSE_TABLE[(nowMicros / PULSE_TABLE_STEP_MICROS) % 64];
+    pixel(x, 0) = CRGB(0, level, level);
+}
+
+void LedUi::render(uint32_t nowMicros, const SequencerState& view, const LedUiInput& input) {
+    {
+        PROFILE_SCOPE(PROFILE_LED_RENDER);
+        for (uint8_t i = 0; i < LEDMatrix::PIXEL_COUNT; i++) {
+            frame[i] = CRGB::Black;
+        }
+        drawBars(view, input.barView);
+        drawGrid(view);
+        drawPlayhead(view);
+        drawSelection(nowMicros, view, input.selectedStep);
+
+        for (uint8_t y = 0; y < LEDMatrix::HEIGHT; y++) {
+            for (uint8_t x = 0; x < LEDMatrix::WIDTH; x++) {
+                matrix.setLED(x, y, pixel(x, y));
+            }
+        }
+    }
+
+    // Fixed schedule; after a stall resume from now rather than catching up
+    nextFrameMicros += LED_UI_FRAME_MICROS;
+    if (static_cast<int32_t>(nowMicros - nextFrameMicros) >= 0) {
+        if (stats.frames > 0) stats.lateFrames++;
+        nextFrameMicros = nowMicros + LED_UI_FRAME_MICROS;
+    }
+    stats.frames++;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file LedUi.h
+ * @brief Step sequencer UI composited onto the 16x8 LED matrix
+ *
+ * Each frame is built from a sequencer snapshot in layers, bottom to top:
+ *   1. value bars (rows 1-7): note, velocity or filter of every step
+ *   2. step grid (row 0): gate and slide
+ *   3. playhead: highlights the playing step's column
+ *   4. selection: the step selected for edit pulses cyan, or shows white
+ *      while it plays with its gate on
+ * Column x is step x. The frame is composited in a local buffer and then
+ * copied to the matrix, whose dirty tracking leaves unchanged pixels out of
+ * the next transmission.
+ *
+ * Frames run on a fixed 60Hz schedule: isFrameDue() is a cheap check, so
+ * the caller only takes a snapshot when a frame is due. The pulse comes from
+ * a precomputed table. Render time is profiled as "ledRender".
+ *
+ * Example:
+ *   if (ledUi.isFrameDue(micros())) {
+ *       LedUiInput input;
+ *       input.selectedStep = state.getSelectedStepForEdit();
+ *       ledUi.render(micros(), sequencer.getSnapshot(), input);
+ *   }
+ *   ledMatrix.show(micros());
+ */
+
+#ifndef LED_UI_H
+#define LED_UI_H
+
+#include <stdint.h>
+#include "ledMatrix.h"
+#include "../sequencer/SequencerDefs.h"
+
+// Frame period (60Hz)
+constexpr uint32_t LED_UI_FRAME_MICROS = 16667;
+
+// Selection pulse period (1.5Hz)
+constexpr uint32_t LED_UI_PULSE_MICROS = 666667;
+
+// Step parameter shown by the value bars
+enum LedBarView : uint8_t {
+    LED_BAR_NOTE = 0,
+    LED_BAR_VELOCITY,
+    LED_BAR_FILTER
+};
+
+/**
+ * @brief Bar view for the held record buttons, so the bars show the
+ * parameter being recorded (16 note, 17 velocity, 18 filter)
+ */
+inline LedBarView ledBarViewForButtons(bool button16, bool button17, bool button18) {
+    if (button17 && !button16) return LED_BAR_VELOCITY;
+    if (button18 && !button16 && !button17) return LED_BAR_FILTER;
+    return LED_BAR_NOTE;
+}
+
+struct LedUiInput {
+    int selectedStep = -1; // Step selected for edit, -1 for none
+    LedBarView barView = LED_BAR_NOTE;
+};
+
+struct LedUiStats {
+    uint32_t frames = 0;
+    uint32_t lateFrames = 0; // Rendered a whole frame period or more behind schedule
+};
+
+class LedUi {
+public:
+    explicit LedUi(LEDMatrix& matrix);
+
+    bool isFrameDue(uint32_t nowMicros) const {
+        return static_cast<int32_t>(nowMicros - nextFrameMicros) >= 0;
+    }
+
+    /**
+     * @brief Composite one frame into the matrix and schedule the next.
+     * O(pixels). Does not transmit; call LEDMatrix::show() afterwards.
+     */
+    void render(uint32_t nowMicros, const SequencerState& view, const LedUiInput& input);
+
+    const LedUiStats& getStats() const { return stats; }
+    void resetStats() { stats = LedUiStats(); }
+
+private:
+    static constexpr uint8_t BAR_ROWS = LEDMatrix::HEIGHT - 1;
+
+    void drawBars(const SequencerState& view, LedBarView barView);
+    void drawGrid(const SequencerState& view);
+    void drawPlayhead(const SequencerState& view);
+    void drawSelection(uint32_t nowMicros, const SequencerState& view, int selectedStep);
+
+    CRGB& pixel(uint8_t x, uint8_t y) { return frame[x + y * LEDMatrix::WIDTH]; }
+    void add(uint8_t x, uint8_t y, const CRGB& color);
+
+    LEDMatrix& matrix;
+    CRGB frame[LEDMatrix::PIXEL_COUNT];
+    uint32_t nextFrameMicros = 0;
+    LedUiStats stats;
+};
+
+#endif // LED_UI_H
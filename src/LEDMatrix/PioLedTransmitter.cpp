@@ -0,0 +1,73 @@
+/**
+ * @file PioLedTransmitter.cpp
+ * @brief WS2812 output through the pico-sdk PIO and DMA APIs.
+ */
+
+#include "PioLedTransmitter.h"
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include <hardware/dma.h>
+#include <hardware/clocks.h>
+
+// ws2812.pio from pico-examples (T1 = 2, T2 = 5, T3 = 3 cycles per bit):
+//   bitloop: out x, 1        side 0 [2]
+//            jmp !x do_zero  side 1 [1]
+//   do_one:  jmp bitloop     side 1 [4]
+//   do_zero: nop             side 0 [4]
+static const uint16_t WS2812_INSTRUCTIONS[] = {0x6221, 0x1123, 0x1400, 0xa442};
+static const pio_program_t WS2812_PROGRAM = {WS2812_INSTRUCTIONS, 4, -1};
+constexpr uint8_t WS2812_CYCLES_PER_BIT = 10;
+constexpr uint32_t WS2812_BIT_RATE = 800000;
+
+PioLedTransmitter::PioLedTransmitter(uint8_t pin, uint8_t pioIndex)
+    : pin(pin), pioIndex(pioIndex) {}
+
+void PioLedTransmitter::begin() {
+    if (stateMachine >= 0) return;
+
+    PIO pio = pio_get_instance(pioIndex);
+    stateMachine = static_cast<int8_t>(pio_claim_unused_sm(pio, true));
+    const uint offset = pio_add_program(pio, &WS2812_PROGRAM);
+
+    pio_gpio_init(pio, pin);
+    pio_sm_set_consistent_pindirs(pio, stateMachine, pin, 1, true);
+
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, offset, offset + 3);
+    sm_config_set_sideset(&config, 1, false, false);
+    sm_config_set_sideset_pins(&config, pin);
+    // 24 bits per pixel, MSB first, refilled from the FIFO automatically
+    sm_config_set_out_shift(&config, false, true, 24);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&config, static_cast<float>(clock_get_hz(clk_sys)) /
+                                  (WS2812_BIT_RATE * WS2812_CYCLES_PER_BIT));
+    pio_sm_init(pio, stateMachine, offset, &config);
+    pio_sm_set_enabled(pio, stateMachine, true);
+
+    dmaChannel = static_cast<int8_t>(dma_claim_unused_channel(true));
+    dma_channel_config dma = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&dma, DMA_SIZE_32);
+    channel_config_set_read_increment(&dma, true);
+    channel_config_set_write_increment(&dma, false);
+    channel_config_set_dreq(&dma, pio_get_dreq(pio, stateMachine, true));
+    dma_channel_configure(dmaChannel, &dma, &pio->txf[stateMachine], nullptr, 0, false);
+}
+
+void PioLedTransmitter::transmit(const uint32_t* pixels, uint16_t count) {
+    if (dmaChannel < 0 || count == 0) return;
+    startMicros = micros();
+    wireMicros = ledWireMicros(count);
+    dma_channel_transfer_from_buffer_now(dmaChannel, pixels, count);
+}
+
+bool PioLedTransmitter::isBusy() {
+    if (dmaChannel < 0) return false;
+    // The DMA finishes while the last pixels are still in the FIFO, so the
+    // frame is only done once its wire time (and the latch) has passed
+    return dma_channel_is_busy(dmaChannel) || micros() - startMicros < wireMicros;
+}
+
+#endif // ARDUINO_ARCH_RP2040
@@ -0,0 +1,43 @@
+/**
+ * @file PioLedTransmitter.h
+ * @brief LedTransmitter on an RP2040/RP2350 PIO state machine fed by DMA
+ *
+ * The PIO program generates the WS2812 bit timing and a DMA channel streams
+ * the frame into its TX FIFO, so transmit() costs a few register writes
+ * instead of bit-banging the whole frame with interrupts disabled (~4ms
+ * for 128 pixels). Interrupts and the other core run undisturbed.
+ *
+ * Example:
+ *   PioLedTransmitter ledOutput(LEDMatrix::DATA_PIN);
+ *   LEDMatrix matrix(ledOutput);
+ *   matrix.begin();
+ */
+
+#ifndef PIO_LED_TRANSMITTER_H
+#define PIO_LED_TRANSMITTER_H
+
+#include <stdint.h>
+#include "LedTransmitter.h"
+
+class PioLedTransmitter : public LedTransmitter {
+public:
+    /**
+     * @param pin Data output pin
+     * @param pioIndex PIO block to claim a state machine on (0 or 1)
+     */
+    explicit PioLedTransmitter(uint8_t pin, uint8_t pioIndex = 1);
+
+    void begin() override;
+    void transmit(const uint32_t* pixels, uint16_t count) override;
+    bool isBusy() override;
+
+private:
+    uint8_t pin;
+    uint8_t pioIndex;
+    int8_t stateMachine = -1;
+    int8_t dmaChannel = -1;
+    uint32_t startMicros = 0;
+    uint32_t wireMicros = 0; // Duration of the frame being sent
+};
+
+#endif // PIO_LED_TRANSMITTER_H
@@ -1,10 +1,31 @@
+/**
+ * @file ledMatrix.h
+ * @brief 16x8 WS2812 LED matrix with a framebuffer and dirty tracking
+ *
+ * Drawing only changes the framebuffer and grows a dirty rectangle; show()
+ * sends the frame through an asynchronous LedTransmitter, and only when
+ * something changed and the previous frame has left the wire. A frame is
+ * cut short after the last dirty pixel, since WS2812 pixels beyond the end
+ * of a frame keep their colour.
+ *
+ * Pixels are converted to wire words (brightness applied) into a second
+ * buffer that the transmitter reads while drawing carries on, so nothing
+ * blocks and no interrupts are disabled; show() is cheap enough for loop().
+ *
+ * Example:
+ *   PioLedTransmitter ledOutput(LEDMatrix::DATA_PIN);
+ *   LEDMatrix matrix(ledOutput);
+ *   matrix.begin();
+ *   matrix.setLED(3, 0, CRGB::Blue);
+ *   matrix.show(micros());   // Every loop pass; returns false if skipped
+ */
+
 #ifndef LEDMATRIX_H
 #define LEDMATRIX_H
 
-#include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
+#include <stdint.h>
+#include "LedTransmitter.h"
 
-// Forward declaration for CRGB compatibility
 struct CRGB {
     uint8_t r, g, b;
     CRGB() : r(0), g(0), b(0) {}
@@ -14,12 +35,28 @@ struct CRGB {
     static const CRGB Red;
     static const CRGB Green;
     operator uint32_t() const { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+    bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB& other) const { return !(*this == other); }
+};
+
+struct LedFrameStats {
+    uint32_t frames = 0;              // Frames transmitted
+    uint32_t skipped = 0;             // show() calls with nothing changed
+    uint32_t deferred = 0;            // show() calls while the previous frame was on the wire
+    uint32_t pixelsSent = 0;
+    uint32_t wireMicros = 0;          // Wire time of the last frame
+    uint32_t frameIntervalMicros = 0; // Smoothed time between transmitted frames
+
+    float framesPerSecond() const {
+        return frameIntervalMicros ? 1000000.0f / frameIntervalMicros : 0.0f;
+    }
 };
 
 class LEDMatrix {
 public:
     static constexpr uint8_t WIDTH = 16;
     static constexpr uint8_t HEIGHT = 8;
+    static constexpr uint8_t PIXEL_COUNT = WIDTH * HEIGHT;
     static constexpr uint8_t DATA_PIN = 15;
 
     // Color aliases for convenience (using CRGB for API compatibility)
@@ -27,19 +64,59 @@ public:
     static const CRGB red;
     static const CRGB green;
 
-    LEDMatrix();
+    explicit LEDMatrix(LedTransmitter& output);
+
+    /**
+     * @brief Start the transmitter and send an all-black frame
+     */
     void begin(uint8_t brightness = 64);
+
+    // Global brightness (255 = full), applied when a frame is sent
+    void setBrightness(uint8_t brightness);
+    uint8_t getBrightness() const { return brightness; }
+
     void setLED(int x, int y, const CRGB& color);
+    CRGB getLED(int x, int y) const;
     void setAll(const CRGB& color);
-    void show();
     void clear();
 
-    // Optional: direct access for advanced use (returns nullptr for compatibility)
+    /**
+     * @brief Send the frame if it changed and the transmitter is free.
+     * O(dirty pixels).
+     * @param nowMicros Current time, for the frame rate
+     * @return true if a frame was started; false if nothing changed or the
+     *         previous frame is still being sent (it stays dirty)
+     */
+    bool show(uint32_t nowMicros);
+
+    bool isDirty() const { return dirty; }
+
+    // Mark the whole frame changed, e.g. after writing through getLeds()
+    void invalidate();
+
+    // Direct framebuffer access (row-major, x + y * WIDTH); call invalidate() after writing
     CRGB* getLeds();
 
+    const LedFrameStats& getStats() const { return stats; }
+    void resetStats() { stats = LedFrameStats(); }
+
 private:
-    Adafruit_NeoPixel strip;
-    void setPixelColorInternal(int idx, const CRGB& color);
+    void markDirty(uint8_t x, uint8_t y);
+    uint32_t toWire(const CRGB& color) const;
+
+    LedTransmitter& output;
+    CRGB pixels[PIXEL_COUNT];
+    uint32_t wire[PIXEL_COUNT]; // Read by the transmitter while a frame is sent
+    uint8_t brightness = 64;
+
+    bool dirty = false;
+    uint8_t dirtyX0 = 0;
+    uint8_t dirtyY0 = 0;
+    uint8_t dirtyX1 = 0;
+    uint8_t dirtyY1 = 0;
+
+    LedFrameStats stats;
+    uint32_t lastFrameMicros = 0;
 };
 
 
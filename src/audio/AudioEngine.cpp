@@ -0,0 +1,165 @@
+/**
+ * @file AudioEngine.cpp
+ * @brief Implementation of the audio-rate CV engine.
+ */
+
+#include "AudioEngine.h"
+
+// Default slide half-time in seconds
+static const float DEFAULT_GLIDE_TIME = 0.03f;
+
+// Per-sample smoothing coefficient for locked levels (~5ms at 8kHz)
+static const float PARAM_SMOOTHING = 0.025f;
+
+AudioEngine::AudioEngine() {}
+
+void AudioEngine::init() {
+    envelopeLevel = 0.0f;
+    envelopeActive = false;
+    lastTrigState = false;
+    envelopeTriggerCount = SystemState::getInstance().getEnv1TriggerCount();
+    envelopeStage = ENV_IDLE;
+
+    attackTime = 0.01f * sampleRate;
+    decayTime = 0.1f * sampleRate;
+    releaseTime = 0.2f * sampleRate;
+
+    glide.Init(sampleRate, DEFAULT_GLIDE_TIME);
+    lastPitchNote = -1;
+    pitchTarget = 0.0f;
+
+    // Force a parameter load on the first sample
+    synthParamVersion = SystemState::getInstance().getSynthParamVersion() - 1;
+}
+
+void AudioEngine::processSample() {
+    updateSynthParams();
+    processEnvelope();
+    updateCVOutputs();
+}
+
+void AudioEngine::updateSynthParams() {
+    SystemState& state = SystemState::getInstance();
+
+    const uint32_t version = state.getSynthParamVersion();
+    if (version != synthParamVersion) {
+        synthParamVersion = version;
+        attackTime = state.getSynthParam(SYNTH_PARAM_ATTACK) * sampleRate;
+        decayTime = state.getSynthParam(SYNTH_PARAM_DECAY) * sampleRate;
+        releaseTime = state.getSynthParam(SYNTH_PARAM_RELEASE) * sampleRate;
+        if (attackTime < 1.0f) attackTime = 1.0f;
+        if (decayTime < 1.0f) decayTime = 1.0f;
+        if (releaseTime < 1.0f) releaseTime = 1.0f;
+        sustainTarget = state.getSynthParam(SYNTH_PARAM_SUSTAIN);
+        resonanceTarget = state.getSynthParam(SYNTH_PARAM_RESONANCE);
+        driveTarget = state.getSynthParam(SYNTH_PARAM_DRIVE);
+        glide.SetHtime(state.getSynthParam(SYNTH_PARAM_GLIDE));
+    }
+
+    sustainLevel += PARAM_SMOOTHING * (sustainTarget - sustainLevel);
+    resonance += PARAM_SMOOTHING * (resonanceTarget - resonance);
+    drive += PARAM_SMOOTHING * (driveTarget - drive);
+}
+
+void AudioEngine::processEnvelope() {
+    SystemState& state = SystemState::getInstance();
+    // Count first: a new trigger's gate level is stored before its count
+    const uint32_t triggers = state.getEnv1TriggerCount();
+    const bool trig = state.getTrigEnv1();
+
+    // Every trigger starts an attack, even when a note-off and the next
+    // note-on land between two samples and the gate never reads low.
+    // A falling gate starts the release.
+    if (triggers != envelopeTriggerCount) {
+        envelopeTriggerCount = triggers;
+        envelopeStage = ENV_ATTACK;
+        envelopeActive = true;
+        lastTrigState = true;
+    }
+    if (!trig && lastTrigState && envelopeActive) {
+        envelopeStage = ENV_RELEASE;
+        // Release slope from the current level
+        envelopeCounter = envelopeLevel / releaseTime;
+    }
+    lastTrigState = trig;
+
+    switch (envelopeStage) {
+    case ENV_ATTACK:
+        envelopeLevel += 1.0f / attackTime;
+        if (envelopeLevel >= 1.0f) {
+            envelopeLevel = 1.0f;
+            envelopeStage = ENV_DECAY;
+        }
+        break;
+    case ENV_DECAY:
+        envelopeLevel -= (1.0f - sustainLevel) / decayTime;
+        if (envelopeLevel <= sustainLevel) {
+            envelopeLevel = sustainLevel;
+            envelopeStage = ENV_SUSTAIN;
+        }
+        break;
+    case ENV_SUSTAIN:
+        envelopeLevel = sustainLevel;
+        break;
+    case ENV_RELEASE:
+        envelopeLevel -= envelopeCounter;
+        if (envelopeLevel <= 0.0f) {
+            envelopeLevel = 0.0f;
+            envelopeStage = ENV_IDLE;
+            envelopeActive = false;
+        }
+        break;
+    case ENV_IDLE:
+    default:
+        break;
+    }
+}
+
+void AudioEngine::updateCVOutputs() {
+    SystemState& state = SystemState::getInstance();
+
+    // Note-to-CV conversion only runs when the note or bend changes
+    int note = state.getNote1();
+    int bend = state.getPitchBend();
+    if (note != lastPitchNote || bend != lastPitchBend) {
+        lastPitchNote = note;
+        lastPitchBend = bend;
+        pitchTarget = noteToCV(note, bend);
+    }
+
+    // Slide steps glide to the new pitch, everything else jumps
+    if (state.getSlide1()) {
+        cv1Output = glide.Process(pitchTarget);
+    } else {
+        glide.Reset(pitchTarget);
+        cv1Output = pitchTarget;
+    }
+
+    cv2Output = velocityToCV(state.getVel1());
+    // Filter CV interpolates between tick-rate updates (motion playback)
+    cv3Output += PARAM_SMOOTHING * (filterToCV(state.getFreq1()) - cv3Output);
+    cv4Output = envelopeLevel;
+}
+
+float AudioEngine::noteToCV(int midiNote, int bend) {
+    // 1V/octave over the 0-5V output range
+    float semitones = static_cast<float>(midiNote - PITCH_CV_BASE_NOTE) +
+                      bend * (PITCH_BEND_RANGE_SEMITONES / 8192.0f);
+    float cv = semitones / PITCH_CV_RANGE_SEMITONES;
+    if (cv < 0.0f) cv = 0.0f;
+    if (cv > 1.0f) cv = 1.0f;
+    return cv;
+}
+
+float AudioEngine::velocityToCV(float velocity) {
+    if (velocity < 0.0f) return 0.0f;
+    if (velocity > 1.0f) return 1.0f;
+    return velocity;
+}
+
+float AudioEngine::filterToCV(float filterValue) {
+    float cv = filterValue / FILTER_CV_MAX_HZ;
+    if (cv < 0.0f) cv = 0.0f;
+    if (cv > 1.0f) cv = 1.0f;
+    return cv;
+}
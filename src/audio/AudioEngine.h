@@ -11,6 +11,16 @@
 
 #include <stdint.h>
 #include "../state/SystemState.h"
+#include "../dsp/port.h"
+
+// MIDI note that maps to 0V on the pitch output
+constexpr int PITCH_CV_BASE_NOTE = 36;
+// Semitones covered by the full pitch CV range (0-5V at 1V/octave)
+constexpr int PITCH_CV_RANGE_SEMITONES = 60;
+// Pitch bend range (+/- semitones at full deflection)
+constexpr float PITCH_BEND_RANGE_SEMITONES = 2.0f;
+// Filter frequency mapped to full scale on CV3
+constexpr float FILTER_CV_MAX_HZ = 5000.0f;
 
 /**
  * @brief Audio processing engine
@@ -38,7 +48,7 @@ public:
      * @param sampleRate Sample rate in Hz (default 8000)
      */
     void setSampleRate(float sampleRate) { this->sampleRate = sampleRate; }
-    
+
     /**
      * @brief Get current CV1 output (pitch)
      * @return CV1 value (0.0-1.0 for PWM)
@@ -63,6 +73,16 @@ public:
      */
     float getCV4() const { return cv4Output; }
 
+    /**
+     * @brief Smoothed filter resonance (0-1) for a filter stage
+     */
+    float getResonance() const { return resonance; }
+
+    /**
+     * @brief Smoothed filter input drive (0-1) for a filter stage
+     */
+    float getDrive() const { return drive; }
+
 private:
     float sampleRate = 8000.0f;
     
@@ -76,6 +96,7 @@ private:
     float envelopeLevel = 0.0f;
     bool envelopeActive = false;
     bool lastTrigState = false;
+    uint32_t envelopeTriggerCount = 0; // Last SystemState trigger count seen
     
     // Envelope parameters (in samples)
     float attackTime = 0.01f * 8000.0f;   // 10ms attack
@@ -93,13 +114,30 @@ private:
     
     EnvelopeStage envelopeStage = ENV_IDLE;
     float envelopeCounter = 0.0f;
+
+    // Synth parameters (parameter-lock targets). Times are converted only
+    // when SystemState reports a change; levels glide to their targets with a
+    // one-pole smoother so locked steps do not click.
+    uint32_t synthParamVersion = 0;
+    float sustainTarget = 0.7f;
+    float resonance = 0.0f;
+    float resonanceTarget = 0.0f;
+    float drive = 0.0f;
+    float driveTarget = 0.0f;
+
+    // Pitch glide for slide steps (one multiply-add per sample)
+    daisysp::Port glide;
+    int lastPitchNote = -1;
+    int lastPitchBend = 0;
+    float pitchTarget = 0.0f;   // Cached noteToCV() of the current note and bend
     
     // Processing methods
     void processEnvelope();
     void updateCVOutputs();
+    void updateSynthParams();
     
     // Helper methods
-    float noteToCV(int midiNote);
+    float noteToCV(int midiNote, int bend);
     float velocityToCV(float velocity);
     float filterToCV(float filterValue);
 };
@@ -0,0 +1,29 @@
+/**
+ * @file CVCalibrationData.h
+ * @brief CV output calibration tables (generated by tools/cv_calibrate.py)
+ *
+ * Source: identity (uncalibrated)
+ * Breakpoint i is the 16-bit duty code for i/16 of full scale.
+ */
+
+#ifndef CV_CALIBRATION_DATA_H
+#define CV_CALIBRATION_DATA_H
+
+#include "CVOutput.h"
+
+static const uint16_t CV_CALIBRATION_DEFAULT[CV_OUTPUT_CHANNELS][CV_CAL_POINTS] = {
+    // Pitch
+    {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768,
+     36863, 40959, 45055, 49151, 53247, 57343, 61439, 65535},
+    // Velocity
+    {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768,
+     36863, 40959, 45055, 49151, 53247, 57343, 61439, 65535},
+    // Filter
+    {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768,
+     36863, 40959, 45055, 49151, 53247, 57343, 61439, 65535},
+    // Envelope
+    {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768,
+     36863, 40959, 45055, 49151, 53247, 57343, 61439, 65535},
+};
+
+#endif // CV_CALIBRATION_DATA_H
@@ -0,0 +1,50 @@
+/**
+ * @file CVOutput.cpp
+ * @brief Calibration table management for the CV output stage.
+ */
+
+#include "CVOutput.h"
+#include "CVCalibrationData.h"
+
+CVOutput::CVOutput() {
+    for (uint8_t ch = 0; ch < CV_OUTPUT_CHANNELS; ch++) {
+        setCalibration(ch, CV_CALIBRATION_DEFAULT[ch]);
+    }
+}
+
+void CVOutput::setRange(uint32_t newRange) {
+    if (newRange == 0) return;
+    range = newRange;
+    maxCode = static_cast<float>(range);
+    for (uint8_t ch = 0; ch < CV_OUTPUT_CHANNELS; ch++) {
+        rescale(ch);
+    }
+}
+
+void CVOutput::setCalibration(uint8_t channel, const uint16_t* points) {
+    if (channel >= CV_OUTPUT_CHANNELS || points == nullptr) return;
+    for (uint8_t i = 0; i < CV_CAL_POINTS; i++) {
+        calibration[channel][i] = points[i];
+    }
+    rescale(channel);
+}
+
+const uint16_t* CVOutput::getCalibration(uint8_t channel) const {
+    return (channel < CV_OUTPUT_CHANNELS) ? calibration[channel] : nullptr;
+}
+
+void CVOutput::setDither(bool enabled) {
+    ditherEnabled = enabled;
+    for (uint8_t ch = 0; ch < CV_OUTPUT_CHANNELS; ch++) {
+        ditherError[ch] = 0.0f;
+    }
+}
+
+void CVOutput::rescale(uint8_t channel) {
+    // Convert 16-bit duty codes to PWM counter units once, not per sample
+    const float scale = static_cast<float>(range) / CV_CODE_FULL_SCALE;
+    for (uint8_t i = 0; i < CV_CAL_POINTS; i++) {
+        scaledTables[channel][i] = calibration[channel][i] * scale;
+    }
+    ditherError[channel] = 0.0f;
+}
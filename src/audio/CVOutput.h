@@ -0,0 +1,135 @@
+/**
+ * @file CVOutput.h
+ * @brief Calibrated CV output stage (normalized value -> PWM code)
+ *
+ * Each channel owns a calibration table of CV_CAL_POINTS breakpoints spread
+ * evenly over the 0-1 (0-5V) range. Breakpoint i holds the 16-bit duty code
+ * that measured closest to the ideal voltage i / CV_CAL_SEGMENTS of full
+ * scale, so offset, gain and curvature errors of the PWM/RC/op-amp chain are
+ * all folded into one table. Tables are produced by tools/cv_calibrate.py.
+ *
+ * Per sample the conversion is one table interpolation. The table is
+ * pre-scaled to the PWM counter range, so the result is already an output
+ * code. At 120kHz the PWM counter only has about 10 bits; the optional
+ * first-order noise-shaped dither keeps the fractional part of the code and
+ * pushes the rounding error up to the PWM rate, where the output RC filter
+ * removes it, so the averaged CV keeps the table's 16-bit resolution.
+ *
+ * Example:
+ *   CVOutput cv;
+ *   cv.setRange(CV_PWM_RANGE);
+ *   cv.setDither(true);
+ *   analogWrite(CV1_PWM_PIN, cv.process(CV_CHANNEL_PITCH, audioEngine.getCV1()));
+ */
+
+#ifndef CV_OUTPUT_H
+#define CV_OUTPUT_H
+
+#include <stdint.h>
+
+// Number of CV output channels
+constexpr uint8_t CV_OUTPUT_CHANNELS = 4;
+
+// Calibration table resolution
+constexpr uint8_t CV_CAL_SEGMENTS = 16;
+constexpr uint8_t CV_CAL_POINTS = CV_CAL_SEGMENTS + 1;
+
+// Full-scale calibration code (16-bit duty)
+constexpr uint32_t CV_CODE_FULL_SCALE = 65535;
+
+// PWM setup: the counter range that fits the carrier frequency at 125-150MHz
+constexpr uint32_t CV_PWM_FREQUENCY = 120000;
+constexpr uint32_t CV_PWM_RANGE = 1024;
+
+enum CVChannel : uint8_t {
+    CV_CHANNEL_PITCH = 0,
+    CV_CHANNEL_VELOCITY,
+    CV_CHANNEL_FILTER,
+    CV_CHANNEL_ENVELOPE
+};
+
+class CVOutput {
+public:
+    CVOutput();
+
+    /**
+     * @brief Set the PWM counter range (value written for 100% duty)
+     */
+    void setRange(uint32_t range);
+    uint32_t getRange() const { return range; }
+
+    /**
+     * @brief Load a calibration table
+     * @param channel Output channel
+     * @param points CV_CAL_POINTS ascending 16-bit duty codes
+     */
+    void setCalibration(uint8_t channel, const uint16_t* points);
+
+    /**
+     * @brief Get the active calibration table of a channel
+     */
+    const uint16_t* getCalibration(uint8_t channel) const;
+
+    /**
+     * @brief Enable or disable noise-shaped dither
+     */
+    void setDither(bool enabled);
+    bool getDither() const { return ditherEnabled; }
+
+    /**
+     * @brief Convert a normalized CV (0.0-1.0 = 0-5V) to a calibrated PWM code
+     * @param channel Output channel
+     * @param value Normalized CV, clamped to 0-1
+     * @return Code for analogWrite() in the range 0 to getRange()
+     */
+    uint32_t process(uint8_t channel, float value) {
+        if (value < 0.0f) value = 0.0f;
+        if (value > 1.0f) value = 1.0f;
+
+        // One interpolation into the pre-scaled table
+        float position = value * CV_CAL_SEGMENTS;
+        uint8_t index = static_cast<uint8_t>(position);
+        if (index >= CV_CAL_SEGMENTS) index = CV_CAL_SEGMENTS - 1;
+        const float* table = scaledTables[channel];
+        float code = table[index] + (position - index) * (table[index + 1] - table[index]);
+
+        if (ditherEnabled) {
+            // First-order error feedback plus TPDF dither (+/-1 LSB)
+            code += ditherError[channel] + nextDither();
+            float rounded = static_cast<float>(static_cast<int32_t>(code + 0.5f));
+            ditherError[channel] = code - rounded;
+            // At a rail the error can't be paid back; carrying it would
+            // random-walk and hold the output there after the CV moves away
+            if (rounded < 0.0f || rounded > maxCode) {
+                rounded = rounded < 0.0f ? 0.0f : maxCode;
+                ditherError[channel] = 0.0f;
+            }
+            return static_cast<uint32_t>(rounded);
+        }
+        return static_cast<uint32_t>(code + 0.5f);
+    }
+
+private:
+    void rescale(uint8_t channel);
+
+    // Triangular dither in (-1, 1) LSB from two xorshift32 draws
+    float nextDither() {
+        ditherState ^= ditherState << 13;
+        ditherState ^= ditherState >> 17;
+        ditherState ^= ditherState << 5;
+        const int32_t a = static_cast<int32_t>(ditherState & 0xFFFF);
+        const int32_t b = static_cast<int32_t>(ditherState >> 16);
+        return static_cast<float>(a - b) * (1.0f / 65536.0f);
+    }
+
+    uint16_t calibration[CV_OUTPUT_CHANNELS][CV_CAL_POINTS];
+    float scaledTables[CV_OUTPUT_CHANNELS][CV_CAL_POINTS];
+    float ditherError[CV_OUTPUT_CHANNELS];
+
+    uint32_t range = CV_PWM_RANGE;
+    float maxCode = static_cast<float>(CV_PWM_RANGE);
+    bool ditherEnabled = false;
+    uint32_t ditherState = 0x9E3779B9u;
+};
+
+#endif // CV_OUTPUT_H
@@ -0,0 +1,63 @@
+/**
+ * @file SynthParams.h
+ * @brief Automatable synth parameters (parameter-lock destinations)
+ *
+ * Parameters are stored compactly as 16-bit raw values spanning each
+ * parameter's range, and converted to physical units only when applied.
+ */
+
+#ifndef SYNTH_PARAMS_H
+#define SYNTH_PARAMS_H
+
+#include <stdint.h>
+
+enum SynthParam : uint8_t {
+    SYNTH_PARAM_ATTACK = 0,   // Envelope attack time (s)
+    SYNTH_PARAM_DECAY,        // Envelope decay time (s)
+    SYNTH_PARAM_SUSTAIN,      // Envelope sustain level (0-1)
+    SYNTH_PARAM_RELEASE,      // Envelope release time (s)
+    SYNTH_PARAM_GLIDE,        // Slide half-time (s)
+    SYNTH_PARAM_RESONANCE,    // Filter resonance (0-1)
+    SYNTH_PARAM_DRIVE,        // Filter input drive (0-1)
+    SYNTH_PARAM_COUNT
+};
+
+// Full-scale raw parameter value
+constexpr uint16_t SYNTH_PARAM_RAW_MAX = 0xFFFF;
+
+struct SynthParamRange {
+    float min;
+    float max;
+    float defaultValue;
+};
+
+static const SynthParamRange SYNTH_PARAM_RANGES[SYNTH_PARAM_COUNT] = {
+    {0.001f, 2.0f, 0.01f},   // Attack
+    {0.001f, 2.0f, 0.1f},    // Decay
+    {0.0f, 1.0f, 0.7f},      // Sustain
+    {0.001f, 4.0f, 0.2f},    // Release
+    {0.0f, 0.5f, 0.03f},     // Glide
+    {0.0f, 1.0f, 0.0f},      // Resonance
+    {0.0f, 1.0f, 0.0f},      // Drive
+};
+
+/**
+ * @brief Convert a raw 16-bit value to physical units
+ */
+inline float synthParamFromRaw(uint8_t param, uint16_t raw) {
+    const SynthParamRange& r = SYNTH_PARAM_RANGES[param];
+    return r.min + (r.max - r.min) * (static_cast<float>(raw) / SYNTH_PARAM_RAW_MAX);
+}
+
+/**
+ * @brief Convert a physical value to raw 16 bits (clamped to the range)
+ */
+inline uint16_t synthParamToRaw(uint8_t param, float value) {
+    const SynthParamRange& r = SYNTH_PARAM_RANGES[param];
+    float norm = (value - r.min) / (r.max - r.min);
+    if (norm < 0.0f) norm = 0.0f;
+    if (norm > 1.0f) norm = 1.0f;
+    return static_cast<uint16_t>(norm * SYNTH_PARAM_RAW_MAX + 0.5f);
+}
+
+#endif // SYNTH_PARAMS_H
@@ -0,0 +1,258 @@
+/**
+ * @file ClockManager.cpp
+ * @brief Implementation of the drift-free internal clock.
+ *
+ * The clock keeps the next tick deadline as an exact rational number of
+ * microseconds. Every tick adds the whole part of the period to the deadline
+ * and the remainder to a fractional accumulator that carries into the whole
+ * part when it reaches the denominator (a Bresenham-style phase accumulator).
+ *
+ * External sources reuse the same scheduler with a fixed-point denominator:
+ * after every pulse the next deadline is recomputed from the tracker as
+ *   pulseTime + (tick - pulse * ticksPerPulse) * period / ticksPerPulse
+ */
+
+#include "ClockManager.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// Microseconds per minute, scaled by 1000 for milli-BPM tempo units
+static const uint64_t MICROS_PER_MINUTE_MILLI = 60000000ULL * 1000ULL;
+
+// Fixed-point denominator used for periods derived from the external tracker
+static const uint32_t EXTERNAL_PERIOD_DENOMINATOR = 1UL << 16;
+
+// Supported tempo range
+static const uint32_t MIN_TEMPO_MILLI_BPM = 20000;
+static const uint32_t MAX_TEMPO_MILLI_BPM = 300000;
+
+ClockManager::ClockManager() {
+    calculateTickPeriod();
+    clearStepWheel();
+}
+
+void ClockManager::init() {
+    running = false;
+    currentStep = 0;
+    currentTick = 0;
+    tickCount = 0;
+    calculateTickPeriod();
+}
+
+void ClockManager::start() {
+#ifdef ARDUINO
+    extendTime(micros());
+#endif
+    currentStep = 0;
+    currentTick = 0;
+    tickCount = 0;
+    clearStepWheel();
+
+    running = true;
+    if (clockSource != CLOCK_SOURCE_INTERNAL) {
+        // Tick 0 is placed on the first pulse after start
+        awaitingFirstPulse = true;
+        tickLimit = 0;
+        return;
+    }
+
+    // First tick is due immediately
+    nextTickTime = nowExtended;
+    nextTickFraction = 0;
+}
+
+void ClockManager::stop() {
+    running = false;
+}
+
+void ClockManager::setBPM(float bpm) {
+    uint32_t milliBPM = static_cast<uint32_t>(bpm * 1000.0f + 0.5f);
+    if (milliBPM < MIN_TEMPO_MILLI_BPM) milliBPM = MIN_TEMPO_MILLI_BPM;
+    if (milliBPM > MAX_TEMPO_MILLI_BPM) milliBPM = MAX_TEMPO_MILLI_BPM;
+    if (milliBPM == tempoMilliBPM) return;
+    if (clockSource != CLOCK_SOURCE_INTERNAL) return; // Tempo follows the external clock
+
+    const uint32_t oldDenominator = periodDenominator;
+    tempoMilliBPM = milliBPM;
+    calculateTickPeriod();
+
+    if (!running || nextTickTime <= nowExtended) {
+        // Nothing pending, or the tick is already due: keep the deadline
+        nextTickFraction = static_cast<uint32_t>(
+            (static_cast<uint64_t>(nextTickFraction) * periodDenominator) / oldDenominator);
+        return;
+    }
+
+    // Rescale the time remaining in the current tick so the phase within
+    // the tick is preserved. Remaining time in units of 1/oldDenominator us:
+    //   R = (deadline - now) * oldDen + frac
+    // Remaining time at the new tempo is R * (oldPeriod/newPeriod)^-1, which in
+    // microseconds is simply R / newDen because period is proportional to 1/den.
+    uint64_t remaining = (nextTickTime - nowExtended) * oldDenominator + nextTickFraction;
+    nextTickTime = nowExtended + remaining / periodDenominator;
+    nextTickFraction = static_cast<uint32_t>(remaining % periodDenominator);
+}
+
+void ClockManager::setClockSource(ClockSource source) {
+    if (source == clockSource) return;
+    clockSource = source;
+
+    const uint8_t ppqn = (source == CLOCK_SOURCE_ANALOG) ? analogClockPPQN : MIDI_CLOCK_PPQN;
+    ticksPerPulse = CLOCK_PPQN / ppqn;
+
+    // Seed the tracker with the current tempo so it locks faster
+    tracker.reset(getTempoTickPeriod() * ticksPerPulse);
+
+    if (source == CLOCK_SOURCE_INTERNAL) {
+        calculateTickPeriod();
+        nextTickTime = nowExtended;
+        nextTickFraction = 0;
+    } else {
+        awaitingFirstPulse = running;
+        tickLimit = tickCount;
+    }
+}
+
+void ClockManager::setAnalogClockPPQN(uint8_t ppqn) {
+    if (ppqn == 0 || ppqn > CLOCK_PPQN || (CLOCK_PPQN % ppqn) != 0) return;
+    analogClockPPQN = ppqn;
+    if (clockSource == CLOCK_SOURCE_ANALOG) {
+        ticksPerPulse = CLOCK_PPQN / ppqn;
+        // Pulse indices restart; the next pulse re-bases the tick grid
+        tracker.reset(getTempoTickPeriod() * ticksPerPulse);
+    }
+}
+
+void ClockManager::onExternalPulse(uint32_t pulseMicros) {
+    if (clockSource == CLOCK_SOURCE_INTERNAL) return;
+
+    // Timestamps may be captured in an ISR before the last update()
+    int32_t offset = static_cast<int32_t>(pulseMicros - lastNowMicros);
+    if (offset > 0) {
+        extendTime(pulseMicros);
+        offset = 0;
+    }
+    tracker.addPulse(nowExtended + offset);
+
+    // Place the next tick on this pulse after start, and whenever the
+    // tracker has restarted its pulse count (re-acquire or reset)
+    if (awaitingFirstPulse || tracker.getGeneration() != baseGeneration) {
+        awaitingFirstPulse = false;
+        baseGeneration = tracker.getGeneration();
+        pulseBase = tracker.getPulseCount() - 1;
+        tickBase = tickCount;
+    }
+    if (running) {
+        scheduleFromTracker();
+    }
+}
+
+void ClockManager::scheduleFromTracker() {
+    const uint32_t pulseIndex = tracker.getPulseCount() - 1 - pulseBase;
+    double pulsePeriod = tracker.getPeriod();
+    if (pulsePeriod <= 0.0) {
+        // No period yet after a reset: assume the last known tempo
+        pulsePeriod = getTempoTickPeriod() * ticksPerPulse;
+    }
+
+    // Report the tracked tempo
+    const uint8_t ppqn = CLOCK_PPQN / ticksPerPulse;
+    tempoMilliBPM = static_cast<uint32_t>(60000000000.0 / (pulsePeriod * ppqn) + 0.5);
+
+    // Interpolated tick period in fixed point
+    const double tickPeriod = pulsePeriod / ticksPerPulse;
+    const uint64_t tickPeriodFixed = static_cast<uint64_t>(tickPeriod * EXTERNAL_PERIOD_DENOMINATOR + 0.5);
+    periodDenominator = EXTERNAL_PERIOD_DENOMINATOR;
+    periodWhole = tickPeriodFixed / EXTERNAL_PERIOD_DENOMINATOR;
+    periodRemainder = static_cast<uint32_t>(tickPeriodFixed % EXTERNAL_PERIOD_DENOMINATOR);
+
+    // Deadline of the next undelivered tick relative to the filtered pulse.
+    // Negative offsets mean the output lags and those ticks are due now.
+    const int64_t tickOffset = static_cast<int64_t>(tickCount - tickBase) -
+                               static_cast<int64_t>(pulseIndex) * ticksPerPulse;
+    double deadline = tracker.getPulseTime() + tickOffset * tickPeriod;
+    if (deadline < 0.0) deadline = 0.0;
+    nextTickTime = static_cast<uint64_t>(deadline);
+    nextTickFraction = static_cast<uint32_t>((deadline - nextTickTime) * EXTERNAL_PERIOD_DENOMINATOR);
+
+    // Allow one pulse of slack so a late (jittered) pulse does not stall output
+    tickLimit = tickBase + (pulseIndex + 2) * ticksPerPulse;
+}
+
+double ClockManager::getTempoTickPeriod() const {
+    return static_cast<double>(MICROS_PER_MINUTE_MILLI) / (static_cast<double>(tempoMilliBPM) * CLOCK_PPQN);
+}
+
+void ClockManager::calculateTickPeriod() {
+    periodDenominator = tempoMilliBPM * CLOCK_PPQN;
+    periodWhole = MICROS_PER_MINUTE_MILLI / periodDenominator;
+    periodRemainder = static_cast<uint32_t>(MICROS_PER_MINUTE_MILLI % periodDenominator);
+}
+
+void ClockManager::advanceDeadline() {
+    nextTickTime += periodWhole;
+    nextTickFraction += periodRemainder;
+    if (nextTickFraction >= periodDenominator) {
+        nextTickFraction -= periodDenominator;
+        nextTickTime++;
+    }
+}
+
+void ClockManager::extendTime(uint32_t nowMicros) {
+    // Unsigned subtraction handles the 32-bit micros() wrap
+    nowExtended += static_cast<uint32_t>(nowMicros - lastNowMicros);
+    lastNowMicros = nowMicros;
+}
+
+#ifdef ARDUINO
+void ClockManager::update() {
+    update(micros());
+}
+#endif
+
+void ClockManager::update(uint32_t nowMicros) {
+    HandlerListener listener{*this};
+    update(nowMicros, listener);
+}
+
+uint32_t ClockManager::getMicrosUntilNextTick(uint32_t nowMicros) const {
+    if (!running) return 0;
+    if (clockSource != CLOCK_SOURCE_INTERNAL && tickCount >= tickLimit) return 0;
+    uint64_t now = nowExtended + static_cast<uint32_t>(nowMicros - lastNowMicros);
+    if (now >= nextTickTime) return 0;
+    uint64_t wait = nextTickTime - now;
+    return (wait > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(wait);
+}
+
+void ClockManager::finishTick() {
+    advanceDeadline();
+    tickCount++;
+    if (++currentTick >= CLOCK_TICKS_PER_STEP) {
+        currentTick = 0;
+        currentStep = (currentStep + 1) % CLOCK_STEPS_PER_BAR;
+    }
+}
+
+void ClockManager::scheduleStep(uint8_t step, int16_t delayTicks) {
+    if (delayTicks < 0) delayTicks = 0;
+    if (delayTicks >= CLOCK_WHEEL_SLOTS) delayTicks = CLOCK_WHEEL_SLOTS - 1;
+
+    // Keep steps in order and on distinct ticks
+    uint32_t dueTick = tickCount + delayTicks;
+    if (stepScheduled && static_cast<int32_t>(dueTick - lastStepTick) <= 0) {
+        dueTick = lastStepTick + 1;
+    }
+    stepWheel[dueTick & (CLOCK_WHEEL_SLOTS - 1)] = step;
+    lastStepTick = dueTick;
+    stepScheduled = true;
+}
+
+void ClockManager::clearStepWheel() {
+    for (uint8_t i = 0; i < CLOCK_WHEEL_SLOTS; i++) {
+        stepWheel[i] = CLOCK_NO_STEP;
+    }
+    stepScheduled = false;
+    lastStepTick = 0;
+}
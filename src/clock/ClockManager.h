@@ -10,13 +10,109 @@
 #define CLOCK_MANAGER_H
 
 #include <stdint.h>
-#include <functional>
+#include <tuple>
+#include "ClockTracker.h"
+
+// Clock resolution (ticks per quarter note)
+constexpr uint8_t CLOCK_PPQN = 96;
+// Ticks per sequencer step (16th note at 96 PPQN)
+constexpr uint8_t CLOCK_TICKS_PER_STEP = CLOCK_PPQN / 4;
+// Steps per bar
+constexpr uint8_t CLOCK_STEPS_PER_BAR = 16;
+// Upper bound on ticks dispatched by one update() after a stall
+constexpr uint8_t CLOCK_MAX_CATCHUP_TICKS = CLOCK_TICKS_PER_STEP;
+// MIDI clock resolution
+constexpr uint8_t MIDI_CLOCK_PPQN = 24;
+// Slots in the step timer wheel (power of two, longer than the largest step delay)
+constexpr uint8_t CLOCK_WHEEL_SLOTS = 64;
+// Marks an empty timer wheel slot
+constexpr uint8_t CLOCK_NO_STEP = 0xFF;
+
+/**
+ * @brief Source that drives the tick grid
+ */
+enum ClockSource : uint8_t {
+    CLOCK_SOURCE_INTERNAL = 0,  // Free-running at the set BPM
+    CLOCK_SOURCE_MIDI,          // MIDI clock (24 PPQN)
+    CLOCK_SOURCE_ANALOG,        // Clock input edges (configurable PPQN)
+    CLOCK_SOURCE_COUNT
+};
+
+inline const char* getClockSourceName(ClockSource source) {
+    switch (source) {
+    case CLOCK_SOURCE_MIDI: return "MIDI";
+    case CLOCK_SOURCE_ANALOG: return "Clock in";
+    default: return "Internal";
+    }
+}
+
+// Plain function callbacks with a bound context pointer (no heap, no std::function)
+typedef void (*ClockStepHandler)(void* context, uint8_t step);
+typedef void (*ClockTickHandler)(void* context);
+typedef int8_t (*ClockStepOffsetHandler)(void* context, uint8_t step);
+
+/**
+ * @brief Compile-time list of clock listeners
+ *
+ * Each listener type provides onClockTick() and onClockStep(uint8_t step).
+ * Dispatch is a fold over concrete references, so calls are direct and can
+ * be inlined into the tick loop. The first listener also provides
+ * getStepOffset(uint8_t step), the step's timing offset in ticks.
+ *
+ * Example:
+ *   struct SequencerClock {
+ *       Sequencer& seq;
+ *       void onClockTick() { seq.tickNoteDuration(); }
+ *       void onClockStep(uint8_t step) { seq.advanceStep(step); }
+ *       int8_t getStepOffset(uint8_t step) { return seq.getStepTickOffset(step); }
+ *   };
+ *   SequencerClock seqClock{sequencer};
+ *   ClockListeners<SequencerClock> listeners(seqClock);
+ *   clockManager.update(micros(), listeners);
+ */
+template <typename... Listeners>
+class ClockListeners {
+public:
+    explicit ClockListeners(Listeners&... listeners) : listeners(listeners...) {}
+
+    void onClockTick() {
+        std::apply([](auto&... l) { (l.onClockTick(), ...); }, listeners);
+    }
+
+    void onClockStep(uint8_t step) {
+        std::apply([step](auto&... l) { (l.onClockStep(step), ...); }, listeners);
+    }
+
+    int8_t getStepOffset(uint8_t step) {
+        return std::get<0>(listeners).getStepOffset(step);
+    }
+
+private:
+    std::tuple<Listeners&...> listeners;
+};
 
 /**
  * @brief Clock manager for sequencer timing
  * 
  * This class manages clock sources and provides timing callbacks
  * for the sequencer engine.
+ *
+ * Ticks are scheduled against absolute deadlines kept as an exact rational
+ * phase accumulator: the tick period is 60e9 / (milliBPM * PPQN) microseconds,
+ * stored as a whole part plus a remainder over the denominator. Deadlines
+ * never accumulate rounding error, so polling jitter delays individual ticks
+ * but never drifts the grid.
+ *
+ * With an external source, pulse timestamps go through a ClockTracker and the
+ * ticks between pulses are interpolated from the filtered pulse time and
+ * period. Output never runs past the next expected pulse, so a stopped
+ * external clock also stops the ticks.
+ *
+ * Step events are not fired on the grid directly. At each grid step the
+ * clock asks for the next step's offset (swing + micro-timing) and places the
+ * event into a small timer wheel indexed by absolute tick, so shifted steps
+ * fire on the exact tick without extra polling. Offsets may be negative
+ * because the next step is scheduled a whole step ahead.
  */
 class ClockManager {
 public:
@@ -47,28 +143,141 @@ public:
      * @brief Get current BPM
      * @return Current BPM
      */
-    float getBPM() const { return currentBPM; }
+    float getBPM() const { return tempoMilliBPM / 1000.0f; }
     
     /**
-     * @brief Set step callback function
-     * @param callback Function to call on each step (receives step number 0-15)
+     * @brief Set step callback function (used by the non-template update())
+     * @param handler Function to call on each step (receives step number 0-15)
+     * @param context Pointer passed back to the handler
      */
-    void setStepCallback(std::function<void(uint8_t)> callback) {
-        stepCallback = callback;
+    void setStepCallback(ClockStepHandler handler, void* context = nullptr) {
+        stepHandler = handler;
+        stepContext = context;
     }
     
     /**
-     * @brief Set clock callback function
-     * @param callback Function to call on each clock tick (96 PPQN)
+     * @brief Set clock callback function (used by the non-template update())
+     * @param handler Function to call on each clock tick (96 PPQN)
+     * @param context Pointer passed back to the handler
      */
-    void setClockCallback(std::function<void()> callback) {
-        clockCallback = callback;
+    void setClockCallback(ClockTickHandler handler, void* context = nullptr) {
+        tickHandler = handler;
+        tickContext = context;
     }
     
+    /**
+     * @brief Select the clock source
+     * @param source Internal, MIDI clock or analog clock input
+     */
+    void setClockSource(ClockSource source);
+
+    /**
+     * @brief Get the current clock source
+     */
+    ClockSource getClockSource() const { return clockSource; }
+
+    /**
+     * @brief Set pulses per quarter note of the analog clock input
+     * @param ppqn Pulses per quarter note (must divide 96, e.g. 1, 2, 4, 24)
+     */
+    void setAnalogClockPPQN(uint8_t ppqn);
+
+    /**
+     * @brief Feed one external clock pulse (MIDI Clock or analog edge)
+     * @param pulseMicros Time the pulse was received, in microseconds
+     */
+    void onExternalPulse(uint32_t pulseMicros);
+
+    /**
+     * @brief Set how strongly external pulse jitter is filtered
+     * @param alpha Tracker phase gain (smaller = smoother, slower to follow)
+     */
+    void setSyncGain(float alpha) { tracker.setGain(alpha); }
+
+    /**
+     * @brief Check whether the external clock tracker has locked
+     */
+    bool isExternalLocked() const { return tracker.isLocked(); }
+
+    /**
+     * @brief Access the external clock tracker (diagnostics)
+     */
+    const ClockTracker& getTracker() const { return tracker; }
+
+    /**
+     * @brief Set step offset callback (used by the non-template update())
+     * @param handler Returns the timing offset of a step in ticks
+     * @param context Pointer passed back to the handler
+     */
+    void setStepOffsetCallback(ClockStepOffsetHandler handler, void* context = nullptr) {
+        offsetHandler = handler;
+        offsetContext = context;
+    }
+
     /**
      * @brief Update clock (call from main loop)
      */
     void update();
+
+    /**
+     * @brief Dispatch every tick whose deadline is at or before nowMicros
+     * @param nowMicros Current time in microseconds (wrapping 32-bit counter)
+     */
+    void update(uint32_t nowMicros);
+
+    /**
+     * @brief Dispatch due ticks directly to a listener (static dispatch)
+     * @param nowMicros Current time in microseconds (wrapping 32-bit counter)
+     * @param listener Object with onClockTick() and onClockStep(uint8_t)
+     */
+    template <typename Listener>
+    void update(uint32_t nowMicros, Listener& listener) {
+        extendTime(nowMicros);
+        if (!running) return;
+
+        uint8_t dispatched = 0;
+        while (isTickDue(dispatched)) {
+            // Tick first so note durations expire before the next step starts
+            listener.onClockTick();
+
+            if (currentTick == 0) {
+                if (tickCount == 0) {
+                    // Nothing was scheduled ahead of the very first step
+                    scheduleStep(currentStep, listener.getStepOffset(currentStep));
+                }
+                const uint8_t nextStep = (currentStep + 1) % CLOCK_STEPS_PER_BAR;
+                scheduleStep(nextStep, CLOCK_TICKS_PER_STEP + listener.getStepOffset(nextStep));
+            }
+
+            const uint8_t slot = tickCount & (CLOCK_WHEEL_SLOTS - 1);
+            const uint8_t dueStep = stepWheel[slot];
+            if (dueStep != CLOCK_NO_STEP) {
+                stepWheel[slot] = CLOCK_NO_STEP;
+                listener.onClockStep(dueStep);
+            }
+
+            finishTick();
+            dispatched++;
+        }
+    }
+
+    /**
+     * @brief Time left until the next tick deadline
+     * @param nowMicros Current time in microseconds
+     * @return Microseconds until the next tick (0 if overdue or stopped)
+     */
+    uint32_t getMicrosUntilNextTick(uint32_t nowMicros) const;
+
+    /**
+     * @brief Total ticks dispatched since start()
+     */
+    uint32_t getTickCount() const { return tickCount; }
+
+    /**
+     * @brief Absolute deadline of the next tick
+     * @return Whole microseconds on the extended (64-bit) timeline
+     */
+    uint64_t getNextTickTime() const { return nextTickTime; }
     
     /**
      * @brief Check if clock is running
@@ -84,28 +293,84 @@ public:
     
     /**
      * @brief Get current tick position within step
-     * @return Tick position (0-5 for 16th notes at 96 PPQN)
+     * @return Tick position (0-23 for 16th notes at 96 PPQN)
      */
     uint8_t getCurrentTick() const { return currentTick; }
 
 private:
-    float currentBPM = 120.0f;
+    uint32_t tempoMilliBPM = 120000;
     bool running = false;
+    ClockSource clockSource = CLOCK_SOURCE_INTERNAL;
     
     // Step tracking
     uint8_t currentStep = 0;
     uint8_t currentTick = 0;
-    uint32_t lastStepTime = 0;
-    uint32_t stepInterval = 0; // microseconds between steps
+    uint32_t tickCount = 0;
+
+    // Extended timeline (unwrapped micros())
+    uint32_t lastNowMicros = 0;
+    uint64_t nowExtended = 0;
+
+    // Tick period = periodWhole + periodRemainder / periodDenominator microseconds
+    uint64_t periodWhole = 0;
+    uint32_t periodRemainder = 0;
+    uint32_t periodDenominator = 1;
+
+    // Next deadline = nextTickTime + nextTickFraction / periodDenominator
+    uint64_t nextTickTime = 0;
+    uint32_t nextTickFraction = 0;
+
+    // External sync
+    ClockTracker tracker;
+    uint8_t analogClockPPQN = 4;
+    uint8_t ticksPerPulse = CLOCK_PPQN / MIDI_CLOCK_PPQN;
+    uint32_t pulseBase = 0;           // Tracker pulse index of the first pulse after start
+    uint32_t tickBase = 0;            // Tick index placed on that pulse
+    uint32_t baseGeneration = 0;      // Tracker generation pulseBase belongs to
+    uint32_t tickLimit = 0;           // Ticks may not run past the next expected pulse
+    bool awaitingFirstPulse = false;
     
-    // Callbacks
-    std::function<void(uint8_t)> stepCallback;
-    std::function<void()> clockCallback;
+    // Callbacks for the non-template update()
+    ClockStepHandler stepHandler = nullptr;
+    void* stepContext = nullptr;
+    ClockTickHandler tickHandler = nullptr;
+    void* tickContext = nullptr;
+    ClockStepOffsetHandler offsetHandler = nullptr;
+    void* offsetContext = nullptr;
+
+    // Step timer wheel: stepWheel[tick % SLOTS] holds the step due on that tick
+    uint8_t stepWheel[CLOCK_WHEEL_SLOTS];
+    uint32_t lastStepTick = 0;
+    bool stepScheduled = false;
+
+    // Adapts the registered function pointers to the listener interface
+    struct HandlerListener {
+        ClockManager& clock;
+        void onClockTick() {
+            if (clock.tickHandler) clock.tickHandler(clock.tickContext);
+        }
+        void onClockStep(uint8_t step) {
+            if (clock.stepHandler) clock.stepHandler(clock.stepContext, step);
+        }
+        int8_t getStepOffset(uint8_t step) {
+            return clock.offsetHandler ? clock.offsetHandler(clock.offsetContext, step) : 0;
+        }
+    };
     
     // Internal methods
-    void calculateStepInterval();
-    void handleStepAdvance();
-    void handleClockTick();
+    void calculateTickPeriod();
+    double getTempoTickPeriod() const; // Tick period at tempoMilliBPM, in microseconds
+    void advanceDeadline();
+    void extendTime(uint32_t nowMicros);
+    void scheduleFromTracker();
+    bool isTickDue(uint8_t dispatched) const {
+        if (nowExtended < nextTickTime || dispatched >= CLOCK_MAX_CATCHUP_TICKS) return false;
+        // Never run ahead of the external clock
+        return clockSource == CLOCK_SOURCE_INTERNAL || tickCount < tickLimit;
+    }
+    void finishTick();
+    void scheduleStep(uint8_t step, int16_t delayTicks);
+    void clearStepWheel();
 };
 
 #endif // CLOCK_MANAGER_H
@@ -0,0 +1,86 @@
+/**
+ * @file ClockTracker.cpp
+ * @brief Implementation of the alpha-beta external clock tracker.
+ */
+
+#include "ClockTracker.h"
+
+void ClockTracker::reset(double periodHint) {
+    pulseTime = 0.0;
+    period = periodHint;
+    lastResidual = 0.0;
+    pulseCount = 0;
+    outlierCount = 0;
+    generation++;
+}
+
+void ClockTracker::setGain(float alpha) {
+    if (alpha <= 0.0f || alpha > 1.0f) return;
+    steadyAlpha = alpha;
+    steadyBeta = alpha * alpha / (2.0f - alpha);
+}
+
+void ClockTracker::addPulse(uint64_t timeMicros) {
+    const double measured = static_cast<double>(timeMicros);
+
+    if (pulseCount == 0) {
+        pulseTime = measured;
+        lastResidual = 0.0;
+        pulseCount = 1;
+        return;
+    }
+    if (pulseCount == 1 && period <= 0.0) {
+        period = measured - pulseTime;
+        pulseTime = measured;
+        pulseCount = 2;
+        return;
+    }
+
+    double predicted = pulseTime + period;
+    double residual = measured - predicted;
+
+    // A residual close to a whole number of periods means pulses were lost
+    // (e.g. a dropped MIDI clock byte): count them and carry on. Only right
+    // after an in-line pulse: a run of such gaps is a slower tempo (half
+    // tempo looks like every other pulse lost) and must re-acquire.
+    bool bridged = false;
+    if (residual > 0.5 * period && outlierCount == 0) {
+        const double missed = static_cast<double>(static_cast<uint32_t>(residual / period + 0.5));
+        const double remainder = residual - missed * period;
+        if (missed <= MAX_MISSED_PULSES && remainder < MISSED_PULSE_TOLERANCE * period &&
+            remainder > -MISSED_PULSE_TOLERANCE * period) {
+            predicted += missed * period;
+            residual = remainder;
+            pulseCount += static_cast<uint32_t>(missed);
+            bridged = true;
+        }
+    }
+
+    // A residual beyond half a period is a restart or a tempo jump. Ignore
+    // isolated ones; re-acquire if they persist.
+    if (residual > 0.5 * period || residual < -0.5 * period) {
+        if (++outlierCount >= MAX_OUTLIERS) {
+            reset();
+            addPulse(timeMicros);
+            return;
+        }
+        pulseTime = predicted;
+        lastResidual = residual;
+        pulseCount++;
+        return;
+    }
+    outlierCount = bridged ? 1 : 0;
+
+    // Growing-window gains (least-squares line fit over n points) until they
+    // fall below the steady-state values
+    const double n = static_cast<double>(pulseCount + 1);
+    double alpha = 2.0 * (2.0 * n - 1.0) / (n * (n + 1.0));
+    double beta = 6.0 / (n * (n + 1.0));
+    if (alpha < steadyAlpha) alpha = steadyAlpha;
+    if (beta < steadyBeta) beta = steadyBeta;
+
+    pulseTime = predicted + alpha * residual;
+    period += beta * residual;
+    lastResidual = residual;
+    pulseCount++;
+}
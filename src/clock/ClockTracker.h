@@ -0,0 +1,98 @@
+/**
+ * @file ClockTracker.h
+ * @brief Tempo and phase estimator for external clock pulses
+ *
+ * Tracks a noisy external pulse train (MIDI clock or an analog clock input)
+ * with an alpha-beta filter, the steady-state form of a constant-tempo
+ * Kalman filter. Each pulse timestamp corrects the predicted pulse time and
+ * period; the filtered values are used by ClockManager to place
+ * interpolated 96 PPQN ticks, so timestamp jitter is attenuated instead of
+ * passed straight to the output.
+ *
+ * The gains start wide (equivalent to a growing least-squares fit) so the
+ * tracker locks within a few pulses, then settle to the steady-state values.
+ * A pulse that lands about a whole number of periods late counts the lost
+ * pulses in between, so one dropped MIDI clock does not force a re-acquire.
+ */
+
+#ifndef CLOCK_TRACKER_H
+#define CLOCK_TRACKER_H
+
+#include <stdint.h>
+
+class ClockTracker {
+public:
+    ClockTracker() {}
+
+    /**
+     * @brief Forget all history
+     * @param periodHint Initial period guess in microseconds (0 = none)
+     */
+    void reset(double periodHint = 0.0);
+
+    /**
+     * @brief Feed one pulse timestamp
+     * @param timeMicros Pulse time on the extended (64-bit) timeline
+     */
+    void addPulse(uint64_t timeMicros);
+
+    /**
+     * @brief Set steady-state phase gain (beta is derived for critical damping)
+     * @param alpha Phase correction gain, 0 < alpha <= 1
+     */
+    void setGain(float alpha);
+
+    /**
+     * @brief Check whether enough pulses arrived to trust the estimate
+     */
+    bool isLocked() const { return pulseCount >= LOCK_PULSES; }
+
+    /**
+     * @brief Number of pulses since reset (index of the next pulse),
+     * including pulses bridged as lost
+     */
+    uint32_t getPulseCount() const { return pulseCount; }
+
+    /**
+     * @brief Incremented by every reset, including the automatic re-acquire
+     * after persistent outliers; pulse counts of different generations are
+     * unrelated
+     */
+    uint32_t getGeneration() const { return generation; }
+
+    /**
+     * @brief Filtered time of the most recent pulse, in microseconds
+     */
+    double getPulseTime() const { return pulseTime; }
+
+    /**
+     * @brief Filtered pulse period, in microseconds
+     */
+    double getPeriod() const { return period; }
+
+    /**
+     * @brief Residual of the last pulse (measured - predicted), in microseconds
+     */
+    double getLastResidual() const { return lastResidual; }
+
+private:
+    static const uint8_t LOCK_PULSES = 4;
+    // Consecutive outliers that force a re-acquire (tempo jump or restart)
+    static const uint8_t MAX_OUTLIERS = 3;
+    // Gaps of up to this many lost pulses are bridged rather than treated
+    // as outliers, if the pulse lands within the tolerance (in periods)
+    static const uint8_t MAX_MISSED_PULSES = 3;
+    static constexpr double MISSED_PULSE_TOLERANCE = 0.25;
+
+    double pulseTime = 0.0;
+    double period = 0.0;
+    double lastResidual = 0.0;
+    uint32_t pulseCount = 0;
+    uint32_t generation = 0;
+    uint8_t outlierCount = 0;
+
+    float steadyAlpha = 0.05f;
+    float steadyBeta = 0.05f * 0.05f / (2.0f - 0.05f);
+};
+
+#endif // CLOCK_TRACKER_H
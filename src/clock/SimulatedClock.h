@@ -0,0 +1,60 @@
+/**
+ * @file SimulatedClock.h
+ * @brief Deterministic time source for driving ClockManager off-target
+ *
+ * Simulated time only moves when asked to. runTicks() jumps straight to
+ * each tick deadline and dispatches it, so a run produces the same ticks,
+ * steps and timestamps every time, independent of host speed, and
+ * thousands of bars take as long as the listeners need.
+ *
+ * Example:
+ *   SimulatedClock time;
+ *   ClockManager clock;
+ *   clock.setBPM(120.0f);
+ *   time.sync(clock);
+ *   clock.start();
+ *   time.runTicks(clock, listeners, 16 * CLOCK_TICKS_PER_STEP);  // One bar
+ */
+
+#ifndef SIMULATED_CLOCK_H
+#define SIMULATED_CLOCK_H
+
+#include <stdint.h>
+#include "ClockManager.h"
+
+class SimulatedClock {
+public:
+    // Current time as a wrapping 32-bit microsecond counter, like micros()
+    uint32_t micros() const { return static_cast<uint32_t>(now); }
+
+    // Current time without wrapping
+    uint64_t getTime() const { return now; }
+
+    void advance(uint32_t deltaMicros) { now += deltaMicros; }
+
+    /**
+     * @brief Bring the clock manager's timeline to the current time; call
+     * before ClockManager::start() so the first tick is due now.
+     */
+    void sync(ClockManager& clock) const { clock.update(micros()); }
+
+    /**
+     * @brief Dispatch the next ticks, advancing time to each deadline.
+     * Stops early if the clock stops. O(ticks).
+     * @return Ticks dispatched
+     */
+    template <typename Listener>
+    uint32_t runTicks(ClockManager& clock, Listener& listener, uint32_t ticks) {
+        const uint32_t first = clock.getTickCount();
+        while (clock.isRunning() && clock.getTickCount() - first < ticks) {
+            now += clock.getMicrosUntilNextTick(micros());
+            clock.update(micros(), listener);
+        }
+        return clock.getTickCount() - first;
+    }
+
+private:
+    uint64_t now = 0;
+};
+
+#endif // SIMULATED_CLOCK_H
@@ -12,22 +12,21 @@ using namespace daisysp;
 
 void Port::Init(float sample_rate, float htime)
 {
-    yt1_     = 0;
-    prvhtim_ = -100.0;
-    htime_   = htime;
+    yt1_ = 0;
 
     sample_rate_ = sample_rate;
     onedsr_      = 1.0 / sample_rate_;
+    SetHtime(htime);
 }
 
-float Port::Process(float in)
+void Port::SetHtime(float htime)
 {
-    if(prvhtim_ != htime_)
+    htime_ = htime;
+    if(htime_ <= 0.0f)
     {
-        c2_      = pow(0.5, onedsr_ / htime_);
-        c1_      = 1.0 - c2_;
-        prvhtim_ = htime_;
+        c1_ = 1.0f; // No portamento
+        return;
     }
-
-    return yt1_ = c1_ * in + c2_ * yt1_;
+    // y += (1 - c2) * (in - y) is the same as y = c1 * in + c2 * y
+    c1_ = 1.0f - powf(0.5f, onedsr_ / htime_);
 }
@@ -35,21 +35,25 @@ class Port
     void Init(float sample_rate, float htime);
 
     /** Applies portamento to input signal and returns processed signal. 
+        One multiply-add per sample; the coefficient is computed in SetHtime().
         \return slewed output signal
     */
-    float Process(float in);
+    inline float Process(float in) { return yt1_ += c1_ * (in - yt1_); }
 
+    /** Jumps straight to a value (no portamento)
+    */
+    inline void Reset(float value) { yt1_ = value; }
 
-    /** Sets htime
+    /** Sets htime and recomputes the filter coefficient
     */
-    inline void SetHtime(float htime) { htime_ = htime; }
+    void SetHtime(float htime);
     /** returns current value of htime
     */
     inline float GetHtime() { return htime_; }
 
   private:
     float htime_;
-    float c1_, c2_, yt1_, prvhtim_;
+    float c1_, yt1_;
     float sample_rate_, onedsr_;
 };
 } // namespace daisysp
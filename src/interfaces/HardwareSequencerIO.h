@@ -4,6 +4,14 @@
  * 
  * This implementation provides the actual hardware interface for the sequencer,
  * bridging the abstraction with the real system components.
+ *
+ * MIDI output is routed per track to USB and the DIN port (a UART at
+ * 31250 baud, MIDI_DIN_SERIAL) through queues that flushMidi() writes in
+ * one batch per port; the main loop calls it after each clock update.
+ * Writes never wait for the transport: what does not fit goes out on a
+ * later flushMidi(), so it must be called every loop pass.
+ * In MPE mode the sequencer track's notes go to USB through MpeOutput
+ * instead, each on its own member channel with per-note expression.
  */
 
 #ifndef HARDWARE_SEQUENCER_IO_H
@@ -13,75 +21,170 @@
 #include "../state/SystemState.h"
 #include <Adafruit_TinyUSB.h>
 #include <MIDI.h>
+#include "../midi/MidiRouter.h"
+#include "../midi/MpeOutput.h"
+#include "../sequencer/SequencerDefs.h"
+
+// UART used for the DIN MIDI output
+#ifndef MIDI_DIN_SERIAL
+#define MIDI_DIN_SERIAL Serial2
+#endif
 
 // Forward declarations for external dependencies
-extern midi::MidiInterface<midi::SerialMIDI<Adafruit_USBD_MIDI>> usb_midi;
+extern Adafruit_USBD_MIDI raw_usb_midi;
 
 /**
  * @brief Hardware implementation of SequencerIO interface
  * 
  * This class provides the concrete implementation that interfaces with
  * the actual hardware components and global state variables.
+ *
+ * The class is final and its methods are inline, so a
+ * BasicSequencer<HardwareSequencerIO> calls them directly, without
+ * virtual dispatch.
  */
-class HardwareSequencerIO : public SequencerIO {
+class HardwareSequencerIO final : public SequencerIO {
 public:
+    // DIN is a byte stream, so it can use running status; USB cannot
+    HardwareSequencerIO()
+        : usbOut(writeUsbMidi, false), dinOut(writeDinMidi, true), midiRouter(usbOut, dinOut),
+          mpe(usbOut), state(SystemState::getInstance()) {}
+
     // MIDI Operations
-    void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t channel) override {
-        usb_midi.sendNoteOn(note, velocity, channel);
+    void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t track) override {
+        if (track != SEQUENCER_MIDI_TRACK) {
+            midiRouter.noteOn(track, note, velocity);
+            return;
+        }
+        if (mpe.isEnabled()) {
+            mpe.noteOn(note, velocity);
+        } else {
+            midiRouter.noteOn(track, note, velocity);
+        }
+        sequencerNote = note;
+    }
+    
+    void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t track) override {
+        if (track != SEQUENCER_MIDI_TRACK) {
+            midiRouter.noteOff(track, note, velocity);
+            return;
+        }
+        if (mpe.isEnabled()) {
+            mpe.noteOff(note, velocity);
+        } else {
+            midiRouter.noteOff(track, note, velocity);
+        }
+        if (sequencerNote == note) {
+            sequencerNote = -1;
+        }
+    }
+    
+    // Track routing, clock and transport output
+    MidiRouter& getMidiRouter() { return midiRouter; }
+    
+    // MPE mode and per-note expression for the sequencer track
+    MpeOutput& getMpe() { return mpe; }
+    
+    // Switch the sequencer track to or from MPE; a sounding note is released
+    // on the path it started on, so it cannot hang
+    void setMpeEnabled(bool enabled) {
+        if (enabled == mpe.isEnabled()) {
+            return;
+        }
+        if (sequencerNote >= 0) {
+            sendNoteOff(sequencerNote, 0, SEQUENCER_MIDI_TRACK);
+        }
+        mpe.setEnabled(enabled);
     }
     
-    void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t channel) override {
-        usb_midi.sendNoteOff(note, velocity, channel);
+    // Write all queued MIDI, one batch per port
+    void flushMidi() {
+        midiRouter.flush();
     }
     
     // Envelope Control
     void triggerEnvelope() override {
-        SystemState::getInstance().setTrigEnv1(true);
+        state.triggerEnv1();
     }
     
     void releaseEnvelope() override {
-        SystemState::getInstance().setTrigEnv1(false);
+        state.setTrigEnv1(false);
     }
     
     // System State Access
     void setNote1(int note) override {
-        SystemState::getInstance().setNote1(note);
+        state.setNote1(note);
     }
     
     void setFreq1(float freq) override {
-        SystemState::getInstance().setFreq1(freq);
+        state.setFreq1(freq);
     }
     
     void setVel1(float velocity) override {
-        SystemState::getInstance().setVel1(velocity);
+        state.setVel1(velocity);
+    }
+    
+    void setSlide1(bool slide) override {
+        state.setSlide1(slide);
+    }
+    
+    void setSynthParam(uint8_t param, float value) override {
+        state.setSynthParam(param, value);
     }
     
     // Scale Access
-    int getScaleNote(int scaleIndex, int noteIndex) override {
-        return SystemState::getInstance().getScaleNote(scaleIndex, noteIndex);
+    int getScaleNote(int noteIndex) override {
+        return state.getScaleNote(noteIndex);
+    }
+    
+    int getNearestScaleDegree(int semitone) override {
+        return state.getNearestScaleDegree(semitone);
     }
     
     // Sensor Data
     int getDistanceMM() override {
-        return SystemState::getInstance().getMM();
+        return state.getMM();
     }
     
     // UI State
     int getSelectedStepForEdit() override {
-        return SystemState::getInstance().getSelectedStepForEdit();
+        return state.getSelectedStepForEdit();
     }
     
     bool isButton16Held() override {
-        return SystemState::getInstance().getButton16Held();
+        return state.getButton16Held();
     }
     
     bool isButton17Held() override {
-        return SystemState::getInstance().getButton17Held();
+        return state.getButton17Held();
     }
     
     bool isButton18Held() override {
-        return SystemState::getInstance().getButton18Held();
+        return state.getButton18Held();
+    }
+
+private:
+    static size_t writeUsbMidi(const uint8_t* data, size_t length) {
+        return raw_usb_midi.write(data, length);
+    }
+
+    // Only what fits in the UART FIFO: at 31250 baud a full batch would
+    // otherwise hold up the main loop (and the clock) for ~30ms
+    static size_t writeDinMidi(const uint8_t* data, size_t length) {
+        const int space = MIDI_DIN_SERIAL.availableForWrite();
+        if (space <= 0) return 0;
+        if (length > static_cast<size_t>(space)) length = space;
+        return MIDI_DIN_SERIAL.write(data, length);
     }
+
+    MidiOutQueue usbOut;
+    MidiOutQueue dinOut;
+    MidiRouter midiRouter;
+    MpeOutput mpe;
+    int sequencerNote = -1; // Sounding sequencer track note
+
+    // Resolved once, so calls skip the singleton's initialization guard
+    SystemState& state;
 };
 
 #endif // HARDWARE_SEQUENCER_IO_H
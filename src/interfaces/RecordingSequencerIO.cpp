@@ -0,0 +1,70 @@
+/**
+ * @file RecordingSequencerIO.cpp
+ * @brief Event recording, digest and text formatting for off-target runs.
+ */
+
+#include "RecordingSequencerIO.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* const EVENT_NAMES[SEQ_EVENT_TYPE_COUNT] = {
+    "on", "off", "trig", "rel", "note", "freq", "vel", "slide", "param"
+};
+
+size_t formatSequencerEvent(const SequencerEvent& event, char* buffer, size_t size) {
+    const char* name = event.type < SEQ_EVENT_TYPE_COUNT ? EVENT_NAMES[event.type] : "?";
+    const int length = snprintf(buffer, size, "%lu %s %u %d %.4f",
+                                static_cast<unsigned long>(event.time), name,
+                                event.index, event.note, event.value);
+    if (length < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(length) < size ? length : (size ? size - 1 : 0);
+}
+
+RecordingSequencerIO::RecordingSequencerIO(const SimulatedClock& time, Quantizer& quantizer)
+    : time(time), quantizer(quantizer) {}
+
+void RecordingSequencerIO::clear() {
+    logHead = 0;
+    loggedCount = 0;
+    eventCount = 0;
+    memset(typeCounts, 0, sizeof(typeCounts));
+    digest = CRC32_INIT;
+}
+
+const SequencerEvent& RecordingSequencerIO::getLogged(uint16_t index) const {
+    const uint16_t count = getLoggedCount();
+    const uint16_t oldest = (logHead + RECORDING_IO_LOG_SIZE - count) % RECORDING_IO_LOG_SIZE;
+    return log[(oldest + index % count) % RECORDING_IO_LOG_SIZE];
+}
+
+void RecordingSequencerIO::store(SequencerEventType type, uint8_t index, int note, float value) {
+    SequencerEvent& event = log[logHead];
+    event.time = time.micros();
+    event.type = type;
+    event.index = index;
+    event.note = static_cast<int16_t>(note);
+    event.value = value;
+    logHead = (logHead + 1) % RECORDING_IO_LOG_SIZE;
+    if (loggedCount < RECORDING_IO_LOG_SIZE) {
+        loggedCount++;
+    }
+
+    // Digest over the fields in a fixed little-endian layout (no padding)
+    uint32_t valueBits;
+    memcpy(&valueBits, &value, sizeof(valueBits));
+    const uint8_t packed[12] = {
+        static_cast<uint8_t>(event.time), static_cast<uint8_t>(event.time >> 8),
+        static_cast<uint8_t>(event.time >> 16), static_cast<uint8_t>(event.time >> 24),
+        type, index,
+        static_cast<uint8_t>(event.note), static_cast<uint8_t>(event.note >> 8),
+        static_cast<uint8_t>(valueBits), static_cast<uint8_t>(valueBits >> 8),
+        static_cast<uint8_t>(valueBits >> 16), static_cast<uint8_t>(valueBits >> 24)
+    };
+    digest = crc32Update(digest, packed, sizeof(packed));
+
+    if (sink) {
+        sink(sinkContext, event);
+    }
+}
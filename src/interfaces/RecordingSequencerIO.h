@@ -0,0 +1,158 @@
+/**
+ * @file RecordingSequencerIO.h
+ * @brief SequencerIO that records every output call with a simulated timestamp
+ *
+ * Used to run the Sequencer off-target. Each output call (notes, envelope,
+ * synth state) becomes a SequencerEvent stamped with the SimulatedClock
+ * time. Events are:
+ *   - folded into a CRC-32 digest, so a long run can be compared against a
+ *     known value in a single check,
+ *   - passed to an optional sink, e.g. to write the stream as text lines
+ *     (formatSequencerEvent) and diff it against a golden file,
+ *   - kept in a ring of the last RECORDING_IO_LOG_SIZE for inspection.
+ *
+ * The sensor and UI inputs are plain values set by the test; scale lookups
+ * go to the given Quantizer.
+ *
+ * In count-only mode events are only counted (no timestamp, digest, sink
+ * or log), so a benchmark measures the sequencer rather than the recording.
+ *
+ * Example:
+ *   void writeLine(void* file, const SequencerEvent& event) {
+ *       char line[64];
+ *       formatSequencerEvent(event, line, sizeof(line));
+ *       fprintf(static_cast<FILE*>(file), "%s\n", line);
+ *   }
+ *   RecordingSequencerIO io(time, quantizer);
+ *   io.setSink(writeLine, goldenFile);
+ *   Sequencer sequencer(&io);
+ */
+
+#ifndef RECORDING_SEQUENCER_IO_H
+#define RECORDING_SEQUENCER_IO_H
+
+#include <stddef.h>
+#include "SequencerIO.h"
+#include "../clock/SimulatedClock.h"
+#include "../quantizer/Quantizer.h"
+#include "../storage/Crc32.h"
+
+// Most recent events kept for inspection
+constexpr uint16_t RECORDING_IO_LOG_SIZE = 256;
+
+enum SequencerEventType : uint8_t {
+    SEQ_EVENT_NOTE_ON = 0,
+    SEQ_EVENT_NOTE_OFF,
+    SEQ_EVENT_ENV_TRIGGER,
+    SEQ_EVENT_ENV_RELEASE,
+    SEQ_EVENT_NOTE1,
+    SEQ_EVENT_FREQ1,
+    SEQ_EVENT_VEL1,
+    SEQ_EVENT_SLIDE1,
+    SEQ_EVENT_SYNTH_PARAM,
+    SEQ_EVENT_TYPE_COUNT
+};
+
+struct SequencerEvent {
+    uint32_t time;           // Simulated microseconds
+    SequencerEventType type;
+    uint8_t index;           // Track (notes) or parameter
+    int16_t note;            // Note number, slide flag, or 0
+    float value;             // Velocity, frequency or parameter value
+};
+
+// Receives every event as it is recorded
+typedef void (*SequencerEventSink)(void* context, const SequencerEvent& event);
+
+/**
+ * @brief Format an event as one text line ("<time> <type> <index> <note> <value>")
+ * @return Characters written (excluding the terminator)
+ */
+size_t formatSequencerEvent(const SequencerEvent& event, char* buffer, size_t size);
+
+class RecordingSequencerIO final : public SequencerIO {
+public:
+    RecordingSequencerIO(const SimulatedClock& time, Quantizer& quantizer);
+
+    void setSink(SequencerEventSink sink, void* context = nullptr) {
+        this->sink = sink;
+        sinkContext = context;
+    }
+
+    // Forget all recorded events and restart the digest
+    void clear();
+
+    void setCountOnly(bool enabled) { countOnly = enabled; }
+
+    uint32_t getEventCount() const { return eventCount; }
+    uint32_t getEventCount(SequencerEventType type) const { return typeCounts[type]; }
+    uint32_t getDigest() const { return digest ^ CRC32_INIT; }
+
+    // Events still in the ring, oldest first (index 0 to getLoggedCount()-1)
+    uint16_t getLoggedCount() const { return loggedCount; }
+    const SequencerEvent& getLogged(uint16_t index) const;
+
+    // Inputs seen by the sequencer
+    void setDistanceMM(int mm) { distanceMM = mm; }
+    void setSelectedStep(int step) { selectedStep = step; }
+    void setButtons(bool button16, bool button17, bool button18) {
+        buttons[0] = button16;
+        buttons[1] = button17;
+        buttons[2] = button18;
+    }
+
+    void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t track) override {
+        record(SEQ_EVENT_NOTE_ON, track, note, velocity);
+    }
+    void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t track) override {
+        record(SEQ_EVENT_NOTE_OFF, track, note, velocity);
+    }
+    void triggerEnvelope() override { record(SEQ_EVENT_ENV_TRIGGER, 0, 0, 0.0f); }
+    void releaseEnvelope() override { record(SEQ_EVENT_ENV_RELEASE, 0, 0, 0.0f); }
+    void setNote1(int note) override { record(SEQ_EVENT_NOTE1, 0, note, 0.0f); }
+    void setFreq1(float freq) override { record(SEQ_EVENT_FREQ1, 0, 0, freq); }
+    void setVel1(float velocity) override { record(SEQ_EVENT_VEL1, 0, 0, velocity); }
+    void setSlide1(bool slide) override { record(SEQ_EVENT_SLIDE1, 0, slide, 0.0f); }
+    void setSynthParam(uint8_t param, float value) override {
+        record(SEQ_EVENT_SYNTH_PARAM, param, 0, value);
+    }
+
+    int getScaleNote(int noteIndex) override { return quantizer.getNote(noteIndex); }
+    int getNearestScaleDegree(int semitone) override { return quantizer.getNearestDegree(semitone); }
+
+    int getDistanceMM() override { return distanceMM; }
+    int getSelectedStepForEdit() override { return selectedStep; }
+    bool isButton16Held() override { return buttons[0]; }
+    bool isButton17Held() override { return buttons[1]; }
+    bool isButton18Held() override { return buttons[2]; }
+
+private:
+    void record(SequencerEventType type, uint8_t index, int note, float value) {
+        eventCount++;
+        typeCounts[type]++;
+        if (!countOnly) {
+            store(type, index, note, value);
+        }
+    }
+    void store(SequencerEventType type, uint8_t index, int note, float value);
+
+    const SimulatedClock& time;
+    Quantizer& quantizer;
+
+    bool countOnly = false;
+    SequencerEventSink sink = nullptr;
+    void* sinkContext = nullptr;
+
+    SequencerEvent log[RECORDING_IO_LOG_SIZE];
+    uint16_t logHead = 0; // Next slot to write
+    uint16_t loggedCount = 0;
+    uint32_t eventCount = 0;
+    uint32_t typeCounts[SEQ_EVENT_TYPE_COUNT] = {};
+    uint32_t digest = CRC32_INIT;
+
+    int distanceMM = 0;
+    int selectedStep = -1;
+    bool buttons[3] = {};
+};
+
+#endif // RECORDING_SEQUENCER_IO_H
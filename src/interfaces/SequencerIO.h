@@ -21,9 +21,9 @@ class SequencerIO {
 public:
     virtual ~SequencerIO() = default;
     
-    // MIDI Operations
-    virtual void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t channel) = 0;
-    virtual void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t channel) = 0;
+    // MIDI Operations; the implementation maps the track to ports and channel
+    virtual void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t track) = 0;
+    virtual void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t track) = 0;
     
     // Envelope Control
     virtual void triggerEnvelope() = 0;
@@ -33,9 +33,12 @@ public:
     virtual void setNote1(int note) = 0;
     virtual void setFreq1(float freq) = 0;
     virtual void setVel1(float velocity) = 0;
+    virtual void setSlide1(bool slide) = 0;
+    virtual void setSynthParam(uint8_t param, float value) = 0;
     
     // Scale Access
-    virtual int getScaleNote(int scaleIndex, int noteIndex) = 0;
+    virtual int getScaleNote(int noteIndex) = 0;
+    virtual int getNearestScaleDegree(int semitone) = 0;
     
     // Sensor Data
     virtual int getDistanceMM() = 0;
@@ -0,0 +1,165 @@
+/**
+ * @file MidiInput.cpp
+ * @brief Table-driven MIDI input: step recording, transpose and CC mapping.
+ */
+
+#include "MidiInput.h"
+#include "../state/SystemState.h"
+#include <string.h>
+
+static_assert(SYNTH_PARAM_COUNT <= 8, "Pending controller mask is 8 bits");
+
+// Indexed by the status byte's high nibble minus 8
+const MidiInput::ChannelHandler MidiInput::CHANNEL_HANDLERS[8] = {
+    &MidiInput::onNoteOff,        // 0x8n
+    &MidiInput::onNoteOn,         // 0x9n
+    &MidiInput::onIgnored,        // 0xAn polyphonic aftertouch
+    &MidiInput::onControlChange,  // 0xBn
+    &MidiInput::onIgnored,        // 0xCn program change
+    &MidiInput::onIgnored,        // 0xDn channel pressure
+    &MidiInput::onPitchBend,      // 0xEn
+    &MidiInput::onIgnored,        // 0xFn system (real-time handled separately)
+};
+
+// Default controller assignments (sound controllers where they fit)
+static const struct {
+    uint8_t cc;
+    SynthParam param;
+} DEFAULT_CONTROLLERS[] = {
+    {73, SYNTH_PARAM_ATTACK},
+    {75, SYNTH_PARAM_DECAY},
+    {70, SYNTH_PARAM_SUSTAIN},
+    {72, SYNTH_PARAM_RELEASE},
+    {5, SYNTH_PARAM_GLIDE},       // Portamento time
+    {71, SYNTH_PARAM_RESONANCE},
+    {76, SYNTH_PARAM_DRIVE},
+};
+
+MidiInput::MidiInput(Sequencer& sequencer, Quantizer& quantizer)
+    : sequencer(sequencer), quantizer(quantizer) {
+    memset(controllerMap, MIDI_CC_UNMAPPED, sizeof(controllerMap));
+    for (const auto& entry : DEFAULT_CONTROLLERS) {
+        controllerMap[entry.cc] = entry.param;
+    }
+}
+
+void MidiInput::handleMessage(uint8_t status, uint8_t channel, uint8_t data1, uint8_t data2) {
+    if (status >= MIDI_STATUS_CLOCK) {
+        void (*handler)() = realtimeHandlers[status - MIDI_STATUS_CLOCK];
+        if (handler) {
+            handler();
+        }
+        return;
+    }
+    if (status < 0x80 || (this->channel != MIDI_INPUT_OMNI && channel != this->channel)) {
+        return;
+    }
+    (this->*CHANNEL_HANDLERS[(status >> 4) - 8])(data1 & 0x7F, data2 & 0x7F);
+}
+
+void MidiInput::update(uint32_t nowMillis) {
+    if (pendingMask != 0) {
+        if (!gestureOpen) {
+            sequencer.beginEditGroup();
+            gestureOpen = true;
+        }
+        for (uint8_t param = 0; pendingMask != 0; ++param, pendingMask >>= 1) {
+            if (pendingMask & 1u) {
+                const uint16_t raw = static_cast<uint32_t>(pendingValues[param]) * SYNTH_PARAM_RAW_MAX / 127;
+                sequencer.setParamBase(static_cast<SynthParam>(param), synthParamFromRaw(param, raw));
+            }
+        }
+        lastControllerMillis = nowMillis;
+    } else if (gestureOpen && nowMillis - lastControllerMillis >= MIDI_CC_GESTURE_MS) {
+        sequencer.endEditGroup();
+        gestureOpen = false;
+    }
+}
+
+void MidiInput::setRealtimeHandler(uint8_t status, void (*handler)()) {
+    if (status >= MIDI_STATUS_CLOCK) {
+        realtimeHandlers[status - MIDI_STATUS_CLOCK] = handler;
+    }
+}
+
+void MidiInput::mapController(uint8_t cc, SynthParam param) {
+    if (cc < 128 && param < SYNTH_PARAM_COUNT) {
+        controllerMap[cc] = param;
+    }
+}
+
+void MidiInput::unmapController(uint8_t cc) {
+    if (cc < 128) {
+        controllerMap[cc] = MIDI_CC_UNMAPPED;
+    }
+}
+
+void MidiInput::setStepRecord(bool enabled) {
+    stepRecord = enabled;
+    recordStep = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Channel message handlers
+// -----------------------------------------------------------------------------
+
+void MidiInput::onNoteOff(uint8_t note, uint8_t velocity) {
+    // Transpose latches and recorded steps keep their gate length
+    (void)note;
+    (void)velocity;
+}
+
+void MidiInput::onNoteOn(uint8_t note, uint8_t velocity) {
+    if (velocity == 0) {
+        onNoteOff(note, velocity);
+        return;
+    }
+    if (stepRecord) {
+        recordNote(note, velocity);
+    } else {
+        sequencer.setTranspose(static_cast<int8_t>(note - MIDI_TRANSPOSE_CENTER));
+    }
+}
+
+void MidiInput::onControlChange(uint8_t cc, uint8_t value) {
+    const uint8_t param = controllerMap[cc];
+    if (param != MIDI_CC_UNMAPPED) {
+        pendingValues[param] = value;
+        pendingMask |= 1u << param;
+    }
+}
+
+void MidiInput::onPitchBend(uint8_t lsb, uint8_t msb) {
+    SystemState::getInstance().setPitchBend(((msb << 7) | lsb) - 8192);
+}
+
+void MidiInput::onIgnored(uint8_t data1, uint8_t data2) {
+    (void)data1;
+    (void)data2;
+}
+
+/**
+ * @brief Write a note into the record cursor step (or the held step pad),
+ * audition it and move the cursor on.
+ */
+void MidiInput::recordNote(uint8_t note, uint8_t velocity) {
+    const int held = SystemState::getInstance().getSelectedStepForEdit();
+    if (held >= 0) {
+        recordStep = held;
+    }
+    if (recordStep >= sequencer.getStepLength()) {
+        recordStep = 0;
+    }
+
+    // One undo step per recorded note
+    sequencer.beginEditGroup();
+    if (!sequencer.getStep(recordStep).gate) {
+        sequencer.toggleStep(recordStep);
+    }
+    sequencer.setStepNote(recordStep, quantizer.getNearestDegree(note - MIDI_BASE_NOTE));
+    sequencer.setStepVelocity(recordStep, velocity);
+    sequencer.endEditGroup();
+    sequencer.playStepNow(recordStep);
+
+    recordStep = (recordStep + 1) % sequencer.getStepLength();
+}
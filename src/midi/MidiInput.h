@@ -0,0 +1,117 @@
+/**
+ * @file MidiInput.h
+ * @brief Routes incoming MIDI into the sequencer
+ *
+ * - Note on: with step recording on, writes note, velocity and gate into
+ *   the record cursor step and moves the cursor on (a held step pad moves
+ *   the cursor there first); otherwise transposes the running pattern
+ *   relative to MIDI_TRANSPOSE_CENTER.
+ * - Control change: mapped controllers set a synth parameter's pattern
+ *   base value. Values are only latched here and applied once per update(),
+ *   and a sweep undoes as one edit.
+ * - Pitch bend: bends the pitch CV by up to PITCH_BEND_RANGE_SEMITONES.
+ * - Real-time (clock, start, continue, stop): forwarded to handlers set
+ *   with setRealtimeHandler().
+ *
+ * Dispatch is a table lookup on the status byte and every handler is O(1),
+ * so a dense controller stream costs a few instructions per message.
+ *
+ * Example:
+ *   MidiInput midiInput(sequencer, quantizer);
+ *   midiInput.setRealtimeHandler(MIDI_STATUS_CLOCK, onMidiClock);
+ *   // Message callback
+ *   midiInput.handleMessage(status, channel, data1, data2);
+ *   // loop()
+ *   midiInput.update(millis());
+ */
+
+#ifndef MIDI_INPUT_H
+#define MIDI_INPUT_H
+
+#include <stdint.h>
+#include "../sequencer/Sequencer.h"
+#include "../quantizer/Quantizer.h"
+
+// Status bytes of the handled real-time messages
+constexpr uint8_t MIDI_STATUS_CLOCK = 0xF8;
+constexpr uint8_t MIDI_STATUS_START = 0xFA;
+constexpr uint8_t MIDI_STATUS_CONTINUE = 0xFB;
+constexpr uint8_t MIDI_STATUS_STOP = 0xFC;
+
+// Receive on all channels
+constexpr uint8_t MIDI_INPUT_OMNI = 0;
+
+// Note that plays the pattern untransposed (C3)
+constexpr uint8_t MIDI_TRANSPOSE_CENTER = 60;
+
+// Controller value writes closer together than this belong to one sweep
+constexpr uint32_t MIDI_CC_GESTURE_MS = 500;
+
+// Messages processed per main loop pass at most
+constexpr uint8_t MIDI_INPUT_MAX_PER_LOOP = 8;
+
+// No parameter mapped to a controller
+constexpr uint8_t MIDI_CC_UNMAPPED = 0xFF;
+
+class MidiInput {
+public:
+    MidiInput(Sequencer& sequencer, Quantizer& quantizer);
+
+    /**
+     * @brief Handle one message
+     * @param status Status byte (channel bits are ignored)
+     * @param channel 1-16
+     * @param data1 First data byte
+     * @param data2 Second data byte
+     */
+    void handleMessage(uint8_t status, uint8_t channel, uint8_t data1, uint8_t data2);
+
+    /**
+     * @brief Apply latched controller values; call once per main loop pass.
+     * Cost is O(parameters changed since the last call).
+     */
+    void update(uint32_t nowMillis);
+
+    // Channel to listen on (1-16, or MIDI_INPUT_OMNI)
+    void setChannel(uint8_t channel) { this->channel = channel; }
+
+    // Real-time message handler (clock, start, continue, stop)
+    void setRealtimeHandler(uint8_t status, void (*handler)());
+
+    // Map a controller to a synth parameter's base value
+    void mapController(uint8_t cc, SynthParam param);
+    void unmapController(uint8_t cc);
+
+    // Step recording: note-ons are written into successive steps
+    void setStepRecord(bool enabled);
+    bool isStepRecording() const { return stepRecord; }
+    uint8_t getRecordStep() const { return recordStep; }
+
+private:
+    typedef void (MidiInput::*ChannelHandler)(uint8_t data1, uint8_t data2);
+    static const ChannelHandler CHANNEL_HANDLERS[8];
+
+    void onNoteOff(uint8_t note, uint8_t velocity);
+    void onNoteOn(uint8_t note, uint8_t velocity);
+    void onControlChange(uint8_t cc, uint8_t value);
+    void onPitchBend(uint8_t lsb, uint8_t msb);
+    void onIgnored(uint8_t data1, uint8_t data2);
+    void recordNote(uint8_t note, uint8_t velocity);
+
+    Sequencer& sequencer;
+    Quantizer& quantizer;
+
+    uint8_t channel = MIDI_INPUT_OMNI;
+    void (*realtimeHandlers[8])() = {};
+
+    uint8_t controllerMap[128];
+    uint8_t pendingValues[SYNTH_PARAM_COUNT] = {};
+    uint8_t pendingMask = 0;
+    bool gestureOpen = false;
+    uint32_t lastControllerMillis = 0;
+
+    bool stepRecord = false;
+    uint8_t recordStep = 0;
+};
+
+#endif // MIDI_INPUT_H
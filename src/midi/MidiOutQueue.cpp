@@ -0,0 +1,200 @@
+/**
+ * @file MidiOutQueue.cpp
+ * @brief Batched, coalescing MIDI output.
+ */
+
+#include "MidiOutQueue.h"
+
+static constexpr uint8_t STATUS_NOTE_OFF = 0x80;
+static constexpr uint8_t STATUS_NOTE_ON = 0x90;
+static constexpr uint8_t STATUS_CONTROL_CHANGE = 0xB0;
+static constexpr uint8_t STATUS_CHANNEL_PRESSURE = 0xD0;
+static constexpr uint8_t STATUS_PITCH_BEND = 0xE0;
+
+static uint8_t channelBits(uint8_t channel) {
+    return (channel - 1) & 0x0F;
+}
+
+// Data entry, increment/decrement and (N)RPN selection act in sequence, so
+// each of them has to go out
+static bool isParameterController(uint8_t controller) {
+    return controller == 6 || controller == 38 || (controller >= 96 && controller <= 101);
+}
+
+static bool isNoteMessage(uint8_t status) {
+    const uint8_t type = status & 0xF0;
+    return type == STATUS_NOTE_ON || type == STATUS_NOTE_OFF;
+}
+
+// Program change and channel pressure have one data byte
+static bool hasTwoDataBytes(uint8_t status) {
+    const uint8_t type = status & 0xF0;
+    return type != 0xC0 && type != STATUS_CHANNEL_PRESSURE;
+}
+
+MidiOutQueue::MidiOutQueue(MidiWriteFunction write, bool runningStatus)
+    : write(write), runningStatus(runningStatus) {}
+
+void MidiOutQueue::noteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+    push(STATUS_NOTE_ON | channelBits(channel), note & 0x7F, velocity & 0x7F);
+}
+
+void MidiOutQueue::noteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+    if (isReleasePending(channelBits(channel), note & 0x7F)) {
+        stats.messagesCoalesced++;
+        return;
+    }
+    push(STATUS_NOTE_OFF | channelBits(channel), note & 0x7F, velocity & 0x7F);
+}
+
+void MidiOutQueue::controlChange(uint8_t channel, uint8_t controller, uint8_t value) {
+    const uint8_t status = STATUS_CONTROL_CHANGE | channelBits(channel);
+    if (isParameterController(controller & 0x7F) ||
+        !replacePending(status, controller & 0x7F, value & 0x7F, true)) {
+        push(status, controller & 0x7F, value & 0x7F);
+    }
+}
+
+void MidiOutQueue::pitchBend(uint8_t channel, int16_t bend) {
+    const uint16_t value = static_cast<uint16_t>(bend + 8192) & 0x3FFF;
+    const uint8_t status = STATUS_PITCH_BEND | channelBits(channel);
+    if (!replacePending(status, value & 0x7F, value >> 7, false)) {
+        push(status, value & 0x7F, value >> 7);
+    }
+}
+
+void MidiOutQueue::channelPressure(uint8_t channel, uint8_t pressure) {
+    const uint8_t status = STATUS_CHANNEL_PRESSURE | channelBits(channel);
+    if (!replacePending(status, pressure & 0x7F, 0, false)) {
+        push(status, pressure & 0x7F, 0);
+    }
+}
+
+void MidiOutQueue::realTime(uint8_t status) {
+    if (realtimeCount == MIDI_OUT_REALTIME_SIZE) {
+        stats.earlyFlushes++;
+        flush();
+        if (realtimeCount == MIDI_OUT_REALTIME_SIZE) {
+            stats.messagesDropped++;
+            return;
+        }
+    }
+    realtime[realtimeCount++] = status;
+    stats.messagesQueued++;
+}
+
+void MidiOutQueue::flush() {
+    // Real-time bytes may go anywhere in the stream, even inside a message,
+    // so they are not held up by the rest of the last batch
+    if (realtimeCount > 0) {
+        const size_t written = send(realtime, realtimeCount);
+        for (size_t i = written; i < realtimeCount; i++) {
+            realtime[i - written] = realtime[i];
+        }
+        realtimeCount -= static_cast<uint8_t>(written);
+    }
+
+    if (pendingLength > 0) {
+        const size_t written = send(batch + pendingStart, pendingLength);
+        pendingStart += static_cast<uint8_t>(written);
+        pendingLength -= static_cast<uint8_t>(written);
+        if (pendingLength > 0) {
+            // Transport still backed up; queued messages wait
+            return;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    size_t length = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const Message& message = queue[i];
+        if (runningStatus && message.status == lastStatus) {
+            stats.statusBytesSaved++;
+        } else {
+            batch[length++] = message.status;
+            lastStatus = message.status;
+        }
+        batch[length++] = message.data1;
+        if (hasTwoDataBytes(message.status)) {
+            batch[length++] = message.data2;
+        }
+    }
+    count = 0;
+
+    const size_t written = send(batch, length);
+    pendingStart = static_cast<uint8_t>(written);
+    pendingLength = static_cast<uint8_t>(length - written);
+}
+
+/**
+ * @brief One non-blocking write to the transport.
+ * @return Bytes it took
+ */
+size_t MidiOutQueue::send(const uint8_t* data, size_t length) {
+    size_t written = write(data, length);
+    if (written > length) written = length;
+    if (written > 0) stats.batches++;
+    if (written < length) stats.partialWrites++;
+    stats.bytesWritten += written;
+    return written;
+}
+
+void MidiOutQueue::push(uint8_t status, uint8_t data1, uint8_t data2) {
+    if (count == MIDI_OUT_QUEUE_SIZE) {
+        stats.earlyFlushes++;
+        flush();
+        if (count == MIDI_OUT_QUEUE_SIZE) {
+            stats.messagesDropped++;
+            return;
+        }
+    }
+    queue[count++] = {status, data1, data2};
+    stats.messagesQueued++;
+}
+
+/**
+ * @brief Give a pending message of the same kind the new value. The search
+ * stops at a note message on the same channel: a value sent after a note
+ * must not move ahead of it (e.g. the bend of a new note ahead of the
+ * previous note's note-off).
+ * @param matchData1 Also match the first data byte (controller number)
+ */
+bool MidiOutQueue::replacePending(uint8_t status, uint8_t data1, uint8_t data2, bool matchData1) {
+    const uint8_t channel = status & 0x0F;
+    for (uint8_t i = count; i-- > 0;) {
+        Message& message = queue[i];
+        if ((message.status & 0x0F) == channel && isNoteMessage(message.status)) {
+            return false;
+        }
+        if (message.status == status && (!matchData1 || message.data1 == data1)) {
+            message.data1 = data1;
+            message.data2 = data2;
+            stats.messagesCoalesced++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief The newest pending message for the note is already a note-off.
+ */
+bool MidiOutQueue::isReleasePending(uint8_t channelBits, uint8_t note) const {
+    for (uint8_t i = count; i-- > 0;) {
+        const Message& message = queue[i];
+        if ((message.status & 0x0F) != channelBits || message.data1 != note) {
+            continue;
+        }
+        const uint8_t type = message.status & 0xF0;
+        if (type == STATUS_NOTE_OFF) {
+            return true;
+        }
+        if (type == STATUS_NOTE_ON) {
+            return false;
+        }
+    }
+    return false;
+}
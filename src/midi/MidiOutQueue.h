@@ -0,0 +1,121 @@
+/**
+ * @file MidiOutQueue.h
+ * @brief Outgoing MIDI collected per tick and written as one batch
+ *
+ * Channel messages are queued in order and written by flush() in a single
+ * write, normally once per clock tick, so the transport sees one batch
+ * instead of a write per message. Redundant messages are coalesced while
+ * queued: a newer controller, pitch bend or pressure value replaces the
+ * pending one unless a note message on that channel was queued in between,
+ * and a repeated note-off for a note that is already being released is
+ * dropped. Data entry and (N)RPN controllers (6, 38, 96-101) are never
+ * coalesced, since their order carries meaning. Real-time messages (clock,
+ * start, stop) have their own queue and go out at the front of the batch,
+ * as MIDI allows them anywhere.
+ *
+ * With running status enabled (byte-stream transports such as DIN), the
+ * status byte is left out when it repeats, also across batches, so the
+ * queue must be the only writer on such a port. USB MIDI wraps every
+ * message in its own event packet, so running status is left off there.
+ *
+ * Writes never block: the transport takes what fits (e.g. the free space
+ * in a UART FIFO) and the rest of the batch is sent by the next flush().
+ * Until it has gone, newer messages stay queued, where they can still be
+ * coalesced; real-time messages skip ahead of it, since MIDI allows them
+ * even between the bytes of another message.
+ *
+ * A full queue is flushed early. Only if the transport cannot take that
+ * batch either is the new message dropped (and counted).
+ *
+ * Example:
+ *   size_t writeUsb(const uint8_t* data, size_t length) { return raw_usb_midi.write(data, length); }
+ *   MidiOutQueue out(writeUsb, false);
+ *   out.noteOn(1, 60, 100);
+ *   out.realTime(0xF8);                 // Clock
+ *   out.flush();    // F8 90 3C 64
+ */
+
+#ifndef MIDI_OUT_QUEUE_H
+#define MIDI_OUT_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Channel messages held between flushes
+constexpr uint8_t MIDI_OUT_QUEUE_SIZE = 32;
+// Real-time messages held between flushes
+constexpr uint8_t MIDI_OUT_REALTIME_SIZE = 8;
+
+// Writes up to length MIDI bytes without blocking; returns the number written
+typedef size_t (*MidiWriteFunction)(const uint8_t* data, size_t length);
+
+struct MidiOutStats {
+    uint32_t messagesQueued = 0;    // Channel and real-time messages accepted
+    uint32_t messagesCoalesced = 0; // Replaced or dropped as redundant
+    uint32_t bytesWritten = 0;
+    uint32_t statusBytesSaved = 0;  // Left out by running status
+    uint32_t batches = 0;           // Writes to the transport
+    uint32_t earlyFlushes = 0;      // Flushes forced by a full queue
+    uint32_t partialWrites = 0;     // Writes the transport only took in part
+    uint32_t messagesDropped = 0;   // Queue full while the transport was backed up
+};
+
+class MidiOutQueue {
+public:
+    /**
+     * @param write Transport write function
+     * @param runningStatus Leave out repeated status bytes
+     */
+    MidiOutQueue(MidiWriteFunction write, bool runningStatus);
+
+    // Channel messages; channel is 1-16
+    void noteOn(uint8_t channel, uint8_t note, uint8_t velocity);
+    void noteOff(uint8_t channel, uint8_t note, uint8_t velocity);
+    void controlChange(uint8_t channel, uint8_t controller, uint8_t value);
+    void pitchBend(uint8_t channel, int16_t bend); // -8192 to 8191
+    void channelPressure(uint8_t channel, uint8_t pressure);
+
+    // Real-time message (status byte 0xF8-0xFF)
+    void realTime(uint8_t status);
+
+    /**
+     * @brief Write what the transport takes now: pending real-time bytes,
+     * the rest of the previous batch, then everything queued as one new
+     * batch. Never blocks. Cost is O(queued).
+     */
+    void flush();
+
+    // Nothing queued and nothing left of the last batch
+    bool isEmpty() const { return count == 0 && realtimeCount == 0 && pendingLength == 0; }
+
+    const MidiOutStats& getStats() const { return stats; }
+    void resetStats() { stats = MidiOutStats(); }
+
+private:
+    struct Message {
+        uint8_t status;
+        uint8_t data1;
+        uint8_t data2;
+    };
+
+    void push(uint8_t status, uint8_t data1, uint8_t data2);
+    bool replacePending(uint8_t status, uint8_t data1, uint8_t data2, bool matchData1);
+    bool isReleasePending(uint8_t channelBits, uint8_t note) const;
+    size_t send(const uint8_t* data, size_t length);
+
+    MidiWriteFunction write;
+    bool runningStatus;
+    uint8_t lastStatus = 0; // Running status carried across batches
+
+    Message queue[MIDI_OUT_QUEUE_SIZE];
+    uint8_t count = 0;
+    uint8_t realtime[MIDI_OUT_REALTIME_SIZE];
+    uint8_t realtimeCount = 0;
+    uint8_t batch[MIDI_OUT_QUEUE_SIZE * 3];
+    uint8_t pendingStart = 0;  // Unwritten bytes of the last batch
+    uint8_t pendingLength = 0;
+
+    MidiOutStats stats;
+};
+
+#endif // MIDI_OUT_QUEUE_H
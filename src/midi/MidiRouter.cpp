@@ -0,0 +1,102 @@
+/**
+ * @file MidiRouter.cpp
+ * @brief Track routing tables, clock dividers and transport output.
+ */
+
+#include "MidiRouter.h"
+
+static constexpr uint8_t STATUS_CLOCK = 0xF8;
+static constexpr uint8_t STATUS_START = 0xFA;
+static constexpr uint8_t STATUS_CONTINUE = 0xFB;
+static constexpr uint8_t STATUS_STOP = 0xFC;
+
+MidiRouter::MidiRouter(MidiOutQueue& usb, MidiOutQueue& din) {
+    ports[MIDI_PORT_USB] = &usb;
+    ports[MIDI_PORT_DIN] = &din;
+
+    // Every track on every port, track n on channel n+1
+    for (uint8_t track = 0; track < MIDI_ROUTE_TRACKS; track++) {
+        routes[track].portMask = MIDI_PORTS_ALL;
+        routes[track].channel = track + 1;
+        rebuildRoute(routes[track]);
+    }
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        clockTicksPerPulse[port] = MIDI_CLOCK_TICKS;
+    }
+}
+
+void MidiRouter::setTrackRoute(uint8_t track, uint8_t portMask, uint8_t channel) {
+    if (track >= MIDI_ROUTE_TRACKS || channel < 1 || channel > 16) {
+        return;
+    }
+    routes[track].portMask = portMask & MIDI_PORTS_ALL;
+    routes[track].channel = channel;
+    rebuildRoute(routes[track]);
+}
+
+/**
+ * @brief Precompute the targets a track's messages fan out to.
+ */
+void MidiRouter::rebuildRoute(Route& route) {
+    route.count = 0;
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        if (route.portMask & (1u << port)) {
+            route.targets[route.count++] = {ports[port], route.channel};
+        }
+    }
+}
+
+void MidiRouter::setClockDivision(MidiPort port, uint8_t division) {
+    if (port >= MIDI_PORT_COUNT || division < 1 || division > MIDI_CLOCK_DIVISION_MAX) {
+        return;
+    }
+    clockTicksPerPulse[port] = division * MIDI_CLOCK_TICKS;
+    clockCounters[port] = 0;
+}
+
+uint8_t MidiRouter::getClockDivision(MidiPort port) const {
+    return port < MIDI_PORT_COUNT ? clockTicksPerPulse[port] / MIDI_CLOCK_TICKS : 1;
+}
+
+void MidiRouter::clockTick() {
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        if (!(clockPorts & (1u << port))) {
+            continue;
+        }
+        if (clockCounters[port] == 0) {
+            ports[port]->realTime(STATUS_CLOCK);
+        }
+        if (++clockCounters[port] >= clockTicksPerPulse[port]) {
+            clockCounters[port] = 0;
+        }
+    }
+}
+
+void MidiRouter::start() {
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        clockCounters[port] = 0;
+    }
+    sendTransport(STATUS_START);
+}
+
+void MidiRouter::continuePlayback() {
+    sendTransport(STATUS_CONTINUE);
+}
+
+void MidiRouter::stop() {
+    sendTransport(STATUS_STOP);
+}
+
+void MidiRouter::flush() {
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        ports[port]->flush();
+    }
+}
+
+void MidiRouter::sendTransport(uint8_t status) {
+    for (uint8_t port = 0; port < MIDI_PORT_COUNT; port++) {
+        if (clockPorts & (1u << port)) {
+            ports[port]->realTime(status);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file MidiRouter.h
+ * @brief Routes track notes, clock and transport to the MIDI output ports
+ *
+ * Each track has a port mask and a channel. Whenever a route changes, its
+ * fan-out is rebuilt into a short list of (port queue, channel) targets,
+ * so sending a note is a table lookup plus one queue push per port.
+ *
+ * Clock and transport go to the clock ports. clockTick() is called at the
+ * internal 96 PPQN; each port sends a MIDI clock every
+ * MIDI_CLOCK_TICKS * division ticks (division 1 = standard 24 PPQN,
+ * 2 = 12 PPQN, ...). Start resets the dividers, so the first pulse after
+ * Start falls on the downbeat.
+ *
+ * Example:
+ *   MidiRouter router(usbQueue, dinQueue);
+ *   router.setTrackRoute(0, midiPortBit(MIDI_PORT_DIN), 2);  // Track 0 -> DIN ch 2
+ *   router.setClockDivision(MIDI_PORT_DIN, 2);
+ *   router.start();
+ *   router.noteOn(0, 60, 100);
+ *   router.clockTick();   // Every 96 PPQN tick
+ *   router.flush();
+ */
+
+#ifndef MIDI_ROUTER_H
+#define MIDI_ROUTER_H
+
+#include <stdint.h>
+#include "MidiOutQueue.h"
+
+enum MidiPort : uint8_t {
+    MIDI_PORT_USB = 0,
+    MIDI_PORT_DIN,
+    MIDI_PORT_COUNT
+};
+
+constexpr uint8_t midiPortBit(MidiPort port) {
+    return static_cast<uint8_t>(1u << port);
+}
+
+constexpr uint8_t MIDI_PORTS_ALL = (1u << MIDI_PORT_COUNT) - 1;
+
+// Note sources that can be routed independently
+constexpr uint8_t MIDI_ROUTE_TRACKS = 4;
+
+// Internal 96 PPQN ticks per MIDI clock at division 1 (24 PPQN)
+constexpr uint8_t MIDI_CLOCK_TICKS = 4;
+
+// Largest clock division (one pulse per bar at 4/4)
+constexpr uint8_t MIDI_CLOCK_DIVISION_MAX = 96 / MIDI_CLOCK_TICKS;
+
+class MidiRouter {
+public:
+    MidiRouter(MidiOutQueue& usb, MidiOutQueue& din);
+
+    /**
+     * @brief Set where a track's notes go
+     * @param track Track index (0 to MIDI_ROUTE_TRACKS-1)
+     * @param portMask midiPortBit() of each port, 0 mutes the track
+     * @param channel MIDI channel 1-16
+     */
+    void setTrackRoute(uint8_t track, uint8_t portMask, uint8_t channel);
+    uint8_t getTrackPorts(uint8_t track) const { return routes[trackIndex(track)].portMask; }
+    uint8_t getTrackChannel(uint8_t track) const { return routes[trackIndex(track)].channel; }
+
+    void noteOn(uint8_t track, uint8_t note, uint8_t velocity) {
+        const Route& route = routes[trackIndex(track)];
+        for (uint8_t i = 0; i < route.count; i++) {
+            route.targets[i].queue->noteOn(route.targets[i].channel, note, velocity);
+        }
+    }
+
+    void noteOff(uint8_t track, uint8_t note, uint8_t velocity) {
+        const Route& route = routes[trackIndex(track)];
+        for (uint8_t i = 0; i < route.count; i++) {
+            route.targets[i].queue->noteOff(route.targets[i].channel, note, velocity);
+        }
+    }
+
+    // Ports that receive clock and transport
+    void setClockPorts(uint8_t portMask) { clockPorts = portMask & MIDI_PORTS_ALL; }
+    uint8_t getClockPorts() const { return clockPorts; }
+
+    // Clock pulses per quarter note are 24 / division
+    void setClockDivision(MidiPort port, uint8_t division);
+    uint8_t getClockDivision(MidiPort port) const;
+
+    /**
+     * @brief Advance the clock dividers by one 96 PPQN tick. O(ports).
+     */
+    void clockTick();
+
+    // Transport output; start() also realigns the clock dividers
+    void start();
+    void continuePlayback();
+    void stop();
+
+    // Write everything queued on all ports (one batch per port)
+    void flush();
+
+    const MidiOutStats& getStats(MidiPort port) const { return ports[port]->getStats(); }
+
+private:
+    struct Target {
+        MidiOutQueue* queue;
+        uint8_t channel;
+    };
+
+    struct Route {
+        Target targets[MIDI_PORT_COUNT];
+        uint8_t count;
+        uint8_t portMask;
+        uint8_t channel;
+    };
+
+    static uint8_t trackIndex(uint8_t track) { return track < MIDI_ROUTE_TRACKS ? track : 0; }
+    void rebuildRoute(Route& route);
+    void sendTransport(uint8_t status);
+
+    MidiOutQueue* ports[MIDI_PORT_COUNT];
+    Route routes[MIDI_ROUTE_TRACKS];
+
+    uint8_t clockPorts = MIDI_PORTS_ALL;
+    uint8_t clockTicksPerPulse[MIDI_PORT_COUNT];
+    uint8_t clockCounters[MIDI_PORT_COUNT] = {};
+};
+
+#endif // MIDI_ROUTER_H
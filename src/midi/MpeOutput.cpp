@@ -0,0 +1,188 @@
+/**
+ * @file MpeOutput.cpp
+ * @brief MPE channel allocation and per-note expression streaming.
+ */
+
+#include "MpeOutput.h"
+
+static constexpr uint8_t CC_TIMBRE = 74;
+static constexpr uint8_t CC_DATA_ENTRY = 6;
+static constexpr uint8_t CC_RPN_LSB = 100;
+static constexpr uint8_t CC_RPN_MSB = 101;
+static constexpr uint8_t RPN_PITCH_BEND_RANGE = 0;
+static constexpr uint8_t RPN_MPE_CONFIGURATION = 6;
+static constexpr uint8_t RPN_NULL = 127;
+
+static constexpr int BEND_MAX = 8191;
+
+static int absDiff(int a, int b) {
+    return a > b ? a - b : b - a;
+}
+
+MpeOutput::MpeOutput(MidiOutQueue& port) : port(port) {}
+
+void MpeOutput::setEnabled(bool enable) {
+    if (enable == enabled) {
+        return;
+    }
+    if (!enable) {
+        releaseAll();
+    }
+    enabled = enable;
+    sendConfiguration(enabled ? memberCount : 0);
+}
+
+void MpeOutput::setMemberChannels(uint8_t count) {
+    if (count < 1 || count > MPE_MAX_MEMBERS || count == memberCount) {
+        return;
+    }
+    releaseAll();
+    memberCount = count;
+    nextVoice = 0;
+    if (enabled) {
+        sendConfiguration(memberCount);
+    }
+}
+
+/**
+ * @brief MPE Configuration Message (RPN 6) on the master channel, then the
+ * member channels' pitch bend range (RPN 0). Each write ends with the RPN
+ * null, so a later data entry on that channel changes nothing.
+ */
+void MpeOutput::sendConfiguration(uint8_t members) {
+    sendRpn(MPE_MASTER_CHANNEL, RPN_MPE_CONFIGURATION, members);
+    for (uint8_t i = 0; i < members; i++) {
+        sendRpn(MPE_MASTER_CHANNEL + 1 + i, RPN_PITCH_BEND_RANGE, MPE_PITCH_BEND_RANGE);
+    }
+    port.flush();
+}
+
+void MpeOutput::sendRpn(uint8_t channel, uint8_t rpn, uint8_t value) {
+    port.controlChange(channel, CC_RPN_MSB, 0);
+    port.controlChange(channel, CC_RPN_LSB, rpn);
+    port.controlChange(channel, CC_DATA_ENTRY, value);
+    port.controlChange(channel, CC_RPN_MSB, RPN_NULL);
+    port.controlChange(channel, CC_RPN_LSB, RPN_NULL);
+}
+
+/**
+ * @brief Next member channel round-robin: the first free one from the
+ * rotation point, otherwise steal the oldest note.
+ */
+uint8_t MpeOutput::allocate() {
+    for (uint8_t n = 0; n < memberCount; n++) {
+        const uint8_t index = (nextVoice + n) % memberCount;
+        if (!voices[index].active) {
+            nextVoice = (index + 1) % memberCount;
+            return index;
+        }
+    }
+
+    uint8_t oldest = 0;
+    for (uint8_t i = 1; i < memberCount; i++) {
+        if (voices[i].age < voices[oldest].age) {
+            oldest = i;
+        }
+    }
+    port.noteOff(MPE_MASTER_CHANNEL + 1 + oldest, voices[oldest].note, 0);
+    voices[oldest].active = false;
+    activeCount--;
+    nextVoice = (oldest + 1) % memberCount;
+    return oldest;
+}
+
+void MpeOutput::noteOn(uint8_t note, uint8_t velocity) {
+    if (!enabled) {
+        return;
+    }
+    const uint8_t index = allocate();
+    Voice& voice = voices[index];
+    voice.note = note;
+    voice.age = noteCounter++;
+    voice.startMm = currentMm;
+
+    // Expression first, so the note starts with the right bend and timbre
+    sendExpression(index, true);
+    port.noteOn(MPE_MASTER_CHANNEL + 1 + index, note, velocity);
+    voice.active = true;
+    activeCount++;
+}
+
+void MpeOutput::noteOff(uint8_t note, uint8_t velocity) {
+    for (uint8_t i = 0; i < memberCount; i++) {
+        Voice& voice = voices[i];
+        if (voice.active && voice.note == note) {
+            port.noteOff(MPE_MASTER_CHANNEL + 1 + i, note, velocity);
+            voice.active = false;
+            activeCount--;
+            return;
+        }
+    }
+}
+
+void MpeOutput::releaseAll() {
+    for (uint8_t i = 0; i < memberCount; i++) {
+        if (voices[i].active) {
+            port.noteOff(MPE_MASTER_CHANNEL + 1 + i, voices[i].note, 0);
+            voices[i].active = false;
+        }
+    }
+    activeCount = 0;
+}
+
+void MpeOutput::update(uint32_t nowMillis, int mm, uint8_t pressure) {
+    currentMm = mm;
+    currentPressure = pressure > 127 ? 127 : pressure;
+    if (!isUpdateDue(nowMillis)) {
+        return;
+    }
+    lastUpdate = nowMillis;
+
+    for (uint8_t i = 0; i < memberCount; i++) {
+        if (voices[i].active) {
+            sendExpression(i, false);
+        }
+    }
+}
+
+/**
+ * @brief Send the voice's expression values that moved past their
+ * thresholds (all of them when forced).
+ */
+void MpeOutput::sendExpression(uint8_t index, bool force) {
+    Voice& voice = voices[index];
+    const uint8_t channel = MPE_MASTER_CHANNEL + 1 + index;
+
+    const int16_t bend = bendFor(voice);
+    if (force || absDiff(bend, voice.bend) >= MPE_BEND_THRESHOLD) {
+        port.pitchBend(channel, bend);
+        voice.bend = bend;
+    }
+
+    const uint8_t timbre = timbreFor(currentMm);
+    if (force || absDiff(timbre, voice.timbre) >= MPE_VALUE_THRESHOLD) {
+        port.controlChange(channel, CC_TIMBRE, timbre);
+        voice.timbre = timbre;
+    }
+
+    if (force || absDiff(currentPressure, voice.pressure) >= MPE_VALUE_THRESHOLD) {
+        port.channelPressure(channel, currentPressure);
+        voice.pressure = currentPressure;
+    }
+}
+
+int16_t MpeOutput::bendFor(const Voice& voice) const {
+    const float semitones = static_cast<float>(currentMm - voice.startMm) *
+                            (MPE_GESTURE_BEND_SEMITONES / MPE_GESTURE_BEND_MM);
+    int bend = static_cast<int>(semitones * (8192.0f / MPE_PITCH_BEND_RANGE));
+    if (bend > BEND_MAX) bend = BEND_MAX;
+    if (bend < -BEND_MAX - 1) bend = -BEND_MAX - 1;
+    return static_cast<int16_t>(bend);
+}
+
+uint8_t MpeOutput::timbreFor(int mm) {
+    if (mm <= MPE_TIMBRE_MIN_MM) return 0;
+    if (mm >= MPE_TIMBRE_MAX_MM) return 127;
+    return static_cast<uint8_t>((mm - MPE_TIMBRE_MIN_MM) * 127 /
+                                (MPE_TIMBRE_MAX_MM - MPE_TIMBRE_MIN_MM));
+}
@@ -0,0 +1,120 @@
+/**
+ * @file MpeOutput.h
+ * @brief MPE (lower zone) note output with per-note expression
+ *
+ * Channel 1 is the zone's master channel; notes go to member channels
+ * 2..1+memberCount, assigned round-robin (a free channel is preferred, the
+ * oldest note's channel is reused when all are busy). Each note streams
+ * its own expression on its channel:
+ *   - Pitch bend: hand movement over the distance sensor relative to where
+ *     it was when the note started, +/-MPE_GESTURE_BEND_SEMITONES over
+ *     +/-MPE_GESTURE_BEND_MM
+ *   - CC74 (timbre): absolute distance
+ *   - Channel pressure: capacitance of the held step pad
+ * The current expression is sent just before each note-on, as MPE asks.
+ *
+ * Cost and bandwidth are bounded: expression is evaluated at most every
+ * MPE_UPDATE_INTERVAL_MS, and a value is only sent when it moved by more
+ * than its threshold, so a hand held still sends nothing.
+ *
+ * Example:
+ *   MpeOutput mpe(router.getPort(MIDI_PORT_USB));
+ *   mpe.setEnabled(true);          // Sends the MPE configuration message
+ *   mpe.noteOn(60, 100);
+ *   // loop()
+ *   if (mpe.isUpdateDue(millis())) mpe.update(millis(), mm, padPressure);
+ */
+
+#ifndef MPE_OUTPUT_H
+#define MPE_OUTPUT_H
+
+#include <stdint.h>
+#include "MidiOutQueue.h"
+
+constexpr uint8_t MPE_MASTER_CHANNEL = 1;
+constexpr uint8_t MPE_MAX_MEMBERS = 15;
+constexpr uint8_t MPE_DEFAULT_MEMBERS = 4;
+
+// Member channel pitch bend range set by the MPE configuration message
+constexpr uint8_t MPE_PITCH_BEND_RANGE = 48;
+
+// Hand movement that bends a note by MPE_GESTURE_BEND_SEMITONES
+constexpr int MPE_GESTURE_BEND_MM = 100;
+constexpr float MPE_GESTURE_BEND_SEMITONES = 2.0f;
+
+// Distance range mapped onto CC74 0-127
+constexpr int MPE_TIMBRE_MIN_MM = 40;
+constexpr int MPE_TIMBRE_MAX_MM = 400;
+
+// Expression updates per note at most every ... ms
+constexpr uint32_t MPE_UPDATE_INTERVAL_MS = 5;
+
+// Smallest change that is sent (bend in 14-bit units, about 5 cents)
+constexpr int MPE_BEND_THRESHOLD = 8;
+constexpr int MPE_VALUE_THRESHOLD = 2;
+
+class MpeOutput {
+public:
+    explicit MpeOutput(MidiOutQueue& port);
+
+    /**
+     * @brief Switch MPE mode; sends the MPE configuration message (with zero
+     * member channels when disabling, after releasing all notes).
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    // Number of member channels (1-15); re-sends the configuration if enabled
+    void setMemberChannels(uint8_t count);
+    uint8_t getMemberChannels() const { return memberCount; }
+
+    void noteOn(uint8_t note, uint8_t velocity);
+    void noteOff(uint8_t note, uint8_t velocity);
+    void releaseAll();
+
+    // Lets the caller skip reading the sensors when no update would be sent
+    bool isUpdateDue(uint32_t nowMillis) const {
+        return enabled && activeCount > 0 && nowMillis - lastUpdate >= MPE_UPDATE_INTERVAL_MS;
+    }
+
+    /**
+     * @brief Stream expression for the sounding notes. O(member channels).
+     * @param mm Distance sensor reading
+     * @param pressure Pad pressure 0-127
+     */
+    void update(uint32_t nowMillis, int mm, uint8_t pressure);
+
+private:
+    struct Voice {
+        bool active;
+        uint8_t note;
+        uint32_t age;      // Note-on order, for stealing
+        int startMm;       // Distance at note-on (bend reference)
+        int16_t bend;      // Last values sent
+        uint8_t timbre;
+        uint8_t pressure;
+    };
+
+    void sendConfiguration(uint8_t members);
+    void sendRpn(uint8_t channel, uint8_t rpn, uint8_t value);
+    uint8_t allocate();
+    void sendExpression(uint8_t index, bool force);
+    int16_t bendFor(const Voice& voice) const;
+    static uint8_t timbreFor(int mm);
+
+    MidiOutQueue& port;
+    bool enabled = false;
+    uint8_t memberCount = MPE_DEFAULT_MEMBERS;
+    uint8_t nextVoice = 0;
+    uint8_t activeCount = 0;
+    uint32_t noteCounter = 0;
+    uint32_t lastUpdate = 0;
+
+    // Latest sensor values
+    int currentMm = 0;
+    uint8_t currentPressure = 0;
+
+    Voice voices[MPE_MAX_MEMBERS] = {};
+};
+
+#endif // MPE_OUTPUT_H
@@ -0,0 +1,298 @@
+/**
+ * @file PatternDump.cpp
+ * @brief Streaming encoder and decoder for pattern dumps.
+ */
+
+#include "PatternDump.h"
+#include "../storage/Crc32.h"
+#include <string.h>
+
+static const uint8_t DUMP_MAGIC[4] = {'P', '2', 'C', 'V'};
+
+static void putLE32(uint8_t* out, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        out[i] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+static uint32_t getLE32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static uint8_t countBits(uint16_t mask) {
+    uint8_t count = 0;
+    for (; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+// Encoder
+// -----------------------------------------------------------------------------
+
+DumpEncoder::DumpEncoder(Sequencer& sequencer, Quantizer& quantizer)
+    : sequencer(sequencer), quantizer(quantizer) {}
+
+void DumpEncoder::begin(DumpContent content, uint8_t index) {
+    settingsPending = content == DUMP_ALL || content == DUMP_SETTINGS;
+    if (content == DUMP_ALL) {
+        patternsPending = (1u << PATTERN_BANK_SIZE) - 1;
+    } else if (content == DUMP_PATTERN && index < PATTERN_BANK_SIZE) {
+        patternsPending = 1u << index;
+    } else {
+        patternsPending = 0;
+    }
+
+    // Include unsaved edits of the playing pattern
+    if (patternsPending & (1u << sequencer.getCurrentPattern())) {
+        sequencer.storePattern(sequencer.getCurrentPattern());
+    }
+
+    memcpy(scratch, DUMP_MAGIC, sizeof(DUMP_MAGIC));
+    scratch[4] = DUMP_FORMAT_VERSION;
+    scratch[5] = PATTERN_FORMAT_VERSION;
+    scratch[6] = PERSIST_SETTINGS_VERSION;
+    scratch[7] = (settingsPending ? 1 : 0) + countBits(patternsPending);
+
+    state = HEADER;
+    piece = scratch;
+    pieceLength = DUMP_HEADER_SIZE;
+    piecePosition = 0;
+}
+
+size_t DumpEncoder::read(uint8_t* out, size_t capacity) {
+    size_t written = 0;
+    while (written < capacity && state != DONE) {
+        if (piecePosition == pieceLength) {
+            nextPiece();
+            continue;
+        }
+        size_t n = pieceLength - piecePosition;
+        if (n > capacity - written) {
+            n = capacity - written;
+        }
+        const uint8_t* from = piece + piecePosition;
+        if (state == SECTION_HEADER || state == SECTION_DATA) {
+            crc = crc32Update(crc, from, n);
+        }
+        memcpy(out + written, from, n);
+        piecePosition += n;
+        written += n;
+    }
+    // Step past a finished piece so isDone() is set with the last byte
+    if (state != DONE && piecePosition == pieceLength) {
+        nextPiece();
+    }
+    return written;
+}
+
+void DumpEncoder::nextPiece() {
+    switch (state) {
+    case HEADER:
+    case SECTION_CRC:
+        if (!startSection()) {
+            state = DONE;
+            return;
+        }
+        state = SECTION_HEADER;
+        piece = scratch;
+        pieceLength = DUMP_SECTION_HEADER_SIZE;
+        break;
+    case SECTION_HEADER:
+        state = SECTION_DATA;
+        piece = section.bytes;
+        pieceLength = sectionLength;
+        break;
+    case SECTION_DATA:
+        putLE32(scratch, crc ^ CRC32_INIT);
+        state = SECTION_CRC;
+        piece = scratch;
+        pieceLength = DUMP_SECTION_CRC_SIZE;
+        break;
+    case DONE:
+        return;
+    }
+    piecePosition = 0;
+}
+
+/**
+ * @brief Copy the next section and write its header into the scratch bytes.
+ * @return false when no sections are left
+ */
+bool DumpEncoder::startSection() {
+    uint8_t type;
+    uint8_t index = 0;
+    if (settingsPending) {
+        settingsPending = false;
+        captureSettings(sequencer, quantizer, section.settings);
+        type = DUMP_SECTION_SETTINGS;
+        sectionLength = sizeof(PersistedSettings);
+    } else if (patternsPending != 0) {
+        while (!(patternsPending & (1u << index))) {
+            index++;
+        }
+        patternsPending &= ~(1u << index);
+        section.pattern = sequencer.getPatternBank().get(index);
+        type = DUMP_SECTION_PATTERN;
+        sectionLength = sizeof(PackedPattern);
+    } else {
+        return false;
+    }
+
+    scratch[0] = type;
+    scratch[1] = index;
+    scratch[2] = sectionLength & 0xFF;
+    scratch[3] = sectionLength >> 8;
+    crc = CRC32_INIT;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Decoder
+// -----------------------------------------------------------------------------
+
+DumpDecoder::DumpDecoder(Sequencer& sequencer, Quantizer& quantizer)
+    : sequencer(sequencer), quantizer(quantizer) {}
+
+void DumpDecoder::begin() {
+    state = HEADER;
+    error = DUMP_OK;
+    pieceLength = DUMP_HEADER_SIZE;
+    piecePosition = 0;
+    sectionsLeft = 0;
+    sectionsApplied = 0;
+}
+
+DumpError DumpDecoder::write(const uint8_t* data, size_t length) {
+    size_t consumed = 0;
+    while (consumed < length && state != FAILED) {
+        if (state == DONE) {
+            error = DUMP_ERROR_FORMAT; // Trailing bytes
+            state = FAILED;
+            break;
+        }
+
+        size_t n = pieceLength - piecePosition;
+        if (n > length - consumed) {
+            n = length - consumed;
+        }
+        const uint8_t* from = data + consumed;
+        if (state == SECTION_HEADER || state == SECTION_DATA) {
+            crc = crc32Update(crc, from, n);
+        }
+        if (state != SECTION_DATA) {
+            memcpy(scratch + piecePosition, from, n);
+        } else if (!skipping) {
+            memcpy(section.bytes + piecePosition, from, n);
+        }
+        piecePosition += n;
+        consumed += n;
+
+        if (piecePosition == pieceLength) {
+            const DumpError result = finishPiece();
+            if (result != DUMP_OK) {
+                error = result;
+                state = FAILED;
+            }
+        }
+    }
+    return error;
+}
+
+/**
+ * @brief Act on a completed piece and set up the next one.
+ */
+DumpError DumpDecoder::finishPiece() {
+    piecePosition = 0;
+    switch (state) {
+    case HEADER:
+        if (memcmp(scratch, DUMP_MAGIC, sizeof(DUMP_MAGIC)) != 0) {
+            return DUMP_ERROR_FORMAT;
+        }
+        if (scratch[4] != DUMP_FORMAT_VERSION || scratch[5] != PATTERN_FORMAT_VERSION ||
+            scratch[6] != PERSIST_SETTINGS_VERSION) {
+            return DUMP_ERROR_VERSION;
+        }
+        sectionsLeft = scratch[7];
+        break;
+    case SECTION_HEADER:
+        return startSection();
+    case SECTION_DATA:
+        state = SECTION_CRC;
+        pieceLength = DUMP_SECTION_CRC_SIZE;
+        return DUMP_OK;
+    case SECTION_CRC: {
+        if (getLE32(scratch) != (crc ^ CRC32_INIT)) {
+            return DUMP_ERROR_CRC;
+        }
+        if (!skipping) {
+            const DumpError result = applySection();
+            if (result != DUMP_OK) {
+                return result;
+            }
+            sectionsApplied++;
+        }
+        sectionsLeft--;
+        break;
+    }
+    default:
+        return DUMP_OK;
+    }
+
+    if (sectionsLeft == 0) {
+        state = DONE;
+    } else {
+        state = SECTION_HEADER;
+        pieceLength = DUMP_SECTION_HEADER_SIZE;
+        crc = CRC32_INIT;
+    }
+    return DUMP_OK;
+}
+
+/**
+ * @brief Check a section header; known sections must have their exact size.
+ */
+DumpError DumpDecoder::startSection() {
+    sectionType = scratch[0];
+    sectionIndex = scratch[1];
+    sectionLength = scratch[2] | (scratch[3] << 8);
+
+    skipping = false;
+    if (sectionType == DUMP_SECTION_PATTERN) {
+        if (sectionLength != sizeof(PackedPattern) || sectionIndex >= PATTERN_BANK_SIZE) {
+            return DUMP_ERROR_FORMAT;
+        }
+    } else if (sectionType == DUMP_SECTION_SETTINGS) {
+        if (sectionLength != sizeof(PersistedSettings)) {
+            return DUMP_ERROR_FORMAT;
+        }
+    } else {
+        skipping = true;
+    }
+
+    if (sectionLength == 0) {
+        state = SECTION_CRC;
+        pieceLength = DUMP_SECTION_CRC_SIZE;
+    } else {
+        state = SECTION_DATA;
+        pieceLength = sectionLength;
+    }
+    return DUMP_OK;
+}
+
+DumpError DumpDecoder::applySection() {
+    if (sectionType == DUMP_SECTION_PATTERN) {
+        PatternBank& bank = sequencer.getPatternBank();
+        bank.getSlot(sectionIndex) = section.pattern;
+        bank.markDirty(sectionIndex);
+        sequencer.reloadPattern(sectionIndex);
+        return DUMP_OK;
+    }
+    if (!settingsCompatible(section.settings)) {
+        return DUMP_ERROR_VERSION;
+    }
+    applySettings(sequencer, quantizer, section.settings);
+    return DUMP_OK;
+}
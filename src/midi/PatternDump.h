@@ -0,0 +1,162 @@
+/**
+ * @file PatternDump.h
+ * @brief Versioned binary dump of patterns and settings, streamed in pieces
+ *
+ * A dump is a byte stream:
+ *   Header   'P' '2' 'C' 'V' <dump version> <pattern format> <settings version> <sections>
+ *   Section  <type> <index> <length LE16> <data...> <CRC32 LE32>
+ *
+ * Pattern sections carry a PackedPattern (the bank's own format), the
+ * settings section a PersistedSettings block, both little-endian as laid
+ * out in memory. The CRC covers the section header and data. Sections of
+ * unknown type are skipped, so newer dumps can add sections.
+ *
+ * DumpEncoder produces the stream and DumpDecoder consumes it a few bytes
+ * at a time; neither holds more than one section. Each section is copied
+ * when its first byte is produced, so a dump taken while the sequencer
+ * plays is consistent per section. The decoder applies a section only
+ * after its CRC has been checked.
+ *
+ * Example:
+ *   DumpEncoder encoder(sequencer, quantizer);
+ *   encoder.begin(DUMP_ALL, 0);
+ *   while ((n = encoder.read(chunk, sizeof(chunk))) > 0) { ... }
+ */
+
+#ifndef PATTERN_DUMP_H
+#define PATTERN_DUMP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../sequencer/Sequencer.h"
+#include "../storage/Settings.h"
+
+// Bumped whenever the dump framing changes
+constexpr uint8_t DUMP_FORMAT_VERSION = 1;
+
+constexpr uint8_t DUMP_HEADER_SIZE = 8;
+constexpr uint8_t DUMP_SECTION_HEADER_SIZE = 4;
+constexpr uint8_t DUMP_SECTION_CRC_SIZE = 4;
+
+enum DumpSectionType : uint8_t {
+    DUMP_SECTION_SETTINGS = 1,
+    DUMP_SECTION_PATTERN = 2,
+};
+
+// What a dump request asks for
+enum DumpContent : uint8_t {
+    DUMP_ALL = 0,       // Settings and all pattern slots
+    DUMP_PATTERN = 1,   // One pattern slot
+    DUMP_SETTINGS = 2,  // Settings only
+};
+
+enum DumpError : uint8_t {
+    DUMP_OK = 0,
+    DUMP_ERROR_FORMAT,    // Bad magic or section layout
+    DUMP_ERROR_VERSION,   // Written by an incompatible firmware
+    DUMP_ERROR_CRC,       // Section corrupted
+    DUMP_ERROR_CHECKSUM,  // Transport: chunk corrupted
+    DUMP_ERROR_SEQUENCE,  // Transport: chunk out of order
+    DUMP_ERROR_TIMEOUT,   // Transport: peer stopped answering
+    DUMP_ERROR_CANCELLED, // Transport: peer cancelled
+};
+
+/**
+ * @brief Largest section payload (one pattern or the settings block)
+ */
+constexpr size_t DUMP_MAX_SECTION = sizeof(PackedPattern) > sizeof(PersistedSettings)
+                                        ? sizeof(PackedPattern)
+                                        : sizeof(PersistedSettings);
+
+union DumpSectionData {
+    PackedPattern pattern;
+    PersistedSettings settings;
+    uint8_t bytes[DUMP_MAX_SECTION];
+};
+
+class DumpEncoder {
+public:
+    DumpEncoder(Sequencer& sequencer, Quantizer& quantizer);
+
+    /**
+     * @brief Start a new dump
+     * @param content What to dump
+     * @param index Pattern slot for DUMP_PATTERN
+     */
+    void begin(DumpContent content, uint8_t index);
+
+    /**
+     * @brief Produce the next bytes of the dump
+     * @return Bytes written, 0 once the dump is complete
+     */
+    size_t read(uint8_t* out, size_t capacity);
+
+    bool isDone() const { return state == DONE; }
+
+private:
+    enum State : uint8_t { HEADER, SECTION_HEADER, SECTION_DATA, SECTION_CRC, DONE };
+
+    void nextPiece();
+    bool startSection();
+
+    Sequencer& sequencer;
+    Quantizer& quantizer;
+
+    State state = DONE;
+    bool settingsPending = false;
+    uint16_t patternsPending = 0;
+
+    const uint8_t* piece = nullptr; // Bytes being produced
+    uint16_t pieceLength = 0;
+    uint16_t piecePosition = 0;
+    uint8_t scratch[DUMP_HEADER_SIZE];
+    uint16_t sectionLength = 0;
+    uint32_t crc = 0;
+    DumpSectionData section;
+};
+
+class DumpDecoder {
+public:
+    DumpDecoder(Sequencer& sequencer, Quantizer& quantizer);
+
+    // Expect a new dump
+    void begin();
+
+    /**
+     * @brief Consume the next bytes of a dump; complete sections are
+     * applied immediately (patterns into the bank, marked dirty so they get
+     * saved; the playing pattern is reloaded).
+     * @return DUMP_OK, or the error that stopped decoding (sticky until begin())
+     */
+    DumpError write(const uint8_t* data, size_t length);
+
+    // All sections announced in the header have been applied
+    bool isComplete() const { return state == DONE; }
+    uint8_t getSectionsApplied() const { return sectionsApplied; }
+
+private:
+    enum State : uint8_t { HEADER, SECTION_HEADER, SECTION_DATA, SECTION_CRC, DONE, FAILED };
+
+    DumpError finishPiece();
+    DumpError startSection();
+    DumpError applySection();
+
+    Sequencer& sequencer;
+    Quantizer& quantizer;
+
+    State state = HEADER;
+    DumpError error = DUMP_OK;
+    uint16_t pieceLength = 0;
+    uint16_t piecePosition = 0;
+    uint8_t scratch[DUMP_HEADER_SIZE];
+    uint8_t sectionsLeft = 0;
+    uint8_t sectionsApplied = 0;
+    uint8_t sectionType = 0;
+    uint8_t sectionIndex = 0;
+    uint16_t sectionLength = 0;
+    bool skipping = false; // Unknown section: check the CRC, drop the data
+    uint32_t crc = 0;
+    DumpSectionData section;
+};
+
+#endif // PATTERN_DUMP_H
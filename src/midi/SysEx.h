@@ -0,0 +1,115 @@
+/**
+ * @file SysEx.h
+ * @brief MIDI System Exclusive framing shared by all Pico2CV SysEx commands
+ *
+ * Every Pico2CV message has the form:
+ *   F0 7D <command> <payload...> F7
+ * 0x7D is the manufacturer ID reserved for non-commercial use.
+ */
+
+#ifndef SYSEX_H
+#define SYSEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint8_t SYSEX_START = 0xF0;
+constexpr uint8_t SYSEX_END = 0xF7;
+constexpr uint8_t SYSEX_MANUFACTURER_ID = 0x7D;
+
+// Offset of the command byte inside a complete message
+constexpr uint8_t SYSEX_COMMAND_OFFSET = 2;
+// Bytes used by framing: F0, manufacturer, command ... F7
+constexpr uint8_t SYSEX_FRAMING_BYTES = 4;
+
+// Command bytes
+enum SysExCommand : uint8_t {
+    SYSEX_CMD_PROFILE_DUMP_REQUEST = 0x01,
+    SYSEX_CMD_PROFILE_DUMP_REPLY = 0x02,
+    SYSEX_CMD_PROFILE_RESET = 0x03,
+    SYSEX_CMD_DUMP_REQUEST = 0x10,  // <what> <index>
+    SYSEX_CMD_DUMP_DATA = 0x11,     // <seq> <last> <7-bit packed data> <checksum>
+    SYSEX_CMD_DUMP_ACK = 0x12,      // <seq>
+    SYSEX_CMD_DUMP_NAK = 0x13,      // <seq> <error>
+    SYSEX_CMD_DUMP_CANCEL = 0x14,
+};
+
+/**
+ * @brief Check that a message carries the Pico2CV header
+ * @param data Complete message including F0/F7
+ * @param length Message length
+ * @return Command byte, or 0 if the message is not for us
+ */
+inline uint8_t sysExGetCommand(const uint8_t* data, size_t length) {
+    if (length < SYSEX_FRAMING_BYTES || data[0] != SYSEX_START ||
+        data[1] != SYSEX_MANUFACTURER_ID) {
+        return 0;
+    }
+    return data[SYSEX_COMMAND_OFFSET];
+}
+
+/**
+ * @brief Write a 32-bit value as five 7-bit bytes, LSB first
+ * @return Pointer past the written bytes
+ */
+inline uint8_t* sysExPut32(uint8_t* out, uint32_t value) {
+    for (uint8_t i = 0; i < 5; i++) {
+        *out++ = value & 0x7F;
+        value >>= 7;
+    }
+    return out;
+}
+
+/**
+ * @brief Size of n data bytes after 7-bit packing
+ */
+constexpr size_t sysExPackedSize(size_t length) {
+    return length + (length + 6) / 7;
+}
+
+/**
+ * @brief Pack 8-bit data into 7-bit bytes: each group of up to seven bytes
+ * is preceded by one byte holding their top bits (bit 0 = first byte).
+ * @return Number of bytes written (sysExPackedSize(length))
+ */
+inline size_t sysExPack7(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t written = 0;
+    for (size_t group = 0; group < length; group += 7) {
+        uint8_t* msbs = &out[written++];
+        *msbs = 0;
+        for (size_t i = 0; i < 7 && group + i < length; i++) {
+            const uint8_t value = in[group + i];
+            *msbs |= (value >> 7) << i;
+            out[written++] = value & 0x7F;
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief Reverse of sysExPack7
+ * @return Number of data bytes written
+ */
+inline size_t sysExUnpack7(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t written = 0;
+    for (size_t group = 0; group < length; group += 8) {
+        const uint8_t msbs = in[group];
+        for (size_t i = 0; i < 7 && group + 1 + i < length; i++) {
+            out[written++] = in[group + 1 + i] | (((msbs >> i) & 1) << 7);
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief 7-bit checksum: the bytes plus the checksum sum to 0 modulo 128
+ */
+inline uint8_t sysExChecksum(const uint8_t* data, size_t length) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    return (128 - (sum & 0x7F)) & 0x7F;
+}
+
+#endif // SYSEX_H
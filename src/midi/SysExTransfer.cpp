@@ -0,0 +1,193 @@
+/**
+ * @file SysExTransfer.cpp
+ * @brief Chunked, acknowledged pattern dumps over SysEx.
+ */
+
+#include "SysExTransfer.h"
+
+SysExTransfer::SysExTransfer(Sequencer& sequencer, Quantizer& quantizer, SysExSendFunction send)
+    : encoder(sequencer, quantizer), decoder(sequencer, quantizer), send(send) {}
+
+bool SysExTransfer::handleMessage(const uint8_t* data, size_t length, uint32_t nowMillis) {
+    const uint8_t command = sysExGetCommand(data, length);
+    const uint8_t* payload = data + SYSEX_COMMAND_OFFSET + 1;
+    const size_t payloadLength = length - SYSEX_FRAMING_BYTES;
+
+    switch (command) {
+    case SYSEX_CMD_DUMP_REQUEST:
+        if (payloadLength >= 2) {
+            startExport(static_cast<DumpContent>(payload[0]), payload[1], nowMillis);
+        }
+        return true;
+    case SYSEX_CMD_DUMP_DATA:
+        receiveChunk(payload, payloadLength, nowMillis);
+        return true;
+    case SYSEX_CMD_DUMP_ACK:
+        if (exporting && payloadLength >= 1 && payload[0] == txSeq) {
+            if (txLast) {
+                stopExport(DUMP_OK);
+            } else {
+                txSeq = (txSeq + 1) & 0x7F;
+                nextChunk(nowMillis);
+            }
+        }
+        return true;
+    case SYSEX_CMD_DUMP_NAK:
+        if (exporting && payloadLength >= 1 && payload[0] == txSeq) {
+            retryChunk(nowMillis);
+        }
+        return true;
+    case SYSEX_CMD_DUMP_CANCEL:
+        if (exporting) {
+            stopExport(DUMP_ERROR_CANCELLED);
+        }
+        if (importing) {
+            stopImport(DUMP_ERROR_CANCELLED);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+void SysExTransfer::update(uint32_t nowMillis) {
+    if (exporting && nowMillis - txSentAt >= SYSEX_DUMP_ACK_TIMEOUT_MS) {
+        retryChunk(nowMillis);
+    }
+    if (importing && nowMillis - rxReceivedAt >= SYSEX_DUMP_IMPORT_TIMEOUT_MS) {
+        stopImport(DUMP_ERROR_TIMEOUT);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Export
+// -----------------------------------------------------------------------------
+
+void SysExTransfer::startExport(DumpContent content, uint8_t index, uint32_t nowMillis) {
+    encoder.begin(content, index);
+    exporting = true;
+    txSeq = 0;
+    nextChunk(nowMillis);
+}
+
+void SysExTransfer::nextChunk(uint32_t nowMillis) {
+    txLength = encoder.read(txChunk, sizeof(txChunk));
+    txLast = encoder.isDone();
+    txRetries = 0;
+    sendChunk(nowMillis);
+}
+
+void SysExTransfer::sendChunk(uint32_t nowMillis) {
+    uint8_t* p = message;
+    *p++ = SYSEX_START;
+    *p++ = SYSEX_MANUFACTURER_ID;
+    *p++ = SYSEX_CMD_DUMP_DATA;
+    uint8_t* payload = p;
+    *p++ = txSeq;
+    *p++ = txLast ? 1 : 0;
+    p += sysExPack7(txChunk, txLength, p);
+    *p = sysExChecksum(payload, p - payload);
+    p++;
+    *p++ = SYSEX_END;
+    send(message, p - message);
+    txSentAt = nowMillis;
+}
+
+void SysExTransfer::retryChunk(uint32_t nowMillis) {
+    if (txRetries >= SYSEX_DUMP_RETRIES) {
+        sendCancel();
+        stopExport(DUMP_ERROR_TIMEOUT);
+        return;
+    }
+    txRetries++;
+    sendChunk(nowMillis);
+}
+
+void SysExTransfer::stopExport(DumpError error) {
+    exporting = false;
+    lastError = error;
+}
+
+// -----------------------------------------------------------------------------
+// Import
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Check, order and decode one DUMP_DATA payload:
+ * <seq> <last> <packed data...> <checksum>
+ */
+void SysExTransfer::receiveChunk(const uint8_t* payload, size_t length, uint32_t nowMillis) {
+    if (length < 3) {
+        return;
+    }
+    const uint8_t seq = payload[0];
+    const bool last = payload[1] != 0;
+    const size_t packedLength = length - 3;
+
+    if (sysExChecksum(payload, length - 1) != payload[length - 1] ||
+        packedLength > sysExPackedSize(SYSEX_DUMP_CHUNK)) {
+        sendReply(SYSEX_CMD_DUMP_NAK, seq, DUMP_ERROR_CHECKSUM); // Sender resends
+        return;
+    }
+
+    if (importing && seq == ((rxSeq - 1) & 0x7F)) {
+        sendReply(SYSEX_CMD_DUMP_ACK, seq, 0); // Our ACK was lost
+        return;
+    }
+    if (seq == 0) {
+        decoder.begin();
+        importing = true;
+        rxSeq = 0;
+    } else if (!importing || seq != rxSeq) {
+        sendReply(SYSEX_CMD_DUMP_NAK, seq, DUMP_ERROR_SEQUENCE);
+        return;
+    }
+    rxReceivedAt = nowMillis;
+
+    const size_t chunkLength = sysExUnpack7(payload + 2, packedLength, rxChunk);
+    DumpError error = decoder.write(rxChunk, chunkLength);
+    if (error == DUMP_OK && last && !decoder.isComplete()) {
+        error = DUMP_ERROR_FORMAT; // Truncated
+    }
+    if (error != DUMP_OK) {
+        sendReply(SYSEX_CMD_DUMP_NAK, seq, error);
+        stopImport(error);
+        return;
+    }
+
+    sendReply(SYSEX_CMD_DUMP_ACK, seq, 0);
+    rxSeq = (rxSeq + 1) & 0x7F;
+    if (last) {
+        stopImport(DUMP_OK);
+    }
+}
+
+void SysExTransfer::stopImport(DumpError error) {
+    importing = false;
+    lastError = error;
+}
+
+// -----------------------------------------------------------------------------
+// Replies
+// -----------------------------------------------------------------------------
+
+void SysExTransfer::sendReply(uint8_t command, uint8_t seq, uint8_t error) {
+    uint8_t reply[SYSEX_FRAMING_BYTES + 2];
+    uint8_t* p = reply;
+    *p++ = SYSEX_START;
+    *p++ = SYSEX_MANUFACTURER_ID;
+    *p++ = command;
+    *p++ = seq;
+    if (command == SYSEX_CMD_DUMP_NAK) {
+        *p++ = error;
+    }
+    *p++ = SYSEX_END;
+    send(reply, p - reply);
+}
+
+void SysExTransfer::sendCancel() {
+    const uint8_t cancel[SYSEX_FRAMING_BYTES] = {
+        SYSEX_START, SYSEX_MANUFACTURER_ID, SYSEX_CMD_DUMP_CANCEL, SYSEX_END
+    };
+    send(cancel, sizeof(cancel));
+}
@@ -0,0 +1,114 @@
+/**
+ * @file SysExTransfer.h
+ * @brief Pattern dumps over SysEx with chunking, checksums and flow control
+ *
+ * A dump (see PatternDump.h) travels as DUMP_DATA messages carrying up to
+ * SYSEX_DUMP_CHUNK bytes each, 7-bit packed:
+ *   F0 7D 11 <seq> <last> <packed data...> <checksum> F7
+ * seq counts 0-127 and wraps; last is 1 on the final chunk. The receiver
+ * answers every chunk with DUMP_ACK <seq>, or DUMP_NAK <seq> <error>. The
+ * sender keeps one chunk in flight and resends it on NAK or after
+ * SYSEX_DUMP_ACK_TIMEOUT_MS; after SYSEX_DUMP_RETRIES it gives up and
+ * sends DUMP_CANCEL. DUMP_CANCEL from either side stops the transfer.
+ *
+ * Export: the librarian sends DUMP_REQUEST <what> <index> (DumpContent)
+ * and acknowledges the chunks. Import: the librarian sends the chunks of a
+ * dump starting at seq 0. Any seq 0 chunk starts a new import, except a
+ * repeat of the chunk just acknowledged.
+ *
+ * Only one chunk is buffered in each direction, and chunks are produced
+ * and consumed from the main loop, so the sequencer keeps playing.
+ *
+ * Example:
+ *   void sendSysEx(const uint8_t* data, size_t length) {
+ *       usb_midi.sendSysEx(length, data, true);
+ *   }
+ *   SysExTransfer transfer(sequencer, quantizer, sendSysEx);
+ *   // SysEx handler
+ *   transfer.handleMessage(data, length, millis());
+ *   // loop()
+ *   transfer.update(millis());
+ */
+
+#ifndef SYSEX_TRANSFER_H
+#define SYSEX_TRANSFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SysEx.h"
+#include "PatternDump.h"
+
+// Dump bytes per DUMP_DATA message (64 bytes once packed)
+constexpr uint8_t SYSEX_DUMP_CHUNK = 56;
+// Wait this long for an ACK before resending
+constexpr uint32_t SYSEX_DUMP_ACK_TIMEOUT_MS = 250;
+// Resends of one chunk before the export is abandoned
+constexpr uint8_t SYSEX_DUMP_RETRIES = 4;
+// An import with no chunk for this long is abandoned
+constexpr uint32_t SYSEX_DUMP_IMPORT_TIMEOUT_MS = 2000;
+
+// Largest message: framing, seq, last, packed chunk, checksum
+constexpr size_t SYSEX_DUMP_MESSAGE_SIZE = SYSEX_FRAMING_BYTES + 3 + sysExPackedSize(SYSEX_DUMP_CHUNK);
+
+// Sends one complete SysEx message (F0 ... F7 included)
+typedef void (*SysExSendFunction)(const uint8_t* data, size_t length);
+
+class SysExTransfer {
+public:
+    SysExTransfer(Sequencer& sequencer, Quantizer& quantizer, SysExSendFunction send);
+
+    /**
+     * @brief Handle an incoming message
+     * @param data Complete message including F0/F7
+     * @param length Message length
+     * @param nowMillis Current time in milliseconds
+     * @return true if the message was a dump message
+     */
+    bool handleMessage(const uint8_t* data, size_t length, uint32_t nowMillis);
+
+    /**
+     * @brief Resend on timeout and expire stalled imports; call from the main loop
+     */
+    void update(uint32_t nowMillis);
+
+    bool isExporting() const { return exporting; }
+    bool isImporting() const { return importing; }
+
+    // Why the last transfer stopped (DUMP_OK if it completed)
+    DumpError getLastError() const { return lastError; }
+
+private:
+    void startExport(DumpContent content, uint8_t index, uint32_t nowMillis);
+    void nextChunk(uint32_t nowMillis);
+    void sendChunk(uint32_t nowMillis);
+    void retryChunk(uint32_t nowMillis);
+    void receiveChunk(const uint8_t* payload, size_t length, uint32_t nowMillis);
+    void sendReply(uint8_t command, uint8_t seq, uint8_t error);
+    void sendCancel();
+    void stopExport(DumpError error);
+    void stopImport(DumpError error);
+
+    DumpEncoder encoder;
+    DumpDecoder decoder;
+    SysExSendFunction send;
+
+    // Export
+    bool exporting = false;
+    uint8_t txSeq = 0;
+    bool txLast = false;
+    uint8_t txLength = 0;
+    uint8_t txRetries = 0;
+    uint32_t txSentAt = 0;
+    uint8_t txChunk[SYSEX_DUMP_CHUNK];
+
+    // Import
+    bool importing = false;
+    uint8_t rxSeq = 0; // Next expected
+    uint32_t rxReceivedAt = 0;
+    uint8_t rxChunk[SYSEX_DUMP_CHUNK];
+
+    DumpError lastError = DUMP_OK;
+    uint8_t message[SYSEX_DUMP_MESSAGE_SIZE];
+};
+
+#endif // SYSEX_TRANSFER_H
@@ -0,0 +1,109 @@
+/**
+ * @file Profiler.cpp
+ * @brief Implementation of the per-subsystem timing counters.
+ */
+
+#include "Profiler.h"
+#include "../midi/SysEx.h"
+
+ProfileStats Profiler::stats[PROFILE_SECTION_COUNT];
+volatile uint32_t Profiler::deadlineMisses = 0;
+
+static const char* const SECTION_NAMES[PROFILE_SECTION_COUNT] = {
+    "audio",
+    "advanceStep",
+    "matrixScan",
+    "sensorRead",
+    "ledShow",
+    "ledRender",
+};
+
+// Index of the highest set bit, clamped to the histogram size
+static inline uint8_t histogramBucket(uint32_t ticks) {
+    uint8_t bucket = 0;
+    while (ticks > 1 && bucket < PROFILE_HISTOGRAM_BUCKETS - 1) {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint32_t Profiler::record(ProfileSection section, uint32_t startTicks) {
+    uint32_t elapsed = now() - startTicks;
+    ProfileStats& s = stats[section];
+    s.count++;
+    s.totalTicks += elapsed;
+    if (elapsed < s.minTicks) s.minTicks = elapsed;
+    if (elapsed > s.maxTicks) s.maxTicks = elapsed;
+    s.histogram[histogramBucket(elapsed)]++;
+    return elapsed;
+}
+
+const char* Profiler::getSectionName(ProfileSection section) {
+    return (section < PROFILE_SECTION_COUNT) ? SECTION_NAMES[section] : "?";
+}
+
+void Profiler::reset() {
+    for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        stats[i] = ProfileStats();
+    }
+    deadlineMisses = 0;
+}
+
+size_t Profiler::encodeSysEx(uint8_t* buffer, size_t capacity) {
+    // Per section: 4 values + histogram, 5 bytes each
+    const size_t perSection = (4 + PROFILE_HISTOGRAM_BUCKETS) * 5;
+    const size_t needed = SYSEX_FRAMING_BYTES + 5 + 1 + PROFILE_SECTION_COUNT * perSection;
+    if (capacity < needed) return 0;
+
+    const uint32_t tpu = ticksPerMicrosecond();
+    uint8_t* p = buffer;
+    *p++ = SYSEX_START;
+    *p++ = SYSEX_MANUFACTURER_ID;
+    *p++ = SYSEX_CMD_PROFILE_DUMP_REPLY;
+    p = sysExPut32(p, deadlineMisses);
+    *p++ = PROFILE_SECTION_COUNT;
+    for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const ProfileStats& s = stats[i];
+        p = sysExPut32(p, s.count);
+        p = sysExPut32(p, s.count ? s.minTicks / tpu : 0);
+        p = sysExPut32(p, s.maxTicks / tpu);
+        p = sysExPut32(p, s.avgTicks() / tpu);
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            p = sysExPut32(p, s.histogram[b]);
+        }
+    }
+    *p++ = SYSEX_END;
+    return p - buffer;
+}
+
+#ifdef ARDUINO
+void Profiler::dump(Print& out) {
+    const uint32_t tpu = ticksPerMicrosecond();
+    out.println("=== Profile (us) ===");
+    out.print("Audio deadline misses: ");
+    out.println(deadlineMisses);
+    for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+        const ProfileStats& s = stats[i];
+        out.print(SECTION_NAMES[i]);
+        out.print(": n=");
+        out.print(s.count);
+        out.print(" min=");
+        out.print(s.count ? s.minTicks / tpu : 0);
+        out.print(" avg=");
+        out.print(s.avgTicks() / tpu);
+        out.print(" max=");
+        out.println(s.maxTicks / tpu);
+
+        // Histogram buckets in ticks (powers of two), only non-empty ones
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            if (s.histogram[b] == 0) continue;
+            out.print("  >=");
+            out.print(1UL << b);
+            out.print(" cyc: ");
+            out.println(s.histogram[b]);
+        }
+    }
+    out.println("====================");
+}
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file Profiler.h
+ * @brief Lightweight per-subsystem timing counters
+ *
+ * Scoped timers record the duration of named sections into fixed-size
+ * statistics (min/max/avg and a log2 histogram). On target the timebase is
+ * the core cycle counter; on host builds it is std::chrono::steady_clock in
+ * nanoseconds. Statistics can be dumped over Serial or packed into a MIDI
+ * SysEx reply.
+ *
+ * Usage:
+ *   void Sequencer::advanceStep(uint8_t step) {
+ *       PROFILE_SCOPE(PROFILE_ADVANCE_STEP);
+ *       ...
+ *   }
+ *
+ *   // From the main loop, on request:
+ *   Profiler::dump(Serial);
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+// Set to 0 to compile all PROFILE_SCOPE() markers out
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+/**
+ * @brief Named profiling sections
+ *
+ * Each section must only be recorded from one context (core or ISR) so the
+ * counters need no locking.
+ */
+enum ProfileSection : uint8_t {
+    PROFILE_AUDIO_SAMPLE = 0,   // AudioEngine::processSample()
+    PROFILE_ADVANCE_STEP,       // Sequencer::advanceStep()
+    PROFILE_MATRIX_SCAN,        // Matrix_scan()
+    PROFILE_SENSOR_READ,        // Distance sensor read
+    PROFILE_LED_SHOW,           // LEDMatrix::show() when a frame is sent
+    PROFILE_LED_RENDER,         // LedUi::render()
+    PROFILE_SECTION_COUNT
+};
+
+// Number of log2 histogram buckets (bucket n counts durations of 2^n..2^(n+1)-1 ticks)
+constexpr uint8_t PROFILE_HISTOGRAM_BUCKETS = 20;
+
+/**
+ * @brief Accumulated statistics for one section (durations in timer ticks)
+ */
+struct ProfileStats {
+    uint32_t count = 0;
+    uint32_t minTicks = UINT32_MAX;
+    uint32_t maxTicks = 0;
+    uint64_t totalTicks = 0;
+    uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS] = {0};
+
+    uint32_t avgTicks() const { return count ? static_cast<uint32_t>(totalTicks / count) : 0; }
+};
+
+/**
+ * @brief Static profiling registry
+ */
+class Profiler {
+public:
+    /**
+     * @brief Read the free-running timer
+     * @return Current timer value in ticks (cycles on target, ns on host)
+     */
+    static inline uint32_t now() {
+#ifdef ARDUINO
+        return rp2040.getCycleCount();
+#else
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Timer ticks per microsecond
+     */
+    static inline uint32_t ticksPerMicrosecond() {
+#ifdef ARDUINO
+        return rp2040.f_cpu() / 1000000;
+#else
+        return 1000;
+#endif
+    }
+
+    /**
+     * @brief Record one sample for a section
+     * @param section Section to record into
+     * @param startTicks Value of now() taken when the section began
+     * @return Elapsed ticks
+     */
+    static uint32_t record(ProfileSection section, uint32_t startTicks);
+
+    /**
+     * @brief Count one missed audio deadline
+     */
+    static void countDeadlineMiss() { deadlineMisses++; }
+
+    /**
+     * @brief Get the number of missed audio deadlines since the last reset
+     */
+    static uint32_t getDeadlineMisses() { return deadlineMisses; }
+
+    /**
+     * @brief Get statistics for a section
+     */
+    static const ProfileStats& getStats(ProfileSection section) { return stats[section]; }
+
+    /**
+     * @brief Get a printable name for a section
+     */
+    static const char* getSectionName(ProfileSection section);
+
+    /**
+     * @brief Clear all statistics and the deadline-miss counter
+     */
+    static void reset();
+
+    /**
+     * @brief Pack statistics into a SysEx reply (F0 ... F7 included)
+     *
+     * Every 32-bit value is sent as five 7-bit bytes, LSB first.
+     * Layout: header, deadline misses, section count, then per section:
+     * count, min, max, avg (all in microseconds) and the histogram.
+     *
+     * @param buffer Output buffer
+     * @param capacity Size of the output buffer in bytes
+     * @return Number of bytes written, or 0 if the buffer is too small
+     */
+    static size_t encodeSysEx(uint8_t* buffer, size_t capacity);
+
+#ifdef ARDUINO
+    /**
+     * @brief Print a human-readable table of all sections
+     * @param out Destination (e.g. Serial)
+     */
+    static void dump(Print& out);
+#endif
+
+private:
+    static ProfileStats stats[PROFILE_SECTION_COUNT];
+    static volatile uint32_t deadlineMisses;
+};
+
+/**
+ * @brief RAII timer that records its lifetime into a section
+ */
+class ScopedProfile {
+public:
+    explicit ScopedProfile(ProfileSection section) : section(section), start(Profiler::now()) {}
+    ~ScopedProfile() { Profiler::record(section, start); }
+
+private:
+    ProfileSection section;
+    uint32_t start;
+
+    ScopedProfile(const ScopedProfile&) = delete;
+    ScopedProfile& operator=(const ScopedProfile&) = delete;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(section) ScopedProfile PROFILE_CONCAT(profileScope_, __LINE__)(section)
+#else
+#define PROFILE_SCOPE(section) do {} while (0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,122 @@
+/**
+ * @file Quantizer.cpp
+ * @brief Scale definitions and lookup table compilation.
+ */
+
+#include "Quantizer.h"
+
+// Built-in scale masks, indexed by ScaleId (user slots are stored in RAM)
+static const uint16_t BUILTIN_SCALES[SCALE_USER_1] = {
+    scaleMask(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11), // Chromatic
+    scaleMask(0, 2, 4, 5, 7, 9, 11),                 // Ionian
+    scaleMask(0, 2, 3, 5, 7, 9, 10),                 // Dorian
+    scaleMask(0, 1, 3, 5, 7, 8, 10),                 // Phrygian
+    scaleMask(0, 2, 4, 6, 7, 9, 11),                 // Lydian
+    scaleMask(0, 2, 4, 5, 7, 9, 10),                 // Mixolydian
+    scaleMask(0, 2, 3, 5, 7, 8, 10),                 // Aeolian
+    scaleMask(0, 1, 3, 5, 6, 8, 10),                 // Locrian
+    scaleMask(0, 2, 3, 5, 7, 8, 11),                 // Harmonic minor
+    scaleMask(0, 2, 3, 5, 7, 9, 11),                 // Melodic minor
+    scaleMask(0, 2, 4, 7, 9),                        // Major pentatonic
+    scaleMask(0, 3, 5, 7, 10),                       // Minor pentatonic
+    scaleMask(0, 3, 5, 6, 7, 10),                    // Blues
+    scaleMask(0, 2, 4, 6, 8, 10),                    // Whole tone
+};
+
+static const char* const SCALE_NAMES[SCALE_COUNT] = {
+    "Chromatic", "Ionian", "Dorian", "Phrygian", "Lydian", "Mixolydian",
+    "Aeolian", "Locrian", "Harmonic Minor", "Melodic Minor",
+    "Major Pentatonic", "Minor Pentatonic", "Blues", "Whole Tone",
+    "User 1", "User 2", "User 3", "User 4"
+};
+
+static const uint16_t CHROMATIC_MASK = 0x0FFF;
+
+Quantizer::Quantizer() {
+    for (uint8_t i = 0; i < QUANTIZER_USER_SCALES; i++) {
+        userScales[i] = CHROMATIC_MASK;
+    }
+    rebuild();
+}
+
+void Quantizer::setScale(ScaleId scale) {
+    if (scale >= SCALE_COUNT) return;
+    scaleId = scale;
+    rebuild();
+}
+
+void Quantizer::setRoot(uint8_t newRoot) {
+    root = newRoot % 12;
+    rebuild();
+}
+
+void Quantizer::setUserScale(uint8_t slot, uint16_t mask) {
+    if (slot >= QUANTIZER_USER_SCALES) return;
+    userScales[slot] = (mask & CHROMATIC_MASK) | 1u;
+    if (scaleId == SCALE_USER_1 + slot) rebuild();
+}
+
+uint16_t Quantizer::getScaleMask(ScaleId scale) const {
+    if (scale < SCALE_USER_1) return BUILTIN_SCALES[scale];
+    if (scale < SCALE_COUNT) return userScales[scale - SCALE_USER_1];
+    return CHROMATIC_MASK;
+}
+
+const char* Quantizer::getScaleName(ScaleId scale) {
+    return (scale < SCALE_COUNT) ? SCALE_NAMES[scale] : "Unknown";
+}
+
+void Quantizer::rebuild() {
+    const uint16_t mask = getScaleMask(scaleId) | 1u;
+    Tables& t = tables[activeTable.load(std::memory_order_relaxed) ^ 1];
+
+    // Pitch classes in the scale, ascending from the root
+    uint8_t pitchClasses[12];
+    uint8_t count = 0;
+    for (uint8_t pc = 0; pc < 12; pc++) {
+        if (mask & (1u << pc)) pitchClasses[count++] = pc;
+    }
+    t.degreesPerOctave = count;
+
+    // Degree -> semitone offset, transposed by the root. Scales with few
+    // notes per octave run past the table's range; those degrees saturate so
+    // the sequence never decreases.
+    for (uint8_t d = 0; d < QUANTIZER_DEGREES; d++) {
+        const uint16_t note = root + (d / count) * 12 + pitchClasses[d % count];
+        t.degreeToNote[d] = (note < QUANTIZER_NOTE_MAX) ? note : QUANTIZER_NOTE_MAX;
+    }
+
+    // Semitone offset -> nearest degree. Both sequences ascend, so a single
+    // merge pass finds every nearest neighbour; it stops at the first
+    // saturated degree, since later ones are no nearer.
+    uint8_t d = 0;
+    for (uint8_t s = 0; s < QUANTIZER_SEMITONES; s++) {
+        while (d + 1 < QUANTIZER_DEGREES &&
+               (t.degreeToNote[d + 1] - s) < (s - t.degreeToNote[d])) {
+            d++;
+        }
+        t.semitoneToDegree[s] = d;
+    }
+
+    // MIDI note -> nearest in-scale MIDI note (ties round down). Near the
+    // ends of the MIDI range the neighbour on one side may not exist, so the
+    // search goes up to an octave on the other side; the root is always in
+    // the scale, so it finds one.
+    for (uint8_t n = 0; n < QUANTIZER_MIDI_NOTES; n++) {
+        const uint8_t pc = (n + 12 - root) % 12;
+        uint8_t snapped = n;
+        for (uint8_t delta = 0; delta < 12; delta++) {
+            if (n >= delta && (mask & (1u << ((pc + 12 - delta) % 12)))) {
+                snapped = n - delta;
+                break;
+            }
+            if (n + delta < QUANTIZER_MIDI_NOTES && (mask & (1u << ((pc + delta) % 12)))) {
+                snapped = n + delta;
+                break;
+            }
+        }
+        t.snapNote[n] = snapped;
+    }
+
+    activeTable.store(activeTable.load(std::memory_order_relaxed) ^ 1, std::memory_order_release);
+}
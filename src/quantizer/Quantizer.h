@@ -0,0 +1,166 @@
+/**
+ * @file Quantizer.h
+ * @brief Scale quantizer with precomputed lookup tables
+ *
+ * Scales are stored as 12-bit pitch-class masks (bit n = n semitones above
+ * the root). Selecting a scale or root compiles the mask into small uint8_t
+ * tables, so every query at run time is a single array lookup:
+ *   - degree -> semitone offset (step note indices)
+ *   - semitone offset -> nearest degree (continuous input, e.g. the sensor)
+ *   - MIDI note -> nearest in-scale MIDI note
+ *
+ * Tables are double buffered: a rebuild fills the inactive copy and then
+ * publishes it, so readers on the other core never see a half-built scale.
+ *
+ * Example:
+ *   Quantizer q;
+ *   q.setScale(SCALE_MINOR_PENTATONIC);
+ *   q.setRoot(9);                      // A minor pentatonic
+ *   int semis = q.getNote(3);          // 4th degree above the base note
+ *   int degree = q.getNearestDegree(5); // Snap 5 semitones to a degree
+ */
+
+#ifndef QUANTIZER_H
+#define QUANTIZER_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Number of addressable scale degrees (step note indices)
+constexpr uint8_t QUANTIZER_DEGREES = 48;
+
+// Semitone range covered by the continuous-input table
+constexpr uint8_t QUANTIZER_SEMITONES = 96;
+
+// Number of MIDI notes covered by the note-snapping table
+constexpr uint8_t QUANTIZER_MIDI_NOTES = 128;
+
+// Largest semitone offset returned for a degree (higher degrees saturate)
+constexpr uint8_t QUANTIZER_NOTE_MAX = 127;
+
+// Number of RAM user scale slots
+constexpr uint8_t QUANTIZER_USER_SCALES = 4;
+
+/**
+ * @brief Built-in and user scale identifiers
+ */
+enum ScaleId : uint8_t {
+    SCALE_CHROMATIC = 0,
+    SCALE_IONIAN,           // Major
+    SCALE_DORIAN,
+    SCALE_PHRYGIAN,
+    SCALE_LYDIAN,
+    SCALE_MIXOLYDIAN,
+    SCALE_AEOLIAN,          // Natural minor
+    SCALE_LOCRIAN,
+    SCALE_HARMONIC_MINOR,
+    SCALE_MELODIC_MINOR,
+    SCALE_MAJOR_PENTATONIC,
+    SCALE_MINOR_PENTATONIC,
+    SCALE_BLUES,
+    SCALE_WHOLE_TONE,
+    SCALE_USER_1,
+    SCALE_USER_2,
+    SCALE_USER_3,
+    SCALE_USER_4,
+    SCALE_COUNT
+};
+
+/**
+ * @brief Build a pitch-class mask from semitone offsets, e.g. scaleMask(0, 4, 7)
+ */
+template <typename... Semitones>
+constexpr uint16_t scaleMask(Semitones... semitones) {
+    return static_cast<uint16_t>(((1u << semitones) | ...));
+}
+
+class Quantizer {
+public:
+    Quantizer();
+
+    /**
+     * @brief Select the active scale (rebuilds the tables)
+     */
+    void setScale(ScaleId scale);
+    ScaleId getScale() const { return scaleId; }
+
+    /**
+     * @brief Set the root as a pitch class, 0 = C ... 11 = B (rebuilds the tables)
+     */
+    void setRoot(uint8_t root);
+    uint8_t getRoot() const { return root; }
+
+    /**
+     * @brief Define a user scale
+     * @param slot User slot (0 to QUANTIZER_USER_SCALES-1)
+     * @param mask Pitch-class mask; the root (bit 0) is always included
+     */
+    void setUserScale(uint8_t slot, uint16_t mask);
+
+    /**
+     * @brief Semitone offset of a scale degree, root transposition included
+     * @param degree Degree index; out-of-range indices return the root
+     * @return Offset, at most QUANTIZER_NOTE_MAX (reached only by scales
+     *         with one or two notes per octave)
+     */
+    uint8_t getNote(uint8_t degree) const {
+        if (degree >= QUANTIZER_DEGREES) degree = 0;
+        return active().degreeToNote[degree];
+    }
+
+    /**
+     * @brief Degree whose pitch is nearest to a semitone offset (ties round down)
+     * @param semitone Offset above the base note, clamped to the table range
+     */
+    uint8_t getNearestDegree(int semitone) const {
+        if (semitone < 0) semitone = 0;
+        if (semitone >= QUANTIZER_SEMITONES) semitone = QUANTIZER_SEMITONES - 1;
+        return active().semitoneToDegree[semitone];
+    }
+
+    /**
+     * @brief Snap an absolute MIDI note to the nearest in-scale note
+     */
+    uint8_t quantizeNote(uint8_t midiNote) const {
+        if (midiNote >= QUANTIZER_MIDI_NOTES) midiNote = QUANTIZER_MIDI_NOTES - 1;
+        return active().snapNote[midiNote];
+    }
+
+    /**
+     * @brief Number of degrees per octave in the active scale
+     */
+    uint8_t getDegreesPerOctave() const { return active().degreesPerOctave; }
+
+    /**
+     * @brief Pitch-class mask of any scale (relative to the root)
+     */
+    uint16_t getScaleMask(ScaleId scale) const;
+
+    /**
+     * @brief Human-readable scale name
+     */
+    static const char* getScaleName(ScaleId scale);
+
+private:
+    struct Tables {
+        uint8_t degreeToNote[QUANTIZER_DEGREES];
+        uint8_t semitoneToDegree[QUANTIZER_SEMITONES];
+        uint8_t snapNote[QUANTIZER_MIDI_NOTES];
+        uint8_t degreesPerOctave;
+    };
+
+    const Tables& active() const {
+        return tables[activeTable.load(std::memory_order_acquire)];
+    }
+
+    void rebuild();
+
+    Tables tables[2];
+    std::atomic<uint8_t> activeTable{0};
+
+    ScaleId scaleId = SCALE_CHROMATIC;
+    uint8_t root = 0;
+    uint16_t userScales[QUANTIZER_USER_SCALES];
+};
+
+#endif // QUANTIZER_H
@@ -0,0 +1,280 @@
+/**
+ * @file BasicSequencer.h
+ * @brief Sequencer playback path templated on the I/O type
+ *
+ * advanceStep(), tickNoteDuration() and tickMotion() run on every step and
+ * tick and make several I/O calls each (scale lookup, note, velocity,
+ * filter, envelope, MIDI). Through a SequencerIO* every one of them is a
+ * virtual call. The playback path is therefore written once as member
+ * templates over the I/O type:
+ *   - Sequencer instantiates it with SequencerIO, so any implementation
+ *     (e.g. RecordingSequencerIO in host runs) still plugs in at run time.
+ *   - BasicSequencer<IO> instantiates it with a concrete I/O class. If that
+ *     class is final and defines its methods inline (HardwareSequencerIO),
+ *     the calls are direct and inlined into the step code.
+ *
+ * BasicSequencer<IO> is a Sequencer, so modules taking Sequencer& keep
+ * working; only calls made on the BasicSequencer itself take the direct
+ * path.
+ *
+ * Example:
+ *   HardwareSequencerIO sequencerIO;
+ *   BasicSequencer<HardwareSequencerIO> sequencer(&sequencerIO);
+ *   sequencer.advanceStep(step);   // Direct calls into HardwareSequencerIO
+ *   MidiInput midiInput(sequencer, quantizer);   // Used as a Sequencer&
+ */
+
+#ifndef BASIC_SEQUENCER_H
+#define BASIC_SEQUENCER_H
+
+#include <type_traits>
+#include "Sequencer.h"
+#include "../profiler/Profiler.h"
+
+/**
+ * @brief Processes the sequencer logic for the given step provided by uClock.
+ *
+ * Core sequencer step-advance logic:
+ * - Uses the `current_uclock_step` to set the internal playhead.
+ * - Track the last played note.
+ * - Always send noteOff for the last note before sending noteOn for the new note.
+ * - If the new step is ON, send noteOn for the current note, set oscillator frequency, and trigger the envelope.
+ * - If the new step is OFF, send noteOff for the last note (if any) and release the envelope.
+ * - Handle repeated notes by sending noteOff then noteOn, even if the note is the same.
+ * - If the previous step had slide, tie into the new note: noteOn before noteOff,
+ *   no envelope retrigger, and the pitch glides in the audio engine.
+ * - A gated step whose condition or probability roll fails plays as a rest.
+ * - When the playhead wraps and another pattern is due, the prefetched
+ *   pattern starts playing; the editing context does the bank write-back
+ *   (update()), and the next prefetch runs after the step's notes have
+ *   gone out.
+ * - Modular, robust, and well-documented.
+ * @param current_uclock_step The current step number (0-15) provided by uClock.
+ */
+template <typename IO>
+void Sequencer::advanceStepWith(IO* typedIo, uint8_t current_uclock_step) {
+    PROFILE_SCOPE(PROFILE_ADVANCE_STEP);
+
+    // Wrap step index to stepLength; wrapping around starts a new pass
+    const uint8_t nextPlayhead = current_uclock_step % stepLength;
+    const bool wrapped = !firstStep && nextPlayhead <= play->playhead;
+    firstStep = false;
+
+    // A new pass may bring a new pattern; otherwise edits made since the
+    // last step become audible from this step on
+    if (!(wrapped && switchPattern())) {
+        commitEdits();
+    }
+    if (wrapped) {
+        patternCycle++;
+    }
+    play->playhead = nextPlayhead;
+    Step &currentStep = play->steps[play->playhead];
+    const bool gate = stepTriggers(currentStep);
+
+    // A slide on the previous step ties its note into this one (303-style):
+    // no envelope retrigger, and the pitch glides instead of jumping
+    const bool tie = slideActive && gate;
+    slideActive = gate && currentStep.slide;
+
+  // Always send NoteOff for the last note before starting a new one (monophonic)
+    if (!tie) {
+        releaseNotesWith(typedIo);
+    }
+
+    if (gate) {
+        // Note index is a scale degree; the quantizer maps it to semitones
+        int new_midi_note = MIDI_BASE_NOTE + transpose;
+        if (typedIo) {
+            new_midi_note += typedIo->getScaleNote(currentStep.note);
+        }
+        if (new_midi_note < 0) new_midi_note = 0;
+        if (new_midi_note > 127) new_midi_note = 127;
+
+        // Parameter locks take effect with the note
+        applyParamLocks(typedIo, play->playhead);
+
+        // Update the synth engine's target note via I/O interface
+        // (slide flag first, so the audio core never jumps a tied note)
+        if (typedIo) {
+            typedIo->setSlide1(tie);
+            typedIo->setNote1(new_midi_note);
+            typedIo->setVel1(currentStep.velocity);
+            typedIo->setFreq1(currentStep.filter * 1.f); // Map filter 0.0-1.0 to 0-5000 Hz
+        }
+
+        if (tie || slideActive) {
+            // Slide steps hold the gate until the next step cuts or ties it.
+            // A tied note keeps the envelope running; the envelope is
+            // only triggered when the slide starts from silence.
+            NoteOutput<IO> out{typedIo, false, !tie};
+            uint8_t velocity = static_cast<uint8_t>(currentStep.velocity * 127);
+            notes.startLegato(new_midi_note, velocity,
+                              slideActive ? SLIDE_GATE_TICKS : currentStep.gateLength, out);
+        } else {
+            // Start the note with the step's gate length and ratchet count;
+            // the scheduler triggers the envelope on every hit
+            startNoteWith(typedIo, new_midi_note, currentStep.velocity, currentStep.gateLength, currentStep.ratchets);
+        }
+
+        lastNote = new_midi_note; // Update lastNote to the currently playing MIDI note.
+    } else {
+        // Current step's gate is OFF or did not trigger (a rest).
+        releaseNotesWith(typedIo);
+        if (typedIo) {
+            typedIo->releaseEnvelope(); // Sets trigenv1 = false
+        }
+        lastNote = -1;     // No MIDI note is actively sounding from the sequencer.
+    }
+
+    // Motion lanes override the step's values from its first tick on
+    stepTick = 0;
+    processMotionTick(typedIo, 0);
+
+    // Prefetch the next pattern, off the timing-critical path
+    if (play->playhead == stepLength - 1) {
+        prefetchPattern();
+    }
+
+    publishSnapshot();
+}
+
+/**
+ * @brief Advance motion recording/playback by one clock tick.
+ */
+template <typename IO>
+void Sequencer::tickMotionWith(IO* typedIo) {
+    if (!play->running || stepTick + 1 >= MOTION_TICKS_PER_STEP) {
+        return; // Long (swung) steps hold their last value
+    }
+    processMotionTick(typedIo, ++stepTick);
+}
+
+template <typename IO>
+void Sequencer::processMotionTick(IO* typedIo, uint8_t tick) {
+    if (motionLaneCount == 0 || !typedIo) {
+        return;
+    }
+    const uint8_t step = play->playhead;
+    for (uint8_t i = 0; i < motionLaneCount; ++i) {
+        MotionLane& lane = motionLanes[i];
+        if (i == motionRecordLane) {
+            const uint8_t value = sensorToUnit(typedIo->getDistanceMM());
+            lane.record(step, tick, value);
+            applyMotion(typedIo, lane.getDestination(), value);
+        } else if (lane.hasStep(step)) {
+            applyMotion(typedIo, lane.getDestination(), lane.play(step, tick));
+        }
+    }
+}
+
+template <typename IO>
+void Sequencer::applyMotion(IO* typedIo, uint8_t destination, uint8_t value) {
+    switch (destination) {
+    case MOTION_DEST_FILTER:
+        typedIo->setFreq1(unitToFilterHz(value));
+        break;
+    case MOTION_DEST_VELOCITY:
+        typedIo->setVel1(unitToVelocity(value));
+        break;
+    default: {
+        // Widen 8-bit motion to the 16-bit raw parameter range
+        const uint8_t param = destination - MOTION_DEST_SYNTH_PARAM;
+        typedIo->setSynthParam(param, synthParamFromRaw(param, static_cast<uint16_t>(value) * 257));
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Send the locks of a step to the synth; parameters locked on the
+ * previous step but not on this one return to their base value.
+ * Cost is O(locks on the step).
+ */
+template <typename IO>
+void Sequencer::applyParamLocks(IO* typedIo, uint8_t stepIdx) {
+    if (!typedIo) {
+        return;
+    }
+    const ParamLockTrack<SEQUENCER_NUM_STEPS>& locks = play->paramLocks;
+    uint16_t lockedMask = 0;
+    for (const ParamLock* lock = locks.begin(stepIdx); lock != locks.end(stepIdx); ++lock) {
+        typedIo->setSynthParam(lock->param, synthParamFromRaw(lock->param, lock->value));
+        lockedMask |= 1u << lock->param;
+    }
+
+    uint16_t restoreMask = activeLockMask & ~lockedMask;
+    for (uint8_t param = 0; restoreMask != 0; ++param, restoreMask >>= 1) {
+        if (restoreMask & 1u) {
+            typedIo->setSynthParam(param, synthParamFromRaw(param, locks.getBase(param)));
+        }
+    }
+    activeLockMask = lockedMask;
+}
+
+/**
+ * @brief Start a monophonic note with a specified duration (in ticks).
+ * With ratchets > 1 the step is split into equal sub-steps and every hit
+ * gets the gate length scaled down to its sub-step.
+ * @param note MIDI note number to play.
+ * @param duration Number of ticks the note should last.
+ * @param ratchets Number of hits within one step (1-MAX_RATCHETS).
+ */
+template <typename IO>
+void Sequencer::startNoteWith(IO* typedIo, uint8_t note, float velocity, uint8_t duration, uint8_t ratchets) {
+    if (ratchets < 1) ratchets = 1;
+    if (ratchets > MAX_RATCHETS) ratchets = MAX_RATCHETS;
+
+    uint8_t interval = SEQUENCER_TICKS_PER_STEP / ratchets;
+    uint8_t gate = duration;
+    if (ratchets > 1) {
+        gate = duration / ratchets;
+        if (gate >= interval) gate = interval - 1; // Leave a gap between hits
+        if (gate < 1) gate = 1;
+    }
+
+    NoteOutput<IO> out{typedIo, true};
+    notes.start(note, static_cast<uint8_t>(velocity * 127), gate, interval, ratchets, out);
+}
+
+/**
+ * @brief Advance the note scheduler by one tick (sends due NoteOff/NoteOn).
+ */
+template <typename IO>
+void Sequencer::tickNoteDurationWith(IO* typedIo) {
+    NoteOutput<IO> out{typedIo, true};
+    notes.tick(out);
+}
+
+/**
+ * @brief Sends NoteOff for all scheduled notes and clears them.
+ * The envelope is left alone; the caller decides whether to retrigger it.
+ */
+template <typename IO>
+void Sequencer::releaseNotesWith(IO* typedIo) {
+    NoteOutput<IO> out{typedIo, false};
+    notes.releaseAll(out);
+}
+
+template <typename IO>
+class BasicSequencer : public Sequencer {
+  static_assert(std::is_base_of<SequencerIO, IO>::value, "IO must implement SequencerIO");
+
+public:
+  explicit BasicSequencer(IO* io) : Sequencer(io), typedIo(io) {}
+
+  void setIO(IO* io) {
+    Sequencer::setIO(io);
+    typedIo = io;
+  }
+
+  // Same as the Sequencer entry points, with direct calls into IO
+  void advanceStep(uint8_t current_uclock_step) { advanceStepWith(typedIo, current_uclock_step); }
+  void tickNoteDuration() { tickNoteDurationWith(typedIo); }
+  void tickMotion() { tickMotionWith(typedIo); }
+
+private:
+  IO* typedIo;
+};
+
+#endif // BASIC_SEQUENCER_H
@@ -0,0 +1,165 @@
+/**
+ * @file EditJournal.h
+ * @brief Bounded undo/redo journal of per-field pattern edits.
+ *
+ * Every edit is stored as a 12-byte delta (step, field, old value, new
+ * value) in a fixed ring, so memory is bounded and recording never
+ * allocates, which makes it safe to call from the clock callback.
+ *
+ * Deltas carry a group id. Undo and redo always move a whole group, so a
+ * multi-field edit (setStep) or a complete live-recording pass is undone in
+ * one go. Inside a group, a write to a (step, field) the group already
+ * holds coalesces into that delta, so a record pass that sweeps the steps
+ * many times uses one entry per field; the search only covers the open
+ * group. When the ring is full the oldest whole group is dropped. A group
+ * that would not fit even on its own is dropped as a whole and the rest of
+ * it is not journaled, so undo never restores part of a group.
+ *
+ * Example:
+ *   EditJournal journal;
+ *   journal.record(3, STEP_FIELD_NOTE, 0, 7);
+ *   journal.beginGroup();           // Record pass
+ *   journal.record(4, STEP_FIELD_NOTE, 2, 5);
+ *   journal.record(5, STEP_FIELD_NOTE, 1, 9);
+ *   journal.endGroup();
+ *   journal.undo(apply);            // apply(step, field, value) restores 4 and 5
+ */
+
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <stdint.h>
+
+// Number of deltas kept (power of two)
+constexpr uint16_t EDIT_JOURNAL_CAPACITY = 256;
+
+struct EditDelta {
+  uint32_t oldValue;
+  uint32_t newValue;
+  uint16_t group;
+  uint8_t step;
+  uint8_t field;
+};
+
+class EditJournal {
+public:
+  /**
+   * @brief Forget all history (e.g. after loading a new pattern).
+   */
+  void clear() {
+    tail = head = redoEnd = 0;
+    groupDepth = 0;
+    groupDropped = false;
+  }
+
+  /**
+   * @brief Record one field edit; clears the redo history.
+   * No-op edits (old == new) are not stored.
+   */
+  void record(uint8_t step, uint8_t field, uint32_t oldValue, uint32_t newValue) {
+    if (oldValue == newValue) return;
+
+    if (groupDropped) return;
+
+    if (groupDepth > 0 && head == redoEnd) {
+      for (uint32_t i = head; i != tail; i--) {
+        EditDelta &e = entries[(i - 1) & INDEX_MASK];
+        if (e.group != currentGroup) break;
+        if (e.step == step && e.field == field) {
+          e.newValue = newValue; // Coalesce repeated writes within a group
+          return;
+        }
+      }
+    }
+
+    if (head - tail == EDIT_JOURNAL_CAPACITY) {
+      const uint16_t oldest = entries[tail & INDEX_MASK].group;
+      if (groupDepth > 0 && oldest == currentGroup) {
+        // The open group fills the ring on its own
+        tail = head = redoEnd = 0;
+        groupDropped = true;
+        return;
+      }
+      while (head != tail && entries[tail & INDEX_MASK].group == oldest) {
+        tail++; // Drop the oldest group
+      }
+    }
+    EditDelta &e = entries[head & INDEX_MASK];
+    e.oldValue = oldValue;
+    e.newValue = newValue;
+    e.group = (groupDepth > 0) ? currentGroup : nextGroup++;
+    e.step = step;
+    e.field = field;
+    head++;
+    redoEnd = head;
+  }
+
+  /**
+   * @brief Start a group; edits until the matching endGroup() undo together.
+   * Groups nest; only the outermost one counts.
+   */
+  void beginGroup() {
+    if (groupDepth++ == 0) currentGroup = nextGroup++;
+  }
+
+  void endGroup() {
+    if (groupDepth > 0 && --groupDepth == 0) groupDropped = false;
+  }
+
+  bool inGroup() const { return groupDepth > 0; }
+
+  /**
+   * @brief Undo the most recent group.
+   * @param apply Called as apply(step, field, oldValue), newest delta first.
+   * @return false if there is nothing to undo.
+   */
+  template <typename Apply>
+  bool undo(Apply &apply) {
+    if (head == tail) return false;
+    const uint16_t group = entries[(head - 1) & INDEX_MASK].group;
+    while (head != tail && entries[(head - 1) & INDEX_MASK].group == group) {
+      head--;
+      const EditDelta &e = entries[head & INDEX_MASK];
+      apply(e.step, e.field, e.oldValue);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Redo the most recently undone group.
+   * @param apply Called as apply(step, field, newValue), oldest delta first.
+   * @return false if there is nothing to redo.
+   */
+  template <typename Apply>
+  bool redo(Apply &apply) {
+    if (head == redoEnd) return false;
+    const uint16_t group = entries[head & INDEX_MASK].group;
+    while (head != redoEnd && entries[head & INDEX_MASK].group == group) {
+      const EditDelta &e = entries[head & INDEX_MASK];
+      apply(e.step, e.field, e.newValue);
+      head++;
+    }
+    return true;
+  }
+
+  bool canUndo() const { return head != tail; }
+  bool canRedo() const { return head != redoEnd; }
+
+  // Deltas available to undo
+  uint16_t getUndoCount() const { return static_cast<uint16_t>(head - tail); }
+
+private:
+  static const uint32_t INDEX_MASK = EDIT_JOURNAL_CAPACITY - 1;
+
+  EditDelta entries[EDIT_JOURNAL_CAPACITY];
+  // Free-running counters; [tail, head) can be undone, [head, redoEnd) redone
+  uint32_t tail = 0;
+  uint32_t head = 0;
+  uint32_t redoEnd = 0;
+  uint16_t nextGroup = 1;
+  uint16_t currentGroup = 0;
+  uint8_t groupDepth = 0;
+  bool groupDropped = false; // Open group overflowed; ignore it until it ends
+};
+
+#endif // EDIT_JOURNAL_H
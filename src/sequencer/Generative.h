@@ -0,0 +1,114 @@
+/**
+ * @file Generative.h
+ * @brief Building blocks for generative patterns: a seedable PRNG, A:B cycle
+ * conditions and a Euclidean rhythm generator.
+ *
+ * Everything here is constant time and allocation free, so it can run in
+ * the clock's step callback. The PRNG is a 32-bit xorshift: three shifts and
+ * three XORs per number, no multiply (the RP2040's Cortex-M0+ has no 64-bit
+ * multiplier), and the same seed always gives the same sequence.
+ *
+ * Example:
+ *   Xorshift32 rng(1234);
+ *   if (rng.chance(75)) { ... }                        // 75% of the time
+ *   uint8_t cond = stepCondition(2, 4);                // 2nd of every 4 passes
+ *   bool on = conditionMet(cond, cycle);
+ *   uint16_t gates = euclideanMask(5, 16, 0);          // 5 hits over 16 steps
+ */
+
+#ifndef GENERATIVE_H
+#define GENERATIVE_H
+
+#include <stdint.h>
+
+// Seed used when none is given (any non-zero value works)
+constexpr uint32_t XORSHIFT_DEFAULT_SEED = 0x2545F491UL;
+
+/**
+ * @brief Marsaglia xorshift32 generator (period 2^32 - 1)
+ */
+class Xorshift32 {
+public:
+  explicit Xorshift32(uint32_t seed = XORSHIFT_DEFAULT_SEED) { setSeed(seed); }
+
+  // Zero is the generator's fixed point, so it is replaced by the default
+  void setSeed(uint32_t seed) { state = seed ? seed : XORSHIFT_DEFAULT_SEED; }
+
+  uint32_t next() {
+    uint32_t x = state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+  }
+
+  /**
+   * @brief Uniform value in [0, bound) for bound <= 65536, without division.
+   */
+  uint32_t below(uint32_t bound) { return ((next() >> 16) * bound) >> 16; }
+
+  // Uniform value in [minValue, maxValue)
+  int32_t range(int32_t minValue, int32_t maxValue) {
+    return minValue + static_cast<int32_t>(below(static_cast<uint32_t>(maxValue - minValue)));
+  }
+
+  // True with the given probability in percent (0-100)
+  bool chance(uint8_t percent) { return below(100) < percent; }
+
+private:
+  uint32_t state;
+};
+
+// Step condition meaning "every pass"
+constexpr uint8_t STEP_CONDITION_ALWAYS = 0;
+
+// Longest condition cycle (A:B with B up to 8, like Elektron trig conditions)
+constexpr uint8_t STEP_CONDITION_MAX_CYCLE = 8;
+
+/**
+ * @brief Encode an A:B condition: play on pass A of every B passes.
+ * @param a Pass within the cycle, 1..b
+ * @param b Cycle length, 2..STEP_CONDITION_MAX_CYCLE (1 means always)
+ */
+constexpr uint8_t stepCondition(uint8_t a, uint8_t b) {
+  return (b < 2 || b > STEP_CONDITION_MAX_CYCLE || a < 1 || a > b)
+             ? STEP_CONDITION_ALWAYS
+             : static_cast<uint8_t>((a << 4) | b);
+}
+
+constexpr uint8_t conditionPass(uint8_t condition) { return condition >> 4; }
+constexpr uint8_t conditionCycle(uint8_t condition) { return condition & 0x0F; }
+
+/**
+ * @brief Whether a step with this condition plays on the given pattern pass.
+ * @param cycle Number of completed pattern passes since start
+ */
+inline bool conditionMet(uint8_t condition, uint32_t cycle) {
+  if (condition == STEP_CONDITION_ALWAYS) return true;
+  return (cycle % conditionCycle(condition)) + 1 == conditionPass(condition);
+}
+
+/**
+ * @brief Euclidean rhythm: spread pulses as evenly as possible over steps.
+ *
+ * Uses the Bresenham form, which yields the same necklaces as Bjorklund's
+ * algorithm up to rotation; the first pulse is placed on step 0 before
+ * rotation is applied.
+ * @param pulses Number of hits (clamped to steps)
+ * @param steps Pattern length, 1..16
+ * @param rotation Steps to rotate the pattern to the right
+ * @return Bit i set if step i is a hit
+ */
+inline uint16_t euclideanMask(uint8_t pulses, uint8_t steps, uint8_t rotation) {
+  if (steps == 0 || steps > 16) return 0;
+  if (pulses > steps) pulses = steps;
+  uint16_t mask = 0;
+  for (uint8_t i = 0; i < steps; ++i) {
+    const uint8_t step = static_cast<uint8_t>((i + rotation) % steps);
+    if ((i * pulses) % steps < pulses) mask |= 1u << step;
+  }
+  return mask;
+}
+
+#endif // GENERATIVE_H
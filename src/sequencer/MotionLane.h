@@ -0,0 +1,138 @@
+/**
+ * @file MotionLane.h
+ * @brief Tick-resolution automation lanes with 4-bit delta compression.
+ *
+ * A lane stores one 8-bit value per 96 PPQN tick. Each step is encoded as
+ * an 8-bit keyframe (tick 0) followed by 23 signed 4-bit deltas, 13 bytes
+ * per step instead of 24. The encoder tracks the reconstructed value, so
+ * clamped deltas never accumulate error and every keyframe resyncs
+ * exactly. Recording and playback are O(1) per tick.
+ *
+ * Lane memory comes from a MotionArena, a fixed pool carved up by pattern
+ * length; nothing is allocated on the heap.
+ *
+ * Example:
+ *   MotionArena arena;
+ *   MotionLane lane;
+ *   lane.attach(arena, 16);          // 16 steps * 13 bytes
+ *   lane.record(step, tick, value);  // tick 0..23, value 0..255
+ *   uint8_t v = lane.play(step, tick);
+ */
+
+#ifndef MOTION_LANE_H
+#define MOTION_LANE_H
+
+#include <stdint.h>
+
+// Ticks per step stored in a lane (16th notes at 96 PPQN)
+constexpr uint8_t MOTION_TICKS_PER_STEP = 24;
+
+// Encoded size of one step: keyframe + 23 packed nibbles
+constexpr uint8_t MOTION_BYTES_PER_STEP = 1 + (MOTION_TICKS_PER_STEP - 1 + 1) / 2;
+
+// Shared pool for all lanes
+constexpr uint16_t MOTION_ARENA_BYTES = 1024;
+
+/**
+ * @brief Bump allocator over a static pool
+ */
+class MotionArena {
+public:
+  uint8_t *allocate(uint16_t bytes) {
+    if (bytes > MOTION_ARENA_BYTES - used) return nullptr;
+    uint8_t *block = &pool[used];
+    used += bytes;
+    return block;
+  }
+
+  void reset() { used = 0; }
+  uint16_t getUsed() const { return used; }
+
+private:
+  uint8_t pool[MOTION_ARENA_BYTES];
+  uint16_t used = 0;
+};
+
+class MotionLane {
+public:
+  /**
+   * @brief Take storage for a pattern of the given length from the arena.
+   * @return false if the arena is exhausted (the lane stays detached).
+   */
+  bool attach(MotionArena &arena, uint8_t steps) {
+    data = arena.allocate(static_cast<uint16_t>(steps) * MOTION_BYTES_PER_STEP);
+    stepCount = data ? steps : 0;
+    recordedMask = 0;
+    return data != nullptr;
+  }
+
+  void detach() {
+    data = nullptr;
+    stepCount = 0;
+    recordedMask = 0;
+  }
+
+  bool isAttached() const { return data != nullptr; }
+
+  // Forget recorded motion (storage is kept)
+  void clear() { recordedMask = 0; }
+
+  bool hasStep(uint8_t step) const {
+    return step < stepCount && step < 32 && (recordedMask & (1UL << step));
+  }
+
+  /**
+   * @brief Record the value of one tick. Ticks of a step must arrive in order
+   * starting at tick 0 (the keyframe).
+   */
+  void record(uint8_t step, uint8_t tick, uint8_t value) {
+    if (step >= stepCount || step >= 32 || tick >= MOTION_TICKS_PER_STEP) return;
+    uint8_t *block = &data[static_cast<uint16_t>(step) * MOTION_BYTES_PER_STEP];
+    if (tick == 0) {
+      block[0] = value;
+      recordValue = value;
+      recordedMask |= 1UL << step;
+      return;
+    }
+    int16_t delta = static_cast<int16_t>(value) - recordValue;
+    if (delta > 7) delta = 7;
+    if (delta < -8) delta = -8;
+    recordValue = static_cast<uint8_t>(recordValue + delta);
+
+    uint8_t &packed = block[1 + (tick - 1) / 2];
+    const uint8_t nibble = static_cast<uint8_t>(delta) & 0x0F;
+    packed = ((tick - 1) & 1) ? ((packed & 0x0F) | (nibble << 4))
+                              : ((packed & 0xF0) | nibble);
+  }
+
+  /**
+   * @brief Decode the value of one tick. Ticks of a step must be requested
+   * in order starting at tick 0; returns the last value for later ticks.
+   */
+  uint8_t play(uint8_t step, uint8_t tick) {
+    if (!hasStep(step)) return playValue;
+    const uint8_t *block = &data[static_cast<uint16_t>(step) * MOTION_BYTES_PER_STEP];
+    if (tick == 0) {
+      playValue = block[0];
+    } else if (tick < MOTION_TICKS_PER_STEP) {
+      const uint8_t packed = block[1 + (tick - 1) / 2];
+      uint8_t nibble = ((tick - 1) & 1) ? (packed >> 4) : (packed & 0x0F);
+      const int8_t delta = (nibble & 0x08) ? static_cast<int8_t>(nibble | 0xF0) : static_cast<int8_t>(nibble);
+      playValue = static_cast<uint8_t>(playValue + delta);
+    }
+    return playValue;
+  }
+
+  uint8_t getDestination() const { return destination; }
+  void setDestination(uint8_t dest) { destination = dest; }
+
+private:
+  uint8_t *data = nullptr;
+  uint8_t stepCount = 0;
+  uint32_t recordedMask = 0;  // Steps that hold recorded motion
+  uint8_t recordValue = 0;    // Encoder's reconstructed value
+  uint8_t playValue = 0;      // Decoder state
+  uint8_t destination = 0;
+};
+
+#endif // MOTION_LANE_H
@@ -0,0 +1,138 @@
+/**
+ * @file NoteScheduler.h
+ * @brief Per-voice countdown scheduler for note gates and ratchets.
+ *
+ * Each sounding note owns a voice slot with countdowns for its note-off and,
+ * for ratchets, its next retrigger. Active voices are kept packed at the
+ * front of the array, so tick() costs O(active notes) regardless of the
+ * pattern length.
+ *
+ * Example:
+ *   NoteScheduler notes;
+ *   notes.start(60, 100, 12, 24, 1, out); // one 12-tick note
+ *   notes.start(62, 100, 4, 8, 3, out);   // three 4-tick hits, 8 ticks apart
+ *   // On every 96 PPQN tick:
+ *   notes.tick(out); // out.onNoteOn(note, vel) / out.onNoteOff(note)
+ */
+
+#ifndef NOTE_SCHEDULER_H
+#define NOTE_SCHEDULER_H
+
+#include <stdint.h>
+
+// Maximum number of simultaneously scheduled notes
+constexpr uint8_t NOTE_SCHEDULER_VOICES = 4;
+
+class NoteScheduler {
+public:
+  /**
+   * @brief Start a note (first hit sounds immediately).
+   * @param note MIDI note number.
+   * @param velocity MIDI velocity (0-127).
+   * @param gateTicks Ticks each hit stays on (>= 1).
+   * @param intervalTicks Ticks between hits (ignored for a single hit).
+   * @param hits Number of hits, 1 for a plain note, up to 8 for ratchets.
+   * @param out Receives onNoteOn()/onNoteOff().
+   */
+  template <typename Output>
+  void start(uint8_t note, uint8_t velocity, uint8_t gateTicks,
+             uint8_t intervalTicks, uint8_t hits, Output &out) {
+    if (activeCount >= NOTE_SCHEDULER_VOICES) {
+      // Steal the oldest voice
+      if (voices[0].ticksToOff > 0) out.onNoteOff(voices[0].note);
+      remove(0);
+    }
+    Voice &v = voices[activeCount++];
+    v.note = note;
+    v.velocity = velocity;
+    v.gateTicks = gateTicks ? gateTicks : 1;
+    v.intervalTicks = intervalTicks ? intervalTicks : 1;
+    v.hitsLeft = hits ? hits - 1 : 0;
+    v.ticksToOff = v.gateTicks;
+    v.ticksToNextHit = v.intervalTicks;
+    out.onNoteOn(note, velocity);
+  }
+
+  /**
+   * @brief Start a tied note: the new note sounds before the old ones stop.
+   * Gives legato (overlapping) MIDI for slides; old voices are cut at once.
+   * Sliding into the note that is already sounding just extends it, with no
+   * second note-on.
+   */
+  template <typename Output>
+  void startLegato(uint8_t note, uint8_t velocity, uint8_t gateTicks, Output &out) {
+    bool held = false;
+    for (uint8_t i = 0; i < activeCount; ++i) {
+      if (voices[i].ticksToOff > 0 && voices[i].note == note) held = true;
+    }
+    if (!held) out.onNoteOn(note, velocity);
+    for (uint8_t i = 0; i < activeCount; ++i) {
+      if (voices[i].ticksToOff > 0 && voices[i].note != note) out.onNoteOff(voices[i].note);
+    }
+    Voice &v = voices[0];
+    v.note = note;
+    v.velocity = velocity;
+    v.gateTicks = gateTicks ? gateTicks : 1;
+    v.intervalTicks = 1;
+    v.hitsLeft = 0;
+    v.ticksToOff = v.gateTicks;
+    v.ticksToNextHit = 1;
+    activeCount = 1;
+  }
+
+  /**
+   * @brief Advance all active voices by one tick.
+   */
+  template <typename Output>
+  void tick(Output &out) {
+    uint8_t i = 0;
+    while (i < activeCount) {
+      Voice &v = voices[i];
+      if (v.ticksToOff > 0 && --v.ticksToOff == 0) {
+        out.onNoteOff(v.note);
+      }
+      if (v.hitsLeft > 0 && --v.ticksToNextHit == 0) {
+        v.hitsLeft--;
+        v.ticksToNextHit = v.intervalTicks;
+        v.ticksToOff = v.gateTicks;
+        out.onNoteOn(v.note, v.velocity);
+      }
+      if (v.ticksToOff == 0 && v.hitsLeft == 0) {
+        remove(i); // Last voice moves into slot i
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  /**
+   * @brief Stop all voices, sending note-off for any that are sounding.
+   */
+  template <typename Output>
+  void releaseAll(Output &out) {
+    for (uint8_t i = 0; i < activeCount; ++i) {
+      if (voices[i].ticksToOff > 0) out.onNoteOff(voices[i].note);
+    }
+    activeCount = 0;
+  }
+
+  uint8_t getActiveCount() const { return activeCount; }
+
+private:
+  struct Voice {
+    uint8_t note;
+    uint8_t velocity;
+    uint8_t gateTicks;      // On-time of each hit
+    uint8_t intervalTicks;  // Ticks between hits
+    uint8_t hitsLeft;       // Retriggers still to play
+    uint8_t ticksToOff;     // 0 = silent (between hits)
+    uint8_t ticksToNextHit;
+  };
+
+  void remove(uint8_t idx) { voices[idx] = voices[--activeCount]; }
+
+  Voice voices[NOTE_SCHEDULER_VOICES];
+  uint8_t activeCount = 0;
+};
+
+#endif // NOTE_SCHEDULER_H
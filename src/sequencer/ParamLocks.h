@@ -0,0 +1,146 @@
+/**
+ * @file ParamLocks.h
+ * @brief Sparse per-step parameter locks for one track.
+ *
+ * Locks are kept in one array sorted by step, plus an offset table with the
+ * first lock of every step, so the locks of a step are a contiguous range
+ * found in O(1). Editing (insert/remove) shifts at most the array, which is
+ * fine on the UI side; playback only ever reads ranges.
+ *
+ * Each lock is 4 bytes (step, parameter, 16-bit raw value). Steps without a
+ * lock for a parameter use the track's base value.
+ *
+ * Example:
+ *   ParamLockTrack<16> locks;
+ *   locks.set(4, SYNTH_PARAM_DECAY, synthParamToRaw(SYNTH_PARAM_DECAY, 0.5f));
+ *   for (const ParamLock* l = locks.begin(4); l != locks.end(4); ++l) {
+ *     apply(l->param, synthParamFromRaw(l->param, l->value));
+ *   }
+ */
+
+#ifndef PARAM_LOCKS_H
+#define PARAM_LOCKS_H
+
+#include <stdint.h>
+#include "../audio/SynthParams.h"
+
+// Maximum number of locks per track
+constexpr uint8_t PARAM_LOCK_CAPACITY = 64;
+
+// Journal/query value meaning "no lock"
+constexpr uint32_t PARAM_LOCK_NONE = 0xFFFFFFFFUL;
+
+struct ParamLock {
+  uint8_t step;
+  uint8_t param;
+  uint16_t value; // Raw value, see synthParamFromRaw()
+};
+
+template <uint8_t Steps>
+class ParamLockTrack {
+public:
+  ParamLockTrack() {
+    for (uint8_t s = 0; s <= Steps; ++s) stepStart[s] = 0;
+    for (uint8_t p = 0; p < SYNTH_PARAM_COUNT; ++p) {
+      base[p] = synthParamToRaw(p, SYNTH_PARAM_RANGES[p].defaultValue);
+    }
+  }
+
+  /**
+   * @brief Set or replace a lock.
+   * @return false if the step/parameter is invalid or the track is full.
+   */
+  bool set(uint8_t step, uint8_t param, uint16_t value) {
+    if (step >= Steps || param >= SYNTH_PARAM_COUNT) return false;
+    uint8_t i = stepStart[step];
+    const uint8_t stop = stepStart[step + 1];
+    while (i < stop && locks[i].param < param) ++i;
+    if (i < stop && locks[i].param == param) {
+      locks[i].value = value;
+      return true;
+    }
+    if (count >= PARAM_LOCK_CAPACITY) return false;
+    for (uint8_t j = count; j > i; --j) locks[j] = locks[j - 1];
+    locks[i].step = step;
+    locks[i].param = param;
+    locks[i].value = value;
+    count++;
+    for (uint8_t s = step + 1; s <= Steps; ++s) stepStart[s]++;
+    return true;
+  }
+
+  /**
+   * @brief Remove a lock (no-op if absent).
+   */
+  void clear(uint8_t step, uint8_t param) {
+    if (step >= Steps) return;
+    for (uint8_t i = stepStart[step]; i < stepStart[step + 1]; ++i) {
+      if (locks[i].param == param) {
+        for (uint8_t j = i; j + 1 < count; ++j) locks[j] = locks[j + 1];
+        count--;
+        for (uint8_t s = step + 1; s <= Steps; ++s) stepStart[s]--;
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief Raw value of a lock, or PARAM_LOCK_NONE.
+   */
+  uint32_t get(uint8_t step, uint8_t param) const {
+    if (step >= Steps) return PARAM_LOCK_NONE;
+    for (uint8_t i = stepStart[step]; i < stepStart[step + 1]; ++i) {
+      if (locks[i].param == param) return locks[i].value;
+    }
+    return PARAM_LOCK_NONE;
+  }
+
+  /**
+   * @brief Replace all locks in O(count + Steps), e.g. when loading a pattern.
+   * @param source Locks sorted by step, then parameter, without duplicates
+   * @return false (and the track is left empty) if source is not valid.
+   */
+  bool assign(const ParamLock *source, uint8_t sourceCount) {
+    count = 0;
+    for (uint8_t s = 0; s <= Steps; ++s) stepStart[s] = 0;
+    if (sourceCount > PARAM_LOCK_CAPACITY) return false;
+    for (uint8_t i = 0; i < sourceCount; ++i) {
+      const ParamLock &l = source[i];
+      if (l.step >= Steps || l.param >= SYNTH_PARAM_COUNT) return false;
+      if (i > 0 && (l.step < source[i - 1].step ||
+                    (l.step == source[i - 1].step && l.param <= source[i - 1].param))) {
+        return false;
+      }
+    }
+    for (uint8_t i = 0; i < sourceCount; ++i) {
+      locks[i] = source[i];
+      stepStart[source[i].step + 1]++;
+    }
+    for (uint8_t s = 0; s < Steps; ++s) stepStart[s + 1] += stepStart[s];
+    count = sourceCount;
+    return true;
+  }
+
+  // Locks of one step, sorted by parameter
+  const ParamLock *begin(uint8_t step) const { return &locks[stepStart[step]]; }
+  const ParamLock *end(uint8_t step) const { return &locks[stepStart[step + 1]]; }
+
+  // Value used on steps without a lock
+  uint16_t getBase(uint8_t param) const { return base[param]; }
+  void setBase(uint8_t param, uint16_t value) {
+    if (param < SYNTH_PARAM_COUNT) base[param] = value;
+  }
+
+  uint8_t getCount() const { return count; }
+
+  // All locks, sorted by step (getCount() entries)
+  const ParamLock *data() const { return locks; }
+
+private:
+  ParamLock locks[PARAM_LOCK_CAPACITY];
+  uint8_t stepStart[Steps + 1]; // Index of the first lock of each step
+  uint8_t count = 0;
+  uint16_t base[SYNTH_PARAM_COUNT];
+};
+
+#endif // PARAM_LOCKS_H
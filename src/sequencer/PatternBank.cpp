@@ -0,0 +1,102 @@
+/**
+ * @file PatternBank.cpp
+ * @brief Pattern packing and unpacking.
+ */
+
+#include "PatternBank.h"
+#include <string.h>
+
+static uint16_t packUnit(float value) {
+    if (value <= 0.0f) return 0;
+    if (value >= 1.0f) return 0xFFFF;
+    return static_cast<uint16_t>(value * 65535.0f + 0.5f);
+}
+
+static uint16_t packFilter(float hz) {
+    float scaled = hz * PATTERN_FILTER_SCALE + 0.5f;
+    if (scaled <= 0.0f) return 0;
+    if (scaled >= 65535.0f) return 0xFFFF;
+    return static_cast<uint16_t>(scaled);
+}
+
+static uint8_t clampByte(uint8_t value, uint8_t minValue, uint8_t maxValue) {
+    if (value < minValue) return minValue;
+    if (value > maxValue) return maxValue;
+    return value;
+}
+
+void encodePattern(const SequencerState& state, PackedPattern& packed) {
+    for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; ++i) {
+        const Step& step = state.steps[i];
+        PackedStep& out = packed.steps[i];
+        out.flags = (step.gate ? PACKED_STEP_GATE : 0) |
+                    (step.slide ? PACKED_STEP_SLIDE : 0) |
+                    static_cast<uint8_t>(((step.ratchets - 1) & 0x07) << PACKED_STEP_RATCHET_SHIFT);
+        out.note = static_cast<uint8_t>(step.note);
+        out.velocity = packUnit(step.velocity);
+        out.filter = packFilter(step.filter);
+        out.microTiming = step.microTiming;
+        out.gateLength = step.gateLength;
+        out.probability = step.probability;
+        out.condition = step.condition;
+    }
+    packed.swing = state.swing;
+
+    const ParamLockTrack<SEQUENCER_NUM_STEPS>& locks = state.paramLocks;
+    packed.lockCount = locks.getCount();
+    for (uint8_t i = 0; i < packed.lockCount; ++i) {
+        packed.locks[i] = locks.data()[i];
+    }
+    // Unused entries are zeroed so equal patterns pack to equal bytes
+    for (uint8_t i = packed.lockCount; i < PARAM_LOCK_CAPACITY; ++i) {
+        packed.locks[i] = ParamLock{0, 0, 0};
+    }
+    for (uint8_t p = 0; p < SYNTH_PARAM_COUNT; ++p) {
+        packed.paramBase[p] = locks.getBase(p);
+    }
+}
+
+void decodePattern(const PackedPattern& packed, SequencerState& state) {
+    for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; ++i) {
+        const PackedStep& in = packed.steps[i];
+        Step& step = state.steps[i];
+        step.gate = (in.flags & PACKED_STEP_GATE) != 0;
+        step.slide = (in.flags & PACKED_STEP_SLIDE) != 0;
+        step.ratchets = static_cast<uint8_t>(((in.flags >> PACKED_STEP_RATCHET_SHIFT) & 0x07) + 1);
+        step.note = in.note;
+        step.velocity = in.velocity / 65535.0f;
+        step.filter = in.filter / PATTERN_FILTER_SCALE;
+        step.microTiming = in.microTiming;
+        if (step.microTiming > MICRO_TIMING_MAX) step.microTiming = MICRO_TIMING_MAX;
+        if (step.microTiming < -MICRO_TIMING_MAX) step.microTiming = -MICRO_TIMING_MAX;
+        step.gateLength = clampByte(in.gateLength, 1, SEQUENCER_TICKS_PER_STEP);
+        step.probability = clampByte(in.probability, 0, STEP_PROBABILITY_MAX);
+        step.condition = stepCondition(conditionPass(in.condition), conditionCycle(in.condition));
+    }
+    state.swing = clampByte(packed.swing, SWING_MIN, SWING_MAX);
+
+    // A corrupt lock list leaves the pattern without locks
+    state.paramLocks.assign(packed.locks, packed.lockCount);
+    for (uint8_t p = 0; p < SYNTH_PARAM_COUNT; ++p) {
+        state.paramLocks.setBase(p, packed.paramBase[p]);
+    }
+}
+
+PatternBank::PatternBank() {
+    const SequencerState empty;
+    for (uint8_t i = 0; i < PATTERN_BANK_SIZE; ++i) {
+        encodePattern(empty, patterns[i]);
+    }
+}
+
+void PatternBank::store(uint8_t slot, const SequencerState& state) {
+    if (slot >= PATTERN_BANK_SIZE) {
+        return;
+    }
+    PackedPattern packed;
+    encodePattern(state, packed);
+    if (memcmp(&packed, &patterns[slot], sizeof(packed)) != 0) {
+        patterns[slot] = packed;
+        dirtyMask |= 1u << slot;
+    }
+}
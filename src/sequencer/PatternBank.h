@@ -0,0 +1,101 @@
+/**
+ * @file PatternBank.h
+ * @brief Compact storage format for patterns and the bank that holds them.
+ *
+ * Patterns that are not playing are kept packed: 10 bytes per step instead
+ * of the 24 of a Step, plus the pattern's swing, parameter-lock bases and
+ * its locks. decodePattern() expands a packed pattern into a
+ * SequencerState; the sequencer does this one step ahead of a pattern
+ * switch, so the switch itself is only a pointer swap.
+ *
+ * Velocity is stored with 16-bit resolution and the filter in 1/16 Hz
+ * (0-4095 Hz); all other fields are stored exactly.
+ *
+ * Example:
+ *   PatternBank bank;
+ *   bank.store(3, sequencerState);      // Pack into slot 3
+ *   SequencerState next;
+ *   decodePattern(bank.get(3), next);   // Unpack
+ */
+
+#ifndef PATTERN_BANK_H
+#define PATTERN_BANK_H
+
+#include <stdint.h>
+#include "SequencerDefs.h"
+
+// Number of pattern slots (one per step button)
+constexpr uint8_t PATTERN_BANK_SIZE = 16;
+
+// Bumped whenever PackedPattern changes layout
+constexpr uint8_t PATTERN_FORMAT_VERSION = 1;
+
+// Filter values are stored in 1/PATTERN_FILTER_SCALE Hz
+constexpr float PATTERN_FILTER_SCALE = 16.0f;
+
+// PackedStep::flags layout
+constexpr uint8_t PACKED_STEP_GATE = 0x01;
+constexpr uint8_t PACKED_STEP_SLIDE = 0x02;
+constexpr uint8_t PACKED_STEP_RATCHET_SHIFT = 2; // Ratchets - 1, 3 bits
+
+struct PackedStep {
+  uint8_t flags;       // Gate, slide, ratchets
+  uint8_t note;        // Scale degree
+  uint16_t velocity;   // 0-65535 = 0.0-1.0
+  uint16_t filter;     // 1/16 Hz
+  int8_t microTiming;
+  uint8_t gateLength;
+  uint8_t probability;
+  uint8_t condition;
+};
+
+static_assert(sizeof(PackedStep) == 10, "PackedStep layout changed");
+
+struct PackedPattern {
+  PackedStep steps[SEQUENCER_NUM_STEPS];
+  uint8_t swing;
+  uint8_t lockCount;
+  uint16_t paramBase[SYNTH_PARAM_COUNT];
+  ParamLock locks[PARAM_LOCK_CAPACITY];
+};
+
+/**
+ * @brief Pack a pattern (playhead and running state are not stored).
+ */
+void encodePattern(const SequencerState& state, PackedPattern& packed);
+
+/**
+ * @brief Unpack a pattern; playhead and running state are left unchanged.
+ * Out-of-range fields are clamped, so a corrupt slot still plays safely.
+ * Cost is O(steps + locks).
+ */
+void decodePattern(const PackedPattern& packed, SequencerState& state);
+
+class PatternBank {
+public:
+  PatternBank();
+
+  // Pack into a slot; the slot becomes dirty if its content changed
+  void store(uint8_t slot, const SequencerState& state);
+
+  const PackedPattern& get(uint8_t slot) const {
+    return patterns[slot < PATTERN_BANK_SIZE ? slot : 0];
+  }
+
+  // Raw slot access for persistence and transfer (call markDirty() after
+  // changing a slot that should be saved)
+  PackedPattern& getSlot(uint8_t slot) {
+    return patterns[slot < PATTERN_BANK_SIZE ? slot : 0];
+  }
+
+  // Slots changed since they were last saved (bit per slot)
+  uint16_t getDirtyMask() const { return dirtyMask; }
+  void markDirty(uint8_t slot) { if (slot < PATTERN_BANK_SIZE) dirtyMask |= 1u << slot; }
+  void clearDirty(uint8_t slot) { if (slot < PATTERN_BANK_SIZE) dirtyMask &= ~(1u << slot); }
+
+private:
+  PackedPattern patterns[PATTERN_BANK_SIZE];
+  uint16_t dirtyMask = 0;
+};
+
+#endif // PATTERN_BANK_H
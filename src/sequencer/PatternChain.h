@@ -0,0 +1,128 @@
+/**
+ * @file PatternChain.h
+ * @brief Decides which pattern plays next: cued chains and song mode.
+ *
+ * Cued patterns play once each, in order, and take priority. In song mode
+ * the chain otherwise walks a list of (pattern, repeats) entries and loops
+ * at the end; without song mode the current pattern keeps repeating.
+ *
+ * peek() answers "what plays after this pass?" without changing anything,
+ * so the sequencer can prefetch that pattern one step early; advance() is
+ * called on the pattern boundary and returns the same answer.
+ *
+ * Example:
+ *   PatternChain chain;
+ *   chain.setEntry(0, 0, 2);    // Pattern 0 twice
+ *   chain.setEntry(1, 3, 1);    // then pattern 3 once
+ *   chain.setLength(2);
+ *   chain.setSongMode(true);
+ *   uint8_t first = chain.restart();
+ *   uint8_t next = chain.advance(first);  // At each pattern boundary
+ */
+
+#ifndef PATTERN_CHAIN_H
+#define PATTERN_CHAIN_H
+
+#include <stdint.h>
+#include "PatternBank.h"
+
+// Patterns that can be cued ahead
+constexpr uint8_t PATTERN_CUE_DEPTH = 8;
+
+// Maximum song length in entries
+constexpr uint8_t SONG_MAX_ENTRIES = 32;
+
+struct SongEntry {
+  uint8_t pattern;
+  uint8_t repeats; // Passes to play, >= 1
+};
+
+class PatternChain {
+public:
+  PatternChain() {
+    for (uint8_t i = 0; i < SONG_MAX_ENTRIES; ++i) entries[i] = SongEntry{0, 1};
+  }
+
+  /**
+   * @brief Queue a pattern to play once after the current pass.
+   * @return false if the pattern is invalid or the queue is full.
+   */
+  bool cue(uint8_t pattern) {
+    if (pattern >= PATTERN_BANK_SIZE || cueCount >= PATTERN_CUE_DEPTH) return false;
+    cues[(cueHead + cueCount) % PATTERN_CUE_DEPTH] = pattern;
+    cueCount++;
+    return true;
+  }
+
+  void clearCues() { cueCount = 0; }
+  uint8_t getCueCount() const { return cueCount; }
+
+  void setSongMode(bool enabled) { songMode = enabled; }
+  bool isSongMode() const { return songMode && length > 0; }
+
+  bool setEntry(uint8_t index, uint8_t pattern, uint8_t repeats) {
+    if (index >= SONG_MAX_ENTRIES || pattern >= PATTERN_BANK_SIZE) return false;
+    entries[index] = SongEntry{pattern, repeats > 0 ? repeats : static_cast<uint8_t>(1)};
+    return true;
+  }
+
+  const SongEntry &getEntry(uint8_t index) const {
+    return entries[index < SONG_MAX_ENTRIES ? index : 0];
+  }
+
+  void setLength(uint8_t len) {
+    length = len <= SONG_MAX_ENTRIES ? len : SONG_MAX_ENTRIES;
+    if (position >= length) restart();
+  }
+  uint8_t getLength() const { return length; }
+  uint8_t getPosition() const { return position; }
+
+  /**
+   * @brief Rewind the song; returns the first pattern.
+   */
+  uint8_t restart() {
+    position = 0;
+    passes = 0;
+    return entries[0].pattern;
+  }
+
+  // Pattern that plays after the current pass
+  uint8_t peek(uint8_t current) const {
+    if (cueCount > 0) return cues[cueHead];
+    if (!isSongMode()) return current;
+    if (passes + 1 < entries[position].repeats) return entries[position].pattern;
+    return entries[(position + 1) % length].pattern;
+  }
+
+  /**
+   * @brief Move to the next pass (call on the pattern boundary).
+   * @return Pattern to play from now on.
+   */
+  uint8_t advance(uint8_t current) {
+    if (cueCount > 0) {
+      const uint8_t pattern = cues[cueHead];
+      cueHead = (cueHead + 1) % PATTERN_CUE_DEPTH;
+      cueCount--;
+      return pattern;
+    }
+    if (!isSongMode()) return current;
+    if (++passes >= entries[position].repeats) {
+      passes = 0;
+      position = (position + 1) % length;
+    }
+    return entries[position].pattern;
+  }
+
+private:
+  uint8_t cues[PATTERN_CUE_DEPTH];
+  uint8_t cueHead = 0;
+  uint8_t cueCount = 0;
+
+  SongEntry entries[SONG_MAX_ENTRIES];
+  uint8_t length = 0;
+  uint8_t position = 0;
+  uint8_t passes = 0; // Completed passes of the current entry
+  bool songMode = false;
+};
+
+#endif // PATTERN_CHAIN_H
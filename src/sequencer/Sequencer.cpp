@@ -11,14 +11,88 @@
  */
 
 #include "Sequencer.h"
+#include "BasicSequencer.h"
+#include "../profiler/Profiler.h"
+#include "../quantizer/Quantizer.h"
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
 #include <cstdint>
-#include <stdlib.h> // for random()
+#include <string.h> // for memcpy()
 
-const size_t scaleSize = SCALE_ARRAY_SIZE; // Use the defined constant
+// Journal values are raw 32-bit words; floats are stored by bit pattern
+static uint32_t floatToBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsToFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
 
-// Define a base MIDI note for the scale. This could be configurable.
-const uint8_t MIDI_BASE_NOTE = 36; // Example: C1 (MIDI note 36)
+/**
+ * @brief Read one field of a pattern as a journal value.
+ */
+static uint32_t readField(const SequencerState& pattern, uint8_t stepIdx, StepField field) {
+    if (field >= STEP_FIELD_PARAM_BASE) {
+        return pattern.paramLocks.getBase(field - STEP_FIELD_PARAM_BASE);
+    }
+    if (field >= STEP_FIELD_PARAM_LOCK) {
+        return pattern.paramLocks.get(stepIdx, field - STEP_FIELD_PARAM_LOCK);
+    }
+    const Step& step = pattern.steps[stepIdx];
+    switch (field) {
+    case STEP_FIELD_GATE:         return step.gate;
+    case STEP_FIELD_SLIDE:        return step.slide;
+    case STEP_FIELD_NOTE:         return static_cast<uint32_t>(step.note);
+    case STEP_FIELD_VELOCITY:     return floatToBits(step.velocity);
+    case STEP_FIELD_FILTER:       return floatToBits(step.filter);
+    case STEP_FIELD_MICRO_TIMING: return static_cast<uint32_t>(static_cast<int32_t>(step.microTiming));
+    case STEP_FIELD_GATE_LENGTH:  return step.gateLength;
+    case STEP_FIELD_RATCHETS:     return step.ratchets;
+    case STEP_FIELD_SWING:        return pattern.swing;
+    case STEP_FIELD_PROBABILITY:  return step.probability;
+    case STEP_FIELD_CONDITION:    return step.condition;
+    default:                      return 0;
+    }
+}
+
+/**
+ * @brief Write one field of a pattern from a journal value.
+ */
+static void writeField(SequencerState& pattern, uint8_t stepIdx, StepField field, uint32_t value) {
+    if (field >= STEP_FIELD_PARAM_BASE) {
+        pattern.paramLocks.setBase(field - STEP_FIELD_PARAM_BASE, static_cast<uint16_t>(value));
+        return;
+    }
+    if (field >= STEP_FIELD_PARAM_LOCK) {
+        const uint8_t param = field - STEP_FIELD_PARAM_LOCK;
+        if (value == PARAM_LOCK_NONE) {
+            pattern.paramLocks.clear(stepIdx, param);
+        } else {
+            pattern.paramLocks.set(stepIdx, param, static_cast<uint16_t>(value));
+        }
+        return;
+    }
+    Step& step = pattern.steps[stepIdx];
+    switch (field) {
+    case STEP_FIELD_GATE:         step.gate = value != 0; break;
+    case STEP_FIELD_SLIDE:        step.slide = value != 0; break;
+    case STEP_FIELD_NOTE:         step.note = static_cast<int>(value); break;
+    case STEP_FIELD_VELOCITY:     step.velocity = bitsToFloat(value); break;
+    case STEP_FIELD_FILTER:       step.filter = bitsToFloat(value); break;
+    case STEP_FIELD_MICRO_TIMING: step.microTiming = static_cast<int8_t>(static_cast<int32_t>(value)); break;
+    case STEP_FIELD_GATE_LENGTH:  step.gateLength = static_cast<uint8_t>(value); break;
+    case STEP_FIELD_RATCHETS:     step.ratchets = static_cast<uint8_t>(value); break;
+    case STEP_FIELD_SWING:        pattern.swing = static_cast<uint8_t>(value); break;
+    case STEP_FIELD_PROBABILITY:  step.probability = static_cast<uint8_t>(value); break;
+    case STEP_FIELD_CONDITION:    step.condition = static_cast<uint8_t>(value); break;
+    default:                      break;
+    }
+}
 
 // ==============================
 //  Sequencer Implementation
@@ -35,32 +109,37 @@ const uint8_t MIDI_BASE_NOTE = 36; // Example: C1 (MIDI note 36)
  * @return true if initialization succeeded, false if an error was detected.
  */
 void Sequencer::init() {
-    state.playhead = 0;
-    state.running = false;
+    play->playhead = 0;
+    play->running = false;
     initializeSteps(); 
+    commitEdits();
+    bank.store(currentPattern, edit);
+    publishSnapshot();
 }
 
 void Sequencer::initializeSteps() {
     // Serial output removed due to missing Serial definition
+    beginEdit();
     for (uint8_t i = 0; i < stepLength; ++i) {
-        state.steps[i] = Step(); // Default initialization
-        state.steps[i].note = 0;
-        state.steps[i].gate = true; // All gates ON
-        state.steps[i].velocity = 100.0f / 127.0f; // Velocity at 100 (MIDI scale)
-        state.steps[i].filter = random(200,1000); // Filter freq at 2000 Hz (normalized)
+        edit.steps[i] = Step(); // Default initialization
+        edit.steps[i].note = 0;
+        edit.steps[i].gate = true; // All gates ON
+        edit.steps[i].velocity = 100.0f / 127.0f; // Velocity at 100 (MIDI scale)
+        edit.steps[i].filter = rng.range(200, 1000); // Filter freq at 2000 Hz (normalized)
         // Serial.print("  Step "); Serial.print(i);
-        // Serial.print(": ON, Note Index: "); Serial.println(state.steps[i].note);
+        // Serial.print(": ON, Note Index: "); Serial.println(edit.steps[i].note);
         // Serial.print("  Step "); Serial.print(i);
-        // Serial.print(": Velocity: "); Serial.println(state.steps[i].velocity);
+        // Serial.print(": Velocity: "); Serial.println(edit.steps[i].velocity);
         // Serial.print("  Step "); Serial.print(i);
-        // Serial.print(": Filter: "); Serial.println(state.steps[i].filter);
+        // Serial.print(": Filter: "); Serial.println(edit.steps[i].filter);
     }
     // Clear any unused steps
     for (uint8_t i = stepLength; i < SEQUENCER_NUM_STEPS; ++i) {
-        state.steps[i] = Step();
-        state.steps[i].gate = false;
+        edit.steps[i] = Step();
+        edit.steps[i].gate = false;
     }
-    
+    endEdit();
+    journal.clear();
 }
 
 
@@ -68,7 +147,7 @@ void Sequencer::initializeSteps() {
 /**
  * @brief Default constructor. Initializes sequencer state to default values.
  */
-Sequencer::Sequencer() : io(nullptr), state(), errorFlag(false), lastNote(-1) {
+Sequencer::Sequencer() : io(nullptr), errorFlag(false), lastNote(-1) {
     // All steps default to OFF, note 60, gate false (see Step constructor)
     // Playhead at 0, running = false
 }
@@ -76,7 +155,7 @@ Sequencer::Sequencer() : io(nullptr), state(), errorFlag(false), lastNote(-1) {
 /**
  * @brief Constructor with I/O interface injection.
  */
-Sequencer::Sequencer(SequencerIO* io) : io(io), state(), errorFlag(false), lastNote(-1) {
+Sequencer::Sequencer(SequencerIO* io) : io(io), errorFlag(false), lastNote(-1) {
     // All steps default to OFF, note 60, gate false (see Step constructor)
     // Playhead at 0, running = false
 }
@@ -85,7 +164,20 @@ Sequencer::Sequencer(SequencerIO* io) : io(io), state(), errorFlag(false), lastN
  * @brief Start the sequencer (sets running flag).
  */
 void Sequencer::start() {
-    state.running = true;
+    if (chain.isSongMode()) {
+        const uint8_t first = chain.restart();
+        if (first != currentPattern) {
+            loadPattern(first);
+        }
+    }
+    standbyPattern = -1;
+    deferredPattern = -1;
+    play->running = true;
+    slideActive = false;
+    rng.setSeed(randomSeed);
+    patternCycle = 0;
+    firstStep = true;
+    publishSnapshot();
 }
 
 /**
@@ -93,7 +185,8 @@ void Sequencer::start() {
  *        Optionally, clear all gates (left for output module).
  */
 void Sequencer::stop() {
-    state.running = false;
+    play->running = false;
+    publishSnapshot();
     // Optionally, clear all gates (not handled here, left for output module)
 }
 
@@ -106,58 +199,69 @@ void Sequencer::reset() {
 }
 
 /**
- * @brief Processes the sequencer logic for the given step provided by uClock.
- *
- * Core sequencer step-advance logic:
- * - Uses the `current_uclock_step` to set the internal playhead.
- * - Track the last played note.
- * - Always send noteOff for the last note before sending noteOn for the new note.
- * - If the new step is ON, send noteOn for the current note, set oscillator frequency, and trigger the envelope.
- * - If the new step is OFF, send noteOff for the last note (if any) and release the envelope.
- * - Handle repeated notes by sending noteOff then noteOn, even if the note is the same.
- * - Modular, robust, and well-documented.
- * @param current_uclock_step The current step number (0-15) provided by uClock.
+ * @brief Stop, release the sounding note, rewind and reload the default
+ * steps. Sets the error flag if the resulting state is inconsistent.
  */
-void Sequencer::advanceStep(uint8_t current_uclock_step) {
-  // Always send NoteOff for the last note before starting a new one (monophonic)
-    if (currentNote >= 0) {
-        handleNoteOff();
+void Sequencer::resetState() {
+    handleNoteOff();
+    releaseEnvelope();
+    lastNote = -1;
+    slideActive = false;
+    firstStep = true;
+
+    play->running = false;
+    play->playhead = 0;
+    initializeSteps();
+    commitEdits();
+
+    errorFlag = !validateState();
+    publishSnapshot();
+}
+
+/**
+ * @brief Check the playing pattern's invariants (step length, playhead and
+ * per-step field ranges). The filter field is not checked: it holds Hz.
+ */
+bool Sequencer::validateState() const {
+    if (stepLength < 1 || stepLength > SEQUENCER_NUM_STEPS || play->playhead >= stepLength) {
+        return false;
     }
-    
-    // Wrap step index to stepLength
-    state.playhead = current_uclock_step % stepLength;
-    Step &currentStep = state.steps[state.playhead];
-
-    if (currentStep.gate) {
-        // Clamp note index to scale size
-        uint8_t scaleIndex = (currentStep.note >= scaleSize) ? 0 : currentStep.note;
-        if (scaleIndex >= SCALE_ARRAY_SIZE) { // Defensive check
-            scaleIndex = 0;
-        }
-        
-        int new_midi_note = MIDI_BASE_NOTE;
-        if (io) {
-            new_midi_note += io->getScaleNote(0, scaleIndex);
+    for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; ++i) {
+        const Step& step = play->steps[i];
+        if (step.note < 0 || step.note >= QUANTIZER_DEGREES ||
+            step.velocity < 0.0f || step.velocity > 1.0f ||
+            step.gateLength < 1 || step.gateLength > SEQUENCER_TICKS_PER_STEP ||
+            step.ratchets < 1 || step.ratchets > MAX_RATCHETS ||
+            step.probability > STEP_PROBABILITY_MAX ||
+            step.microTiming < -MICRO_TIMING_MAX || step.microTiming > MICRO_TIMING_MAX) {
+            return false;
         }
+    }
+    return true;
+}
 
-        // Update the synth engine's target note via I/O interface
-        if (io) {
-            io->setNote1(new_midi_note);
-            io->setVel1(currentStep.velocity);
-            io->setFreq1(currentStep.filter * 1.f); // Map filter 0.0-1.0 to 0-5000 Hz
-            io->triggerEnvelope();
-        }
+bool Sequencer::checkState() {
+    errorFlag = !validateState();
+    return !errorFlag;
+}
 
-        // Start the note with a fixed duration (e.g., 24 ticks for a 16th note at 96 PPQN)
-        startNote(new_midi_note, currentStep.velocity, 24);
+/**
+ * @brief Processes the sequencer logic for the given step provided by uClock
+ * (through the virtual SequencerIO; see advanceStepWith() in BasicSequencer.h).
+ * @param current_uclock_step The current step number (0-15) provided by uClock.
+ */
+void Sequencer::advanceStep(uint8_t current_uclock_step) {
+    advanceStepWith(io, current_uclock_step);
+}
 
-        lastNote = new_midi_note; // Update lastNote to the currently playing MIDI note.
-    } else {
-        // Current step's gate is OFF (a rest).
-        handleNoteOff();
-        releaseEnvelope(); // Sets trigenv1 = false
-        lastNote = -1;     // No MIDI note is actively sounding from the sequencer.
-    }
+/**
+ * @brief Decide whether a step plays on this pass.
+ * Rolls the generator exactly once per step, whatever the step's settings,
+ * so editing one step never shifts the random sequence of the others.
+ */
+bool Sequencer::stepTriggers(const Step& step) {
+    const bool roll = rng.below(STEP_PROBABILITY_MAX) < step.probability;
+    return step.gate && roll && conditionMet(step.condition, patternCycle);
 }
 
 /**
@@ -171,48 +275,53 @@ void Sequencer::advanceStep(uint8_t current_uclock_step) {
 void Sequencer::recordLiveParameters(int mm_distance, bool is_button16_held, 
                                    bool is_button17_held, bool is_button18_held,
                                    int current_selected_step_for_edit) {
+    // Everything recorded while a record button is held undoes as one pass
+    const bool recording = is_button16_held || is_button17_held || is_button18_held;
+    if (recording && !recordPassActive) {
+        journal.beginGroup();
+        recordPassActive = true;
+    } else if (!recording && recordPassActive) {
+        journal.endGroup();
+        recordPassActive = false;
+    }
+
+    const uint8_t unit = sensorToUnit(mm_distance);
+
     // Record live parameters if a step is selected for editing
     if (current_selected_step_for_edit >= 0 && current_selected_step_for_edit < stepLength) {
         // Record distance sensor data as note or filter frequency
         if (is_button16_held) {
-            // Map distance to note index (0-24)
-            int noteIndex = map(mm_distance, 50, 400, 0, 24);
-            noteIndex = constrain(noteIndex, 0, 24);
+            // Map distance to two octaves, snapped to the nearest scale degree
+            int semitone = unitToSemitone(unit);
+            int noteIndex = io ? io->getNearestScaleDegree(semitone) : semitone;
             setStepNote(current_selected_step_for_edit, noteIndex);
         }
         
         if (is_button17_held) {
             // Map distance to velocity (0.0-1.0)
-            float velocity = map(mm_distance, 50, 400, 0, 127) / 127.0f;
-            velocity = constrain(velocity, 0.0f, 1.0f);
-            setStepVelocity(current_selected_step_for_edit, velocity * 127);
+            editField(current_selected_step_for_edit, STEP_FIELD_VELOCITY, floatToBits(unitToVelocity(unit)));
         }
         
         if (is_button18_held) {
             // Map distance to filter frequency (200-2000 Hz)
-            float filterFreq = map(mm_distance, 50, 400, 200, 2000);
-            filterFreq = constrain(filterFreq, 200.0f, 2000.0f);
-            setStepFiltFreq(current_selected_step_for_edit, filterFreq);
+            setStepFiltFreq(current_selected_step_for_edit, unitToFilterHz(unit));
         }
     }
     
     // Auto-write distance sensor to current step if no step is selected for edit and gate is high
-    if (current_selected_step_for_edit == -1) {
-        Step &currentStep = state.steps[state.playhead];
-        if (currentStep.gate) {
+    if (current_selected_step_for_edit == -1 && recording) {
+        const uint8_t stepIdx = play->playhead;
+        if (edit.steps[stepIdx].gate) {
             // Only record one type of data at a time, based on which record button is held
             if (is_button16_held) {
-                int mmNote = map(mm_distance, 0, 1400, 0, 24);
-                mmNote = constrain(mmNote, 0, 24);
-                currentStep.note = mmNote;
+                // Distance spans two octaves; snap the pitch to the scale
+                int semitone = unitToSemitone(unit);
+                int noteIndex = io ? io->getNearestScaleDegree(semitone) : semitone;
+                editField(stepIdx, STEP_FIELD_NOTE, static_cast<uint32_t>(noteIndex));
             } else if (is_button17_held) {
-                int mmVelocity = map(mm_distance, 0, 1400, 0, 1000);
-                mmVelocity = constrain(mmVelocity, 0, 1000);
-                currentStep.velocity = mmVelocity / 1000.0f;
+                editField(stepIdx, STEP_FIELD_VELOCITY, floatToBits(unitToVelocity(unit)));
             } else if (is_button18_held) {
-                int mmFiltFreq = map(mm_distance, 0, 1400, 0, 2000);
-                mmFiltFreq = constrain(mmFiltFreq, 0, 2000);
-                currentStep.filter = mmFiltFreq;
+                editField(stepIdx, STEP_FIELD_FILTER, floatToBits(unitToFilterHz(unit)));
             }
         }
     }
@@ -222,16 +331,15 @@ void Sequencer::recordLiveParameters(int mm_distance, bool is_button16_held,
  */
 void Sequencer::playStepNow(uint8_t stepIdx) {
     if (stepIdx >= stepLength) return;
-    Step &currentStep = state.steps[stepIdx];
+    Step &currentStep = edit.steps[stepIdx];
 
-    // Clamp note index to scale size
-    uint8_t scaleIndex = (currentStep.note >= scaleSize) ? 0 : currentStep.note;
-    if (scaleIndex >= SCALE_ARRAY_SIZE) scaleIndex = 0;
-    
-    int new_midi_note = MIDI_BASE_NOTE;
+    // Note index is a scale degree; the quantizer maps it to semitones
+    int new_midi_note = MIDI_BASE_NOTE + transpose;
     if (io) {
-        new_midi_note += io->getScaleNote(0, scaleIndex);
+        new_midi_note += io->getScaleNote(currentStep.note);
     }
+    if (new_midi_note < 0) new_midi_note = 0;
+    if (new_midi_note > 127) new_midi_note = 127;
 
     // Update the synth engine's target note via I/O interface
     if (io) {
@@ -281,7 +389,7 @@ void Sequencer::toggleStep(uint8_t stepIdx) {
         // Serial.print("[SEQ] toggleStep: Invalid step index: "); Serial.println(stepIdx);
         return;
     }
-    state.steps[stepIdx].gate = !state.steps[stepIdx].gate;
+    editField(stepIdx, STEP_FIELD_GATE, !edit.steps[stepIdx].gate);
 }
 /**
  * @brief Set the MIDI note for a specific step.
@@ -295,7 +403,7 @@ void Sequencer::setStepNote(uint8_t stepIdx, uint8_t noteIndex) {
         // Serial.println("  - Invalid step index. Returning.");
         return;
     }
-    state.steps[stepIdx].note = noteIndex;
+    editField(stepIdx, STEP_FIELD_NOTE, noteIndex);
     // Serial.print("  - Step "); Serial.print(stepIdx);
     // Serial.print(" new note index: "); Serial.println(state.steps[stepIdx].note);
 }
@@ -305,7 +413,7 @@ void Sequencer::setStepVelocity(uint8_t stepIdx, uint8_t velocityByte) { // velo
         return;
     }
     // Convert 0-127 byte to 0.0f-1.0f float
-    state.steps[stepIdx].velocity = static_cast<float>(velocityByte) / 127.0f;
+    editField(stepIdx, STEP_FIELD_VELOCITY, floatToBits(static_cast<float>(velocityByte) / 127.0f));
 }
 void Sequencer::setStepFiltFreq(uint8_t stepIdx, float filter) {
  
@@ -313,10 +421,118 @@ void Sequencer::setStepFiltFreq(uint8_t stepIdx, float filter) {
         // Serial.println("  - Invalid step index. Returning.");
         return;
     }
-    state.steps[stepIdx].filter = filter;
+    editField(stepIdx, STEP_FIELD_FILTER, floatToBits(filter));
     // Serial.print("  - Step "); Serial.print(stepIdx);
     // Serial.print(" new note index: "); Serial.println(state.steps[stepIdx].note);
 }
+/**
+ * @brief Set the swing amount for the pattern.
+ * @param percent Length of the first 16th of each pair, in percent of the pair
+ *                (50 = straight, 66 = triplet feel, max 75).
+ */
+void Sequencer::setSwing(uint8_t percent) {
+    if (percent < SWING_MIN) percent = SWING_MIN;
+    if (percent > SWING_MAX) percent = SWING_MAX;
+    editField(0, STEP_FIELD_SWING, percent);
+}
+
+/**
+ * @brief Set the micro-timing offset of a step.
+ * @param stepIdx Index of the step.
+ * @param ticks Offset in ticks at 96 PPQN, clamped to +/-MICRO_TIMING_MAX.
+ */
+void Sequencer::setStepMicroTiming(uint8_t stepIdx, int8_t ticks) {
+    if (stepIdx >= stepLength) {
+        return;
+    }
+    if (ticks > MICRO_TIMING_MAX) ticks = MICRO_TIMING_MAX;
+    if (ticks < -MICRO_TIMING_MAX) ticks = -MICRO_TIMING_MAX;
+    editField(stepIdx, STEP_FIELD_MICRO_TIMING, static_cast<uint32_t>(static_cast<int32_t>(ticks)));
+}
+
+/**
+ * @brief Get the timing offset of a step relative to the grid.
+ * Swing delays every second step by (swing - 50)% of a step pair.
+ */
+int8_t Sequencer::getStepTickOffset(uint8_t stepIdx) const {
+    uint8_t idx = stepIdx % stepLength;
+    int16_t offset = play->steps[idx].microTiming;
+    if (idx & 1) {
+        offset += (static_cast<int16_t>(play->swing - SWING_MIN) * 2 * SEQUENCER_TICKS_PER_STEP) / 100;
+    }
+    return static_cast<int8_t>(offset);
+}
+
+/**
+ * @brief Set the gate length of a step.
+ * @param stepIdx Index of the step.
+ * @param ticks Gate time in ticks at 96 PPQN (1-SEQUENCER_TICKS_PER_STEP).
+ */
+void Sequencer::setStepGateLength(uint8_t stepIdx, uint8_t ticks) {
+    if (stepIdx >= stepLength) {
+        return;
+    }
+    if (ticks < 1) ticks = 1;
+    if (ticks > SEQUENCER_TICKS_PER_STEP) ticks = SEQUENCER_TICKS_PER_STEP;
+    editField(stepIdx, STEP_FIELD_GATE_LENGTH, ticks);
+}
+
+/**
+ * @brief Set the ratchet count of a step.
+ * @param stepIdx Index of the step.
+ * @param count Number of hits within the step (1-MAX_RATCHETS).
+ */
+void Sequencer::setStepRatchets(uint8_t stepIdx, uint8_t count) {
+    if (stepIdx >= stepLength) {
+        return;
+    }
+    if (count < 1) count = 1;
+    if (count > MAX_RATCHETS) count = MAX_RATCHETS;
+    editField(stepIdx, STEP_FIELD_RATCHETS, count);
+}
+
+/**
+ * @brief Set the trigger probability of a step.
+ * @param stepIdx Index of the step.
+ * @param percent Chance that the step plays when gated (0-100).
+ */
+void Sequencer::setStepProbability(uint8_t stepIdx, uint8_t percent) {
+    if (stepIdx >= stepLength) {
+        return;
+    }
+    if (percent > STEP_PROBABILITY_MAX) percent = STEP_PROBABILITY_MAX;
+    editField(stepIdx, STEP_FIELD_PROBABILITY, percent);
+}
+
+/**
+ * @brief Set the A:B condition of a step: it plays on pass a of every b.
+ * @param stepIdx Index of the step.
+ * @param a Pass within the cycle (1..b).
+ * @param b Cycle length (2..STEP_CONDITION_MAX_CYCLE); 0 or 1 plays every pass.
+ */
+void Sequencer::setStepCondition(uint8_t stepIdx, uint8_t a, uint8_t b) {
+    if (stepIdx >= stepLength) {
+        return;
+    }
+    editField(stepIdx, STEP_FIELD_CONDITION, stepCondition(a, b));
+}
+
+/**
+ * @brief Replace the gates with a Euclidean rhythm over the step length.
+ * @param pulses Number of hits (clamped to the step length).
+ * @param rotation Steps to rotate the rhythm to the right.
+ */
+void Sequencer::fillEuclidean(uint8_t pulses, uint8_t rotation) {
+    const uint16_t mask = euclideanMask(pulses, stepLength, rotation);
+    journal.beginGroup();
+    beginEdit();
+    for (uint8_t i = 0; i < stepLength; ++i) {
+        editField(i, STEP_FIELD_GATE, (mask >> i) & 1u);
+    }
+    endEdit();
+    journal.endGroup();
+}
+
 /**
  * @brief Set full step data using individual parameters.
  */
@@ -337,11 +553,15 @@ void Sequencer::setStep(int index, bool gate, bool slide, int note, float veloci
         // Serial.println("Sequencer::setStep: Filter value out of range (0.0f-1.0f).");
         return;
     }
-    state.steps[index].gate = gate;
-    state.steps[index].slide = slide;
-    state.steps[index].note = static_cast<uint8_t>(note);
-    state.steps[index].velocity = velocity;
-    state.steps[index].filter = filter;
+    journal.beginGroup();
+    beginEdit();
+    editField(index, STEP_FIELD_GATE, gate);
+    editField(index, STEP_FIELD_SLIDE, slide);
+    editField(index, STEP_FIELD_NOTE, static_cast<uint32_t>(note));
+    editField(index, STEP_FIELD_VELOCITY, floatToBits(velocity));
+    editField(index, STEP_FIELD_FILTER, floatToBits(filter));
+    endEdit();
+    journal.endGroup();
 }
 
 /**
@@ -364,7 +584,32 @@ void Sequencer::setStep(int index, const Step& stepData) {
         // Serial.println("Sequencer::setStep: Filter value in Step object out of range (0.0f-1.0f).");
         return;
     }
-    state.steps[index] = stepData;
+    if (stepData.microTiming < -MICRO_TIMING_MAX || stepData.microTiming > MICRO_TIMING_MAX) {
+        return;
+    }
+    if (stepData.gateLength < 1 || stepData.gateLength > SEQUENCER_TICKS_PER_STEP ||
+        stepData.ratchets < 1 || stepData.ratchets > MAX_RATCHETS) {
+        return;
+    }
+    if (stepData.probability > STEP_PROBABILITY_MAX ||
+        stepData.condition != stepCondition(conditionPass(stepData.condition),
+                                            conditionCycle(stepData.condition))) {
+        return;
+    }
+    journal.beginGroup();
+    beginEdit();
+    editField(index, STEP_FIELD_GATE, stepData.gate);
+    editField(index, STEP_FIELD_SLIDE, stepData.slide);
+    editField(index, STEP_FIELD_NOTE, static_cast<uint32_t>(stepData.note));
+    editField(index, STEP_FIELD_VELOCITY, floatToBits(stepData.velocity));
+    editField(index, STEP_FIELD_FILTER, floatToBits(stepData.filter));
+    editField(index, STEP_FIELD_MICRO_TIMING, static_cast<uint32_t>(static_cast<int32_t>(stepData.microTiming)));
+    editField(index, STEP_FIELD_GATE_LENGTH, stepData.gateLength);
+    editField(index, STEP_FIELD_RATCHETS, stepData.ratchets);
+    editField(index, STEP_FIELD_PROBABILITY, stepData.probability);
+    editField(index, STEP_FIELD_CONDITION, stepData.condition);
+    endEdit();
+    journal.endGroup();
 }
 
 /**
@@ -375,7 +620,7 @@ void Sequencer::setStep(int index, const Step& stepData) {
 const Step &Sequencer::getStep(uint8_t stepIdx) const {
     if (stepIdx >= stepLength)
         stepIdx = 0;
-    return state.steps[stepIdx];
+    return edit.steps[stepIdx];
 }
 
 /**
@@ -383,7 +628,7 @@ const Step &Sequencer::getStep(uint8_t stepIdx) const {
  * @return Playhead index.
  */
 uint8_t Sequencer::getPlayhead() const {
-    return state.playhead;
+    return play->playhead;
 }
 
 /**
@@ -391,14 +636,374 @@ uint8_t Sequencer::getPlayhead() const {
  * @return true if running, false otherwise.
  */
 bool Sequencer::isRunning() const {
-    return state.running;
+    return play->running;
 }
 int8_t Sequencer::getLastNote() const { return lastNote; }
 void Sequencer::setLastNote(int8_t note) { lastNote = note; }
 // Returns a const reference to the internal SequencerState.
 // This method is const-correct and does not allow modification of the internal state.
 const SequencerState& Sequencer::getState() const {
-    return state;
+    return *play;
+}
+
+/**
+ * @brief Get the latest published pattern snapshot (lock-free, for another core).
+ * The reference stays valid until the same reader calls getSnapshot() again.
+ */
+const SequencerState& Sequencer::getSnapshot() {
+    return snapshots.read();
+}
+
+/**
+ * @brief Copy finished edits into the playback pattern.
+ *
+ * Edits are fenced by a sequence counter (odd while an edit is in progress).
+ * The copy goes into the idle playback buffer and only becomes active if no
+ * edit overlapped it, so a torn copy is discarded and retried on the next
+ * step instead of being played.
+ * @return true if new edits were committed.
+ */
+bool Sequencer::commitEdits() {
+    // Until the editor follows a pattern switch, edit holds the old pattern
+    if (outgoingPattern.load(std::memory_order_acquire) >= 0) {
+        return false;
+    }
+    const uint32_t sequence = editSequence.load(std::memory_order_acquire);
+    if (sequence == committedSequence || (sequence & 1)) {
+        return false;
+    }
+
+    // The idle buffer is the one neither playing nor holding the prefetch
+    SequencerState* next = &playBuffers[0];
+    while (next == play || next == standby) {
+        next++;
+    }
+    *next = edit;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (editSequence.load(std::memory_order_relaxed) != sequence) {
+        return false;
+    }
+
+    // Playback position belongs to the clock, not to the editor
+    next->playhead = play->playhead;
+    next->running = play->running;
+    play = next;
+    committedSequence = sequence;
+    return true;
+}
+
+/**
+ * @brief Write one field of the edit copy and journal the change.
+ * Constant time, so it is safe inside the clock callback.
+ */
+void Sequencer::editField(uint8_t stepIdx, StepField field, uint32_t value) {
+    journal.record(stepIdx, field, readField(edit, stepIdx, field), value);
+    beginEdit();
+    writeField(edit, stepIdx, field, value);
+    endEdit();
+}
+
+/**
+ * @brief Select the pattern to edit and play.
+ * While running, the switch happens at the end of the current pass (any
+ * cued patterns are dropped); when stopped it happens immediately.
+ */
+void Sequencer::selectPattern(uint8_t pattern) {
+    if (pattern >= PATTERN_BANK_SIZE) {
+        return;
+    }
+    if (play->running) {
+        chain.clearCues();
+        chain.cue(pattern);
+    } else if (pattern != currentPattern) {
+        loadPattern(pattern);
+    }
+}
+
+/**
+ * @brief Save the edited pattern into a bank slot.
+ */
+void Sequencer::storePattern(uint8_t slot) {
+    if (slot >= PATTERN_BANK_SIZE) {
+        return;
+    }
+    finishPatternSwitch();
+    bank.store(slot, edit);
+    if (slot == standbyPattern) {
+        standbyPattern = -1; // Prefetched copy is stale
+    }
+}
+
+/**
+ * @brief Switch patterns immediately (sequencer stopped or starting).
+ */
+void Sequencer::loadPattern(uint8_t pattern) {
+    finishPatternSwitch();
+    bank.store(currentPattern, edit);
+    restorePattern(pattern);
+}
+
+/**
+ * @brief Make a bank slot the edited and playing pattern.
+ * Only the edit copy changes; the clock commits it at the next step, or
+ * update() does while stopped.
+ */
+void Sequencer::restorePattern(uint8_t pattern) {
+    if (pattern >= PATTERN_BANK_SIZE) {
+        return;
+    }
+    // Save the outgoing pattern of a pending switch before edit is replaced
+    finishPatternSwitch();
+    currentPattern = pattern;
+    standbyPattern = -1;
+    beginEdit();
+    decodePattern(bank.get(pattern), edit);
+    endEdit();
+    journal.clear();
+}
+
+void Sequencer::reloadPattern(uint8_t slot) {
+    if (slot == currentPattern) {
+        restorePattern(slot);
+    } else if (slot == standbyPattern) {
+        standbyPattern = -1;
+    }
+}
+
+/**
+ * @brief Decode the pattern that plays after this pass into the standby
+ * buffer. Called on the last step of a pass, one step ahead of the switch.
+ */
+void Sequencer::prefetchPattern() {
+    const uint8_t next = (deferredPattern >= 0) ? deferredPattern : chain.peek(currentPattern);
+    if (next == currentPattern || next == standbyPattern) {
+        return;
+    }
+    decodePattern(bank.get(next), *standby);
+    standbyPattern = next;
+}
+
+/**
+ * @brief Start the next pattern on a pass boundary.
+ *
+ * Every pass counts towards the song. If the editor has not followed the
+ * previous switch yet, the pattern that is due is held back and starts on
+ * the next boundary instead, without counting the extra pass.
+ * @return true if the playing pattern changed.
+ */
+bool Sequencer::switchPattern() {
+    const uint8_t next = (deferredPattern >= 0) ? static_cast<uint8_t>(deferredPattern)
+                                                : chain.advance(currentPattern);
+    if (outgoingPattern.load(std::memory_order_acquire) >= 0) {
+        deferredPattern = (next != currentPattern) ? next : -1;
+        return false;
+    }
+    deferredPattern = -1;
+    if (next == currentPattern) {
+        return false;
+    }
+    if (standbyPattern != next) {
+        decodePattern(bank.get(next), *standby); // Cued too late for the prefetch
+    }
+    standby->running = play->running;
+    SequencerState* previous = play;
+    play = standby;
+    standby = previous;
+    standbyPattern = -1;
+    const uint8_t previousPattern = currentPattern;
+    currentPattern = next;
+    outgoingPattern.store(previousPattern, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Follow a switch made by the clock (editing context): save the
+ * outgoing pattern, including edits that never got to play, and move the
+ * edit copy over to the new pattern. The new pattern is decoded from the
+ * bank, so the playing buffers are never read here.
+ */
+void Sequencer::finishPatternSwitch() {
+    const int8_t outgoing = outgoingPattern.load(std::memory_order_acquire);
+    if (outgoing < 0) {
+        return;
+    }
+    bank.store(outgoing, edit);
+
+    beginEdit();
+    decodePattern(bank.get(currentPattern), edit);
+    endEdit();
+
+    // Undo history belongs to the old pattern
+    journal.clear();
+    if (recordPassActive) {
+        journal.beginGroup();
+    }
+    outgoingPattern.store(-1, std::memory_order_release);
+}
+
+void Sequencer::update() {
+    finishPatternSwitch();
+
+    // The clock commits at step boundaries; while stopped there are none
+    if (!play->running && commitEdits()) {
+        publishSnapshot();
+    }
+}
+
+/**
+ * @brief Set the number of steps; motion lanes are re-sized and cleared.
+ */
+void Sequencer::setStepLength(uint8_t len) {
+    uint8_t newLength = (len > 0 && len <= SEQUENCER_NUM_STEPS) ? len : SEQUENCER_NUM_STEPS;
+    if (newLength == stepLength) {
+        return;
+    }
+    stepLength = newLength;
+
+    motionArena.reset();
+    for (uint8_t i = 0; i < motionLaneCount; ++i) {
+        motionLanes[i].attach(motionArena, stepLength);
+    }
+}
+
+/**
+ * @brief Start capturing the distance sensor into the lane of a destination.
+ * Recording overwrites the lane step by step while the sequencer runs.
+ * @param destination MotionDestination (MOTION_DEST_SYNTH_PARAM + param for synth parameters)
+ * @return false if no lane or arena space is left.
+ */
+bool Sequencer::armMotionRecord(uint8_t destination) {
+    if (destination >= MOTION_DEST_SYNTH_PARAM + SYNTH_PARAM_COUNT ||
+        (destination > MOTION_DEST_VELOCITY && destination < MOTION_DEST_SYNTH_PARAM)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < motionLaneCount; ++i) {
+        if (motionLanes[i].getDestination() == destination) {
+            motionRecordLane = i;
+            return true;
+        }
+    }
+    if (motionLaneCount >= MOTION_MAX_LANES) {
+        return false;
+    }
+    MotionLane& lane = motionLanes[motionLaneCount];
+    if (!lane.attach(motionArena, stepLength)) {
+        return false;
+    }
+    lane.setDestination(destination);
+    motionRecordLane = motionLaneCount++;
+    return true;
+}
+
+/**
+ * @brief Stop motion recording; the recorded lane starts playing back.
+ */
+void Sequencer::disarmMotionRecord() {
+    motionRecordLane = -1;
+}
+
+/**
+ * @brief Remove all motion lanes and return their memory to the arena.
+ */
+void Sequencer::clearMotion() {
+    motionRecordLane = -1;
+    for (uint8_t i = 0; i < motionLaneCount; ++i) {
+        motionLanes[i].detach();
+    }
+    motionLaneCount = 0;
+    motionArena.reset();
+}
+
+/**
+ * @brief Advance motion recording/playback by one clock tick.
+ */
+void Sequencer::tickMotion() {
+    tickMotionWith(io);
+}
+
+/**
+ * @brief Lock a synth parameter on one step.
+ * @param stepIdx Index of the step.
+ * @param param Destination parameter.
+ * @param value Value in the parameter's units (see SYNTH_PARAM_RANGES).
+ */
+void Sequencer::setParamLock(uint8_t stepIdx, SynthParam param, float value) {
+    if (stepIdx >= stepLength || param >= SYNTH_PARAM_COUNT) {
+        return;
+    }
+    if (edit.paramLocks.get(stepIdx, param) == PARAM_LOCK_NONE &&
+        edit.paramLocks.getCount() >= PARAM_LOCK_CAPACITY) {
+        return; // Track full; keep the journal consistent with the pattern
+    }
+    editField(stepIdx, static_cast<StepField>(STEP_FIELD_PARAM_LOCK + param), synthParamToRaw(param, value));
+}
+
+/**
+ * @brief Remove a parameter lock from one step.
+ */
+void Sequencer::clearParamLock(uint8_t stepIdx, SynthParam param) {
+    if (stepIdx >= stepLength || param >= SYNTH_PARAM_COUNT) {
+        return;
+    }
+    editField(stepIdx, static_cast<StepField>(STEP_FIELD_PARAM_LOCK + param), PARAM_LOCK_NONE);
+}
+
+/**
+ * @brief Set the value a parameter returns to on steps without a lock.
+ */
+void Sequencer::setParamBase(SynthParam param, float value) {
+    if (param >= SYNTH_PARAM_COUNT) {
+        return;
+    }
+    const uint16_t raw = synthParamToRaw(param, value);
+    editField(0, static_cast<StepField>(STEP_FIELD_PARAM_BASE + param), raw);
+
+    // Heard right away unless a lock currently holds the parameter
+    if (io && !(activeLockMask & (1u << param))) {
+        io->setSynthParam(param, synthParamFromRaw(param, raw));
+    }
+}
+
+void Sequencer::setTranspose(int8_t semitones) {
+    if (semitones > TRANSPOSE_MAX) semitones = TRANSPOSE_MAX;
+    if (semitones < -TRANSPOSE_MAX) semitones = -TRANSPOSE_MAX;
+    transpose = semitones;
+}
+
+/**
+ * @brief Undo the last edit (or the last whole record pass / setStep call).
+ * @return false if there is nothing to undo.
+ */
+bool Sequencer::undo() {
+    auto restore = [this](uint8_t stepIdx, uint8_t field, uint32_t value) {
+        writeField(edit, stepIdx, static_cast<StepField>(field), value);
+    };
+    beginEdit();
+    bool undone = journal.undo(restore);
+    endEdit();
+    return undone;
+}
+
+/**
+ * @brief Redo the last undone edit group.
+ * @return false if there is nothing to redo.
+ */
+bool Sequencer::redo() {
+    auto reapply = [this](uint8_t stepIdx, uint8_t field, uint32_t value) {
+        writeField(edit, stepIdx, static_cast<StepField>(field), value);
+    };
+    beginEdit();
+    bool redone = journal.redo(reapply);
+    endEdit();
+    return redone;
+}
+
+/**
+ * @brief Publish the playback pattern for lock-free readers.
+ */
+void Sequencer::publishSnapshot() {
+    snapshots.writeBuffer() = *play;
+    snapshots.publish();
 }
 
 
@@ -408,38 +1013,23 @@ const SequencerState& Sequencer::getState() const {
  * @brief Start a monophonic note with a specified duration (in ticks).
  * @param note MIDI note number to play.
  * @param duration Number of ticks the note should last.
+ * @param ratchets Number of hits within one step (1-MAX_RATCHETS).
  */
-void Sequencer::startNote(uint8_t note,float velocity, uint16_t duration) {
-    currentNote = note;
-    noteDurationCounter = duration;
-    // Send NoteOn via I/O interface
-    if (io) {
-        io->sendNoteOn(currentNote, velocity*127, 1);
-    }
+void Sequencer::startNote(uint8_t note, float velocity, uint8_t duration, uint8_t ratchets) {
+    startNoteWith(io, note, velocity, duration, ratchets);
 }
 
 /**
- * @brief Decrement the note duration counter. If zero, sends NoteOff and clears state.
+ * @brief Advance the note scheduler by one tick (sends due NoteOff/NoteOn).
  */
 void Sequencer::tickNoteDuration() {
-    if (currentNote >= 0 && noteDurationCounter > 0) {
-        --noteDurationCounter;
-        if (noteDurationCounter == 0) {
-            handleNoteOff();
-            releaseEnvelope();
-        }
-    }
+    tickNoteDurationWith(io);
 }
 
 /**
- * @brief Sends NoteOff for the current note and clears the active note state.
+ * @brief Sends NoteOff for all scheduled notes and clears them.
+ * The envelope is left alone; the caller decides whether to retrigger it.
  */
 void Sequencer::handleNoteOff() {
-    if (currentNote >= 0) {
-        if (io) {
-            io->sendNoteOff(currentNote, 0, 1);
-        }
-        currentNote = -1;
-        noteDurationCounter = 0;
-    }
+    releaseNotesWith(io);
 }
@@ -26,13 +26,38 @@
  *       const Step& stepData = seq.getStep(beat);
  *       // Use stepData.gate, stepData.note, stepData.velocity, stepData.filter
  *   }
+ *
+ *   // In the editing context's loop
+ *   seq.update();
+ *
+ *   // On the other core (LEDs, display): lock-free, never half-written
+ *   const SequencerState& view = seq.getSnapshot();
+ *
+ * Edits (setStep*, toggleStep, live recording) go to a shadow copy and are
+ * committed to the playing pattern at the next step boundary. Edits must
+ * come from a single context; playback runs in the clock context. While
+ * stopped there are no step boundaries, so update() commits instead.
+ *
+ * Patterns switch when the playhead wraps. The next pattern is decoded from
+ * the bank into a standby buffer on the last step of the pass, so the
+ * switch is a pointer swap in the clock context. The editing context
+ * follows in update(): it writes the outgoing pattern's edits back to the
+ * bank and moves the shadow copy to the new pattern. Until then the clock
+ * commits no edits and defers further switches.
  */
 
 #ifndef SEQUENCER_H
 #define SEQUENCER_H
 
 #include "SequencerDefs.h"
+#include "NoteScheduler.h"
+#include "EditJournal.h"
+#include "MotionLane.h"
+#include "PatternBank.h"
+#include "PatternChain.h"
 #include "../interfaces/SequencerIO.h"
+#include "../state/SnapshotBuffer.h"
+#include <atomic>
 
 #define SEQUENCER_NUM_STEPS 16
 
@@ -46,7 +71,8 @@ public:
 
   // Step length (number of steps in the sequence, user-adjustable, max 16)
   uint8_t getStepLength() const { return stepLength; }
-  void setStepLength(uint8_t len) { stepLength = (len > 0 && len <= SEQUENCER_NUM_STEPS) ? len : SEQUENCER_NUM_STEPS; }
+  // Changing the length re-sizes (and clears) motion lanes
+  void setStepLength(uint8_t len);
 
   // Instantly play a step for real-time feedback (does not advance playhead)
   void playStepNow(uint8_t stepIdx);
@@ -58,6 +84,13 @@ public:
   void stop();
   void reset();
 
+  /**
+   * @brief Editor-side housekeeping: follow a pattern switch made by the
+   * clock, and commit and publish edits while stopped. Call on every pass
+   * of the loop that makes the edits, never from the clock callbacks.
+   */
+  void update();
+
   /**
    * @brief Processes the sequencer logic for the given step.
    * @param current_uclock_step The current step number (0-15) provided by uClock.
@@ -87,20 +120,119 @@ public:
   void setStepNote(uint8_t stepIdx, uint8_t note);
   void setStepVelocity(uint8_t stepIdx, uint8_t velocity);
   void setStepFiltFreq(uint8_t stepIdx, float filter);
+  void setStepGateLength(uint8_t stepIdx, uint8_t ticks);
+  void setStepRatchets(uint8_t stepIdx, uint8_t count);
   
+  // Timing: swing applies to odd (off-beat) steps, micro-timing to single steps
+  void setSwing(uint8_t percent);
+  uint8_t getSwing() const { return edit.swing; }
+  void setStepMicroTiming(uint8_t stepIdx, int8_t ticks);
+
+  /**
+   * @brief Get the timing offset of a step relative to the grid.
+   * @param stepIdx Step index (wrapped to the step length)
+   * @return Offset in ticks at 96 PPQN (swing + micro-timing)
+   */
+  int8_t getStepTickOffset(uint8_t stepIdx) const;
+
   // Set full step data (overloads)
   void setStep(int index, bool gate, bool slide, int note, float velocity, float filter);
   void setStep(int index, const Step& stepData);
 
-  // Query step and playhead state
+  // Generative playback: a gated step plays if its A:B condition matches the
+  // current pattern pass and its probability roll succeeds
+  void setStepProbability(uint8_t stepIdx, uint8_t percent);
+  void setStepCondition(uint8_t stepIdx, uint8_t a, uint8_t b);
+
+  /**
+   * @brief Replace the gates with a Euclidean rhythm over the step length.
+   * Undoes as one edit.
+   */
+  void fillEuclidean(uint8_t pulses, uint8_t rotation);
+
+  // Probability rolls restart from this seed on every start(), so a pattern
+  // plays back identically each time
+  void setRandomSeed(uint32_t seed) { randomSeed = seed; }
+  uint32_t getRandomSeed() const { return randomSeed; }
+
+  // Completed pattern passes since start (drives A:B conditions)
+  uint32_t getPatternCycle() const { return patternCycle; }
+
+  // Patterns: the edited pattern lives in a bank slot; while running,
+  // selectPattern() switches at the end of the current pass
+  void selectPattern(uint8_t pattern);
+  bool cuePattern(uint8_t pattern) { return chain.cue(pattern); }
+  uint8_t getCurrentPattern() const { return currentPattern; }
+  // Write the edited pattern to another slot (copy)
+  void storePattern(uint8_t slot);
+  // Reload a pattern from the bank, discarding unsaved edits (after the bank
+  // was restored from storage); it plays from the next step, or after the
+  // next update() while stopped
+  void restorePattern(uint8_t pattern);
+  // A bank slot was overwritten from outside (import): reload it if it is
+  // playing, otherwise drop a prefetched copy
+  void reloadPattern(uint8_t slot);
+  PatternBank& getPatternBank() { return bank; }
+  // Song mode and cue queue configuration
+  PatternChain& getChain() { return chain; }
+
+  // Parameter locks: per-step values for synth parameters (envelope, glide,
+  // resonance, drive); steps without a lock use the pattern's base value
+  void setParamLock(uint8_t stepIdx, SynthParam param, float value);
+  void clearParamLock(uint8_t stepIdx, SynthParam param);
+  void setParamBase(SynthParam param, float value);
+
+  // Live transpose in semitones, applied to every note played (not stored
+  // with the pattern); clamped to +/-TRANSPOSE_MAX
+  void setTranspose(int8_t semitones);
+  int8_t getTranspose() const { return transpose; }
+
+  // Group a run of edits (e.g. a controller sweep) into one undo step;
+  // repeated writes to a field inside the group use one journal entry
+  void beginEditGroup() { journal.beginGroup(); }
+  void endEditGroup() { journal.endGroup(); }
+
+  // Motion recording: the distance sensor is captured every 96 PPQN tick
+  // into a lane per destination and played back on later passes
+  bool armMotionRecord(uint8_t destination);
+  void disarmMotionRecord();
+  bool isMotionRecording() const { return motionRecordLane >= 0; }
+  void clearMotion();
+
+  /**
+   * @brief Record/play motion lanes for the current tick. Call on every
+   * clock tick after tickNoteDuration(). O(lanes).
+   */
+  void tickMotion();
+
+  // Edit history: single edits, setStep() calls and whole live-recording
+  // passes (record button held) undo as one unit
+  bool undo();
+  bool redo();
+  bool canUndo() const { return journal.canUndo(); }
+  bool canRedo() const { return journal.canRedo(); }
+
+  // Query step and playhead state (getStep() returns the edited, possibly
+  // not yet committed, step)
   const Step &getStep(uint8_t stepIdx) const;
   uint8_t getPlayhead() const;
   bool isRunning() const;
+
+  // Re-validate the playing pattern; false (and the error flag set) if it
+  // is inconsistent
+  bool checkState();
+  bool hasError() const { return errorFlag; }
   
   int8_t getLastNote() const;
   void setLastNote(int8_t note);
 
+  // Playing pattern (clock context only)
   const SequencerState& getState() const;
+
+  // Latest published pattern for a reader on another core; valid until that
+  // reader calls getSnapshot() again
+  const SequencerState& getSnapshot();
+  void setOscillatorFrequency(uint8_t midiNote);
   void triggerEnvelope();
   void releaseEnvelope();
 
@@ -109,19 +241,33 @@ public:
    * @brief Start a monophonic note with a specified duration (in ticks).
    * @param note MIDI note number to play.
    * @param duration Number of ticks the note should last.
+   * @param ratchets Number of hits spread evenly over one step (1 = plain note).
    */
-  void startNote(uint8_t note, float velocity, uint16_t duration);
+  void startNote(uint8_t note, float velocity, uint8_t duration, uint8_t ratchets = 1);
 
   /**
-   * @brief Decrement the note duration counter. If zero, sends NoteOff and clears state.
+   * @brief Advance the note scheduler by one tick, sending due NoteOff/NoteOn.
+   * Cost is O(active notes).
    */
   void tickNoteDuration();
 
   /**
-   * @brief Sends NoteOff for the current note and clears the active note state.
+   * @brief Sends NoteOff for all scheduled notes and clears them.
    */
   void handleNoteOff();
 
+protected:
+  // Playback path, generic over the I/O type and defined in BasicSequencer.h.
+  // The entry points above instantiate it with SequencerIO (virtual calls);
+  // BasicSequencer<IO> instantiates it with a concrete, final I/O class so
+  // every call on the step and tick path is direct and can be inlined.
+  template <typename IO> void advanceStepWith(IO* typedIo, uint8_t current_uclock_step);
+  template <typename IO> void tickNoteDurationWith(IO* typedIo);
+  template <typename IO> void tickMotionWith(IO* typedIo);
+  template <typename IO> void startNoteWith(IO* typedIo, uint8_t note, float velocity,
+                                            uint8_t duration, uint8_t ratchets);
+  template <typename IO> void releaseNotesWith(IO* typedIo);
+
 private:
   // I/O interface for hardware abstraction
   SequencerIO* io = nullptr;
@@ -130,20 +276,108 @@ private:
   void resetState();
   void initializeSteps();
   bool validateState() const;
-  SequencerState state;
   bool errorFlag = false;
 
+  // Pattern storage: the clock plays *play, edits go to the shadow copy and
+  // are committed at step boundaries; readers on other cores use snapshots.
+  // The third buffer holds the prefetched next pattern.
+  SequencerState playBuffers[3];
+  SequencerState* play = &playBuffers[0];
+  SequencerState* standby = &playBuffers[1];
+  SequencerState edit;
+  std::atomic<uint32_t> editSequence{0}; // Odd while an edit is in progress
+  uint32_t committedSequence = 0;
+  uint8_t editDepth = 0;                 // Nested edits commit as one
+  SnapshotBuffer<SequencerState> snapshots;
+
+  void beginEdit() {
+    if (editDepth++ > 0) return;
+    editSequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void endEdit() {
+    if (editDepth == 0 || --editDepth > 0) return;
+    editSequence.fetch_add(1, std::memory_order_release);
+  }
+  bool commitEdits();
+  void publishSnapshot();
+
+  // Pattern bank and chaining
+  PatternBank bank;
+  PatternChain chain;
+  uint8_t currentPattern = 0;
+  int8_t standbyPattern = -1;   // Pattern decoded into *standby, -1 if none
+  int8_t deferredPattern = -1;  // Due, but held back by a pending switch
+  // Switched away from by the clock, -1 once the editor has followed
+  std::atomic<int8_t> outgoingPattern{-1};
+  void prefetchPattern();
+  bool switchPattern();
+  void finishPatternSwitch();
+  void loadPattern(uint8_t pattern);
+
+  // Edit history
+  EditJournal journal;
+  bool recordPassActive = false;
+  void editField(uint8_t stepIdx, StepField field, uint32_t value);
+
   /**
    * @brief Tracks the last played MIDI note for proper noteOff handling.
    * Stores the actual MIDI note value sent. -1 means no note is currently playing.
    */
   int8_t lastNote = -1;
+  int8_t transpose = 0;
+
+  // Previous step was a gated slide step (its note ties into the next one)
+  bool slideActive = false;
+
+  // Generative state: one roll per step keeps playback reproducible
+  Xorshift32 rng;
+  uint32_t randomSeed = XORSHIFT_DEFAULT_SEED;
+  uint32_t patternCycle = 0;
+  bool firstStep = true; // Next step is the first after start()
+  bool stepTriggers(const Step& step);
+
+  // Motion lanes, carved from a fixed arena sized by the step length
+  MotionArena motionArena;
+  MotionLane motionLanes[MOTION_MAX_LANES];
+  uint8_t motionLaneCount = 0;
+  int8_t motionRecordLane = -1;
+  uint8_t stepTick = 0; // Ticks since the current step started
+  template <typename IO> void processMotionTick(IO* typedIo, uint8_t tick);
+  template <typename IO> void applyMotion(IO* typedIo, uint8_t destination, uint8_t value);
+
+  // Parameters currently held at a locked value (bit per SynthParam)
+  uint16_t activeLockMask = 0;
+  template <typename IO> void applyParamLocks(IO* typedIo, uint8_t stepIdx);
   
   uint8_t stepLength = SEQUENCER_NUM_STEPS; // Default 16, user-adjustable
 
-  // Monophonic note duration tracking variables
-  int8_t currentNote = -1;           // -1 means no note is currently active
-  uint16_t noteDurationCounter = 0;  // Remaining duration in ticks
+  // Note gate/ratchet scheduling
+  NoteScheduler notes;
+
+  // Routes scheduler events to the I/O interface
+  template <typename IO>
+  struct NoteOutput {
+    IO* io;
+    bool releaseEnvelope;        // Release the envelope when a note ends
+    bool triggerEnvelope = true; // Retrigger it when a note starts (not on ties)
+    void onNoteOn(uint8_t note, uint8_t velocity) {
+      if (io) {
+        io->sendNoteOn(note, velocity, SEQUENCER_MIDI_TRACK);
+        if (triggerEnvelope) {
+          io->triggerEnvelope();
+        }
+      }
+    }
+    void onNoteOff(uint8_t note) {
+      if (io) {
+        io->sendNoteOff(note, 0, SEQUENCER_MIDI_TRACK);
+        if (releaseEnvelope) {
+          io->releaseEnvelope();
+        }
+      }
+    }
+  };
 };
 
 #endif // SEQUENCER_H
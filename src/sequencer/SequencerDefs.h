@@ -24,20 +24,119 @@
 #define SEQUENCER_DEFS_H
 
 #include <stdint.h>
+#include "ParamLocks.h"
+#include "Generative.h"
 
 // Number of steps per sequencer (fixed at 16 for this project)
 constexpr uint8_t SEQUENCER_NUM_STEPS = 16;
 
-// Size of the global 'scale' array defined in the main .ino file
-constexpr uint8_t SCALE_ARRAY_SIZE = 40;
+// MIDI note of scale degree 0 before transposition (C1)
+constexpr uint8_t MIDI_BASE_NOTE = 36;
+
+// MIDI output track of the sequencer's notes (routed to ports/channel by the I/O)
+constexpr uint8_t SEQUENCER_MIDI_TRACK = 0;
+
+// Live transpose range in semitones (+/-)
+constexpr int8_t TRANSPOSE_MAX = 36;
+
+// Clock ticks per step (16th note at 96 PPQN)
+constexpr uint8_t SEQUENCER_TICKS_PER_STEP = 24;
+
+// Per-step micro-timing range in ticks (+/-), kept under half a step
+constexpr int8_t MICRO_TIMING_MAX = SEQUENCER_TICKS_PER_STEP / 2 - 1;
+
+// Default gate length in ticks (50% of a step, like the TB-303)
+constexpr uint8_t DEFAULT_GATE_TICKS = SEQUENCER_TICKS_PER_STEP / 2;
+
+// Gate length of a slide step: long enough to reach the next step even with
+// swing and micro-timing; the next step always cuts or ties it
+constexpr uint8_t SLIDE_GATE_TICKS = 3 * SEQUENCER_TICKS_PER_STEP;
+
+// Maximum ratchet count (retriggers within one step)
+constexpr uint8_t MAX_RATCHETS = 8;
+
+// Trigger probability of a step in percent (100 = always)
+constexpr uint8_t STEP_PROBABILITY_MAX = 100;
+
+// Swing range in percent (50 = straight, 66 = triplet feel)
+constexpr uint8_t SWING_MIN = 50;
+constexpr uint8_t SWING_MAX = 75;
+
+// Editable pattern fields, as recorded by the edit journal
+enum StepField : uint8_t {
+  STEP_FIELD_GATE = 0,
+  STEP_FIELD_SLIDE,
+  STEP_FIELD_NOTE,
+  STEP_FIELD_VELOCITY,     // Stored as float bits
+  STEP_FIELD_FILTER,       // Stored as float bits
+  STEP_FIELD_MICRO_TIMING,
+  STEP_FIELD_GATE_LENGTH,
+  STEP_FIELD_RATCHETS,
+  STEP_FIELD_SWING,        // Pattern-wide, step index ignored
+  STEP_FIELD_PROBABILITY,
+  STEP_FIELD_CONDITION,
+  STEP_FIELD_COUNT,
+
+  // Parameter locks: field = base + SynthParam
+  STEP_FIELD_PARAM_LOCK = 0x10, // Raw lock value or PARAM_LOCK_NONE
+  STEP_FIELD_PARAM_BASE = 0x20  // Pattern-wide raw base value
+};
+
+// Distance sensor range used by all live and motion recording (hand height)
+constexpr int SENSOR_MIN_MM = 50;
+constexpr int SENSOR_MAX_MM = 400;
+
+// Filter range written by live and motion recording (Hz)
+constexpr float RECORD_FILTER_MIN_HZ = 200.0f;
+constexpr float RECORD_FILTER_MAX_HZ = 2000.0f;
+
+// Semitones spanned by the sensor when recording notes
+constexpr int RECORD_NOTE_RANGE = 24;
+
+/**
+ * @brief Map a distance reading to 0-255 over the sensor's hand range.
+ * Every recording path uses this one mapping.
+ */
+inline uint8_t sensorToUnit(int mm) {
+  if (mm <= SENSOR_MIN_MM) return 0;
+  if (mm >= SENSOR_MAX_MM) return 255;
+  return static_cast<uint8_t>(((mm - SENSOR_MIN_MM) * 255) / (SENSOR_MAX_MM - SENSOR_MIN_MM));
+}
+
+inline int unitToSemitone(uint8_t unit) {
+  return (unit * RECORD_NOTE_RANGE + 127) / 255;
+}
+
+inline float unitToVelocity(uint8_t unit) {
+  return unit / 255.0f;
+}
+
+inline float unitToFilterHz(uint8_t unit) {
+  return RECORD_FILTER_MIN_HZ + (RECORD_FILTER_MAX_HZ - RECORD_FILTER_MIN_HZ) * (unit / 255.0f);
+}
+
+// Motion recording destinations
+enum MotionDestination : uint8_t {
+  MOTION_DEST_FILTER = 0,
+  MOTION_DEST_VELOCITY,
+  MOTION_DEST_SYNTH_PARAM = 0x10 // + SynthParam
+};
+
+// Number of motion lanes (destinations recorded at once)
+constexpr uint8_t MOTION_MAX_LANES = 4;
 
 // Represents a single step in the sequencer
 struct Step {
  bool gate = false;      // Gate ON (true) or OFF (false)
   bool slide = false;     // Slide ON (true) or OFF (false)
-  int note = 0;           // Note value, 0-24
+  int note = 0;           // Scale degree, 0-24 (see Quantizer)
   float velocity = 0.5f;  // Velocity, 0.0f - 1.0f (normalized)
   float filter = 0.5f;    // Filter value, 0.0f - 1.0f (normalized)
+  int8_t microTiming = 0; // Timing offset in ticks at 96 PPQN (+/-MICRO_TIMING_MAX)
+  uint8_t gateLength = DEFAULT_GATE_TICKS; // Gate time in ticks, 1-SEQUENCER_TICKS_PER_STEP
+  uint8_t ratchets = 1;   // Hits within the step, 1-MAX_RATCHETS
+  uint8_t probability = STEP_PROBABILITY_MAX; // Trigger chance in percent
+  uint8_t condition = STEP_CONDITION_ALWAYS;  // A:B pass condition, see stepCondition()
 
   // Default constructor initializes to sensible defaults
   Step() = default;
@@ -55,7 +154,9 @@ struct SequencerState {
   Step steps[SEQUENCER_NUM_STEPS];
   Playhead playhead; // Current step index
   bool running;      // Is the sequencer running?
-  SequencerState() : playhead(0), running(false) {}
+  uint8_t swing;     // Swing amount in percent (SWING_MIN-SWING_MAX)
+  ParamLockTrack<SEQUENCER_NUM_STEPS> paramLocks; // Per-step parameter locks
+  SequencerState() : playhead(0), running(false), swing(SWING_MIN) {}
 };
 
 #endif // SEQUENCER_DEFS_H
\ No newline at end of file
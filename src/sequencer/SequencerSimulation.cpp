@@ -0,0 +1,47 @@
+/**
+ * @file SequencerSimulation.cpp
+ * @brief Simulated-time run loop and benchmark figures.
+ */
+
+#include "SequencerSimulation.h"
+
+SequencerSimulation::SequencerSimulation(Quantizer& quantizer)
+    : io(time, quantizer), sequencer(&io) {
+    sequencer.init();
+}
+
+void SequencerSimulation::begin(float bpm) {
+    clock.stop();
+    sequencer.stop();
+    io.clear();
+    steps = 0;
+
+    clock.setBPM(bpm);
+    time.sync(clock);
+    clock.start();
+    sequencer.start();
+}
+
+SimulationResult SequencerSimulation::runBars(uint32_t bars, WallClockFunction wallClock) {
+    SimulationResult result;
+    Listener listener{*this};
+    const uint32_t firstStep = steps;
+    const uint32_t firstEvent = io.getEventCount();
+    const uint32_t started = wallClock ? wallClock() : 0;
+
+    for (uint32_t bar = 0; bar < bars; bar++) {
+        result.ticks += time.runTicks(clock, listener, CLOCK_STEPS_PER_BAR * CLOCK_TICKS_PER_STEP);
+        sequencer.update(); // Editor side of pattern switches, as in the sketch loop
+        if (!sequencer.checkState()) {
+            result.valid = false;
+        }
+    }
+
+    if (wallClock) {
+        result.elapsedMicros = wallClock() - started;
+    }
+    result.steps = steps - firstStep;
+    result.events = io.getEventCount() - firstEvent;
+    result.digest = io.getDigest();
+    return result;
+}
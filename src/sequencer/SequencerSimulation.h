@@ -0,0 +1,121 @@
+/**
+ * @file SequencerSimulation.h
+ * @brief Deterministic end-to-end run of the Sequencer on simulated time
+ *
+ * Wires a Sequencer to a RecordingSequencerIO and drives it from a
+ * ClockManager on a SimulatedClock, with the same per-tick and per-step
+ * calls as the sketch's clock listener. A run of any length gives the same
+ * event stream (and digest) every time, so it can be checked against a
+ * golden file or digest, and the pattern's invariants are re-validated
+ * after every bar.
+ *
+ * With a wall clock function, runBars() also measures how long the
+ * sequencer core took, which makes the same run a throughput benchmark
+ * (steps per second). setDispatch() selects whether the clock calls go
+ * through the virtual SequencerIO path or the BasicSequencer direct path,
+ * so the two can be compared; both produce the same event stream.
+ *
+ * Example:
+ *   static SequencerSimulation sim(quantizer);
+ *   sim.begin(120.0f);
+ *   SimulationResult result = sim.runBars(1000, micros);
+ *   if (!result.valid || result.digest != GOLDEN_DIGEST) { ... }
+ *   Serial.println(result.stepsPerSecond());
+ */
+
+#ifndef SEQUENCER_SIMULATION_H
+#define SEQUENCER_SIMULATION_H
+
+#include <stdint.h>
+#include "BasicSequencer.h"
+#include "../clock/ClockManager.h"
+#include "../clock/SimulatedClock.h"
+#include "../interfaces/RecordingSequencerIO.h"
+
+// Real time in microseconds, for benchmarking (e.g. micros)
+typedef uint32_t (*WallClockFunction)();
+
+// How the clock listener reaches the sequencer's I/O
+enum SimulationDispatch : uint8_t {
+    SIM_DISPATCH_VIRTUAL = 0, // Sequencer entry points, SequencerIO virtual calls
+    SIM_DISPATCH_DIRECT       // BasicSequencer<RecordingSequencerIO>, direct calls
+};
+
+struct SimulationResult {
+    uint32_t ticks = 0;
+    uint32_t steps = 0;
+    uint32_t events = 0;        // Recorded by the IO during the run
+    uint32_t digest = 0;        // Digest of all events since begin()
+    uint32_t elapsedMicros = 0; // Wall time, 0 without a wall clock
+    bool valid = true;          // Pattern invariants held after every bar
+
+    float stepsPerSecond() const {
+        return elapsedMicros ? steps * 1000000.0f / elapsedMicros : 0.0f;
+    }
+};
+
+class SequencerSimulation {
+public:
+    explicit SequencerSimulation(Quantizer& quantizer);
+
+    /**
+     * @brief Clear the recording and start the clock and sequencer. The
+     * pattern is left as set up (init() defaults after construction).
+     * Simulated time keeps running across begin() calls, so for identical
+     * timestamps compare fresh simulations.
+     */
+    void begin(float bpm);
+
+    /**
+     * @brief Run whole bars. O(bars * ticks per bar).
+     * @param wallClock Optional real-time source for the benchmark figures
+     */
+    SimulationResult runBars(uint32_t bars, WallClockFunction wallClock = nullptr);
+
+    void setDispatch(SimulationDispatch mode) { dispatch = mode; }
+    SimulationDispatch getDispatch() const { return dispatch; }
+
+    Sequencer& getSequencer() { return sequencer; }
+    RecordingSequencerIO& getIO() { return io; }
+    ClockManager& getClock() { return clock; }
+    const SimulatedClock& getTime() const { return time; }
+
+private:
+    // Same calls as the sketch's SequencerClockListener
+    struct Listener {
+        SequencerSimulation& sim;
+        void onClockTick() {
+            if (sim.dispatch == SIM_DISPATCH_DIRECT) {
+                sim.sequencer.tickNoteDuration();
+                sim.sequencer.tickMotion();
+            } else {
+                Sequencer& base = sim.sequencer;
+                base.tickNoteDuration();
+                base.tickMotion();
+            }
+        }
+        void onClockStep(uint8_t step) {
+            if (sim.dispatch == SIM_DISPATCH_DIRECT) {
+                sim.sequencer.advanceStep(step);
+            } else {
+                static_cast<Sequencer&>(sim.sequencer).advanceStep(step);
+            }
+            sim.sequencer.recordLiveParameters(
+                sim.io.getDistanceMM(), sim.io.isButton16Held(), sim.io.isButton17Held(),
+                sim.io.isButton18Held(), sim.io.getSelectedStepForEdit());
+            sim.steps++;
+        }
+        int8_t getStepOffset(uint8_t step) {
+            return sim.sequencer.getStepTickOffset(step);
+        }
+    };
+
+    SimulatedClock time;
+    RecordingSequencerIO io;
+    ClockManager clock;
+    BasicSequencer<RecordingSequencerIO> sequencer;
+    SimulationDispatch dispatch = SIM_DISPATCH_DIRECT;
+    uint32_t steps = 0;
+};
+
+#endif // SEQUENCER_SIMULATION_H
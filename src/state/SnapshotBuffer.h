@@ -0,0 +1,74 @@
+/**
+ * @file SnapshotBuffer.h
+ * @brief Lock-free triple buffer for publishing state snapshots between cores
+ *
+ * One writer publishes complete copies of a value; one reader picks up the
+ * latest published copy. Three slots rotate through the roles "being
+ * written", "latest published" and "being read", and the only shared
+ * variable is one atomic byte holding the published slot index plus a
+ * "fresh" flag. Neither side ever waits, and the reader can never observe a
+ * partially written value.
+ *
+ * Example:
+ *   SnapshotBuffer<SequencerState> snapshots;
+ *   // Writer (clock context)
+ *   snapshots.writeBuffer() = state;
+ *   snapshots.publish();
+ *   // Reader (UI context); valid until the reader's next read()
+ *   const SequencerState& view = snapshots.read();
+ */
+
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() {}
+
+    /**
+     * @brief Slot owned by the writer; fill it completely before publish()
+     */
+    T& writeBuffer() { return slots[writeIndex]; }
+
+    /**
+     * @brief Make the write buffer the latest snapshot (writer side)
+     */
+    void publish() {
+        uint8_t previous = published.exchange(writeIndex | FRESH_FLAG, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    /**
+     * @brief Get the latest published snapshot (reader side)
+     * @return Reference that stays valid and unchanged until the next read()
+     */
+    const T& read() {
+        if (published.load(std::memory_order_relaxed) & FRESH_FLAG) {
+            uint8_t previous = published.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+        }
+        return slots[readIndex];
+    }
+
+    /**
+     * @brief Check whether a snapshot newer than the last read() is available
+     */
+    bool hasUpdate() const {
+        return (published.load(std::memory_order_relaxed) & FRESH_FLAG) != 0;
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH_FLAG = 0x04;
+
+    T slots[3];
+    uint8_t writeIndex = 0;                 // Writer-owned slot
+    uint8_t readIndex = 1;                  // Reader-owned slot
+    std::atomic<uint8_t> published{2};      // Latest slot | FRESH_FLAG
+};
+
+#endif // SNAPSHOT_BUFFER_H
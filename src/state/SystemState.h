@@ -11,6 +11,8 @@
 
 #include <stdint.h>
 #include <atomic>
+#include "../quantizer/Quantizer.h"
+#include "../audio/SynthParams.h"
 
 /**
  * @brief Thread-safe system state container
@@ -24,10 +26,18 @@ public:
     std::atomic<int> note1{0};
     std::atomic<float> freq1{440.0f};
     std::atomic<float> vel1{0.5f};
+    std::atomic<bool> slide1{false};     // Glide into note1 (303-style slide)
+    std::atomic<int> pitchBend{0};       // -8192 to 8191, centre 0
     
-    // Envelope state
+    // Synth parameters (parameter-lock targets), bumped version on change
+    std::atomic<float> synthParams[SYNTH_PARAM_COUNT];
+    std::atomic<uint32_t> synthParamVersion{0};
+    
+    // Envelope state. trigenv1 is the gate level; env1Triggers counts
+    // triggers, so a retrigger is seen even if the gate never reads low
     std::atomic<bool> trigenv1{false};
     std::atomic<bool> trigenv2{false};
+    std::atomic<uint32_t> env1Triggers{0};
     
     // UI state
     std::atomic<int> selectedStepForEdit{-1};
@@ -38,8 +48,8 @@ public:
     std::atomic<bool> button17Held{false};
     std::atomic<bool> button18Held{false};
     
-    // Scale data (not atomic as it's read-only after initialization)
-    int scale[5][48];
+    // Scale quantizer (tables are published atomically on change)
+    Quantizer quantizer;
     
     // Singleton access
     static SystemState& getInstance() {
@@ -57,9 +67,31 @@ public:
     void setVel1(float vel) { vel1.store(vel); }
     float getVel1() const { return vel1.load(); }
     
+    void setSlide1(bool slide) { slide1.store(slide); }
+    bool getSlide1() const { return slide1.load(); }
+    
+    void setPitchBend(int bend) { pitchBend.store(bend); }
+    int getPitchBend() const { return pitchBend.load(); }
+    
+    // Synth parameter setters/getters (values in parameter units)
+    void setSynthParam(uint8_t param, float value) {
+        if (param >= SYNTH_PARAM_COUNT) return;
+        synthParams[param].store(value);
+        synthParamVersion.fetch_add(1);
+    }
+    float getSynthParam(uint8_t param) const { return synthParams[param].load(); }
+    uint32_t getSynthParamVersion() const { return synthParamVersion.load(); }
+    
     // Envelope state setters/getters
     void setTrigEnv1(bool trig) { trigenv1.store(trig); }
     bool getTrigEnv1() const { return trigenv1.load(); }
+
+    // Raise the gate and start a new attack (read the count before the gate)
+    void triggerEnv1() {
+        trigenv1.store(true);
+        env1Triggers.fetch_add(1);
+    }
+    uint32_t getEnv1TriggerCount() const { return env1Triggers.load(); }
     
     void setTrigEnv2(bool trig) { trigenv2.store(trig); }
     bool getTrigEnv2() const { return trigenv2.load(); }
@@ -82,26 +114,14 @@ public:
     bool getButton18Held() const { return button18Held.load(); }
     
     // Scale access
-    int getScaleNote(int scaleIndex, int noteIndex) const {
-        if (scaleIndex >= 0 && scaleIndex < 5 && noteIndex >= 0 && noteIndex < 48) {
-            return scale[scaleIndex][noteIndex];
-        }
-        return 0;
-    }
-    
-    void setScaleNote(int scaleIndex, int noteIndex, int value) {
-        if (scaleIndex >= 0 && scaleIndex < 5 && noteIndex >= 0 && noteIndex < 48) {
-            scale[scaleIndex][noteIndex] = value;
-        }
-    }
+    Quantizer& getQuantizer() { return quantizer; }
+    int getScaleNote(int noteIndex) const { return quantizer.getNote(noteIndex); }
+    int getNearestScaleDegree(int semitone) const { return quantizer.getNearestDegree(semitone); }
 
 private:
     SystemState() {
-        // Initialize scale array to default values
-        for (int i = 0; i < 5; i++) {
-            for (int j = 0; j < 48; j++) {
-                scale[i][j] = j; // Default chromatic scale
-            }
+        for (uint8_t i = 0; i < SYNTH_PARAM_COUNT; i++) {
+            synthParams[i].store(SYNTH_PARAM_RANGES[i].defaultValue);
         }
     }
     
@@ -0,0 +1,45 @@
+/**
+ * @file Crc32.h
+ * @brief CRC-32 (IEEE 802.3, as used by zlib) with a 16-entry nibble table
+ *
+ * The nibble table keeps the footprint at 64 bytes while checking a 432-byte
+ * pattern in well under a millisecond on the RP2040.
+ *
+ * Example:
+ *   uint32_t crc = crc32(data, length);
+ *   // Incremental
+ *   uint32_t c = CRC32_INIT;
+ *   c = crc32Update(c, part1, len1);
+ *   c = crc32Update(c, part2, len2);
+ *   crc = c ^ CRC32_INIT;
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint32_t CRC32_INIT = 0xFFFFFFFFUL;
+
+inline uint32_t crc32Update(uint32_t crc, const void* data, size_t length) {
+    static const uint32_t NIBBLE_TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+    }
+    return crc;
+}
+
+inline uint32_t crc32(const void* data, size_t length) {
+    return crc32Update(CRC32_INIT, data, length) ^ CRC32_INIT;
+}
+
+#endif // CRC32_H
@@ -0,0 +1,40 @@
+/**
+ * @file FlashDevice.h
+ * @brief Abstract NOR flash region used by the persistent store
+ *
+ * Addresses are relative to the start of the region. Like real NOR flash,
+ * programming can only clear bits, so a page must be erased (all 0xFF)
+ * before it is written. PicoFlash drives the RP2040/RP2350 QSPI flash;
+ * RamFlash simulates it on the host.
+ */
+
+#ifndef FLASH_DEVICE_H
+#define FLASH_DEVICE_H
+
+#include <stdint.h>
+
+// Smallest programmable unit
+constexpr uint16_t STORE_PAGE_SIZE = 256;
+
+// Smallest erasable unit
+constexpr uint16_t STORE_SECTOR_SIZE = 4096;
+
+constexpr uint8_t STORE_PAGES_PER_SECTOR = STORE_SECTOR_SIZE / STORE_PAGE_SIZE;
+
+class FlashDevice {
+public:
+    virtual ~FlashDevice() {}
+
+    virtual uint8_t getSectorCount() const = 0;
+
+    virtual void read(uint32_t address, void* data, uint32_t length) = 0;
+
+    /**
+     * @brief Program one page (STORE_PAGE_SIZE bytes, page aligned)
+     */
+    virtual void programPage(uint32_t address, const uint8_t* data) = 0;
+
+    virtual void eraseSector(uint8_t sector) = 0;
+};
+
+#endif // FLASH_DEVICE_H
@@ -0,0 +1,432 @@
+/**
+ * @file LogStore.cpp
+ * @brief Log-structured flash store: mount scan, appends and reclamation.
+ */
+
+#include "LogStore.h"
+#include "Crc32.h"
+#include <string.h>
+
+static const uint32_t SECTOR_MAGIC = 0x56433250UL; // "P2CV"
+static const uint16_t RECORD_MAGIC = 0x5EC0;
+static const uint8_t RECORD_FLAG_COMMIT = 0x01;
+
+struct SectorHeader {
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t reserved;
+    uint32_t crc;
+};
+
+static_assert(sizeof(SectorHeader) == 16, "SectorHeader layout changed");
+
+// Header bytes covered by the record CRC (everything before the CRC)
+static const uint8_t RECORD_CRC_OFFSET = 12;
+
+LogStore::LogStore(FlashDevice& flash) : flash(flash) {
+    for (uint8_t k = 0; k < STORE_MAX_KEYS; k++) {
+        index[k] = Location{0, 0, 0};
+        transactionLocations[k] = Location{0, 0, 0};
+    }
+    for (uint8_t s = 0; s < STORE_MAX_SECTORS; s++) {
+        states[s] = SECTOR_DIRTY;
+        generations[s] = 0;
+    }
+}
+
+bool LogStore::mount() {
+    static_assert(sizeof(RecordHeader) == STORE_RECORD_HEADER_SIZE, "RecordHeader layout changed");
+
+    mounted = false;
+    staged = false;
+    relocating = false;
+    transaction = 0;
+    transactionMask = 0;
+    for (uint8_t k = 0; k < STORE_MAX_KEYS; k++) {
+        index[k].length = 0;
+    }
+
+    sectorCount = flash.getSectorCount();
+    if (sectorCount > STORE_MAX_SECTORS) sectorCount = STORE_MAX_SECTORS;
+    if (sectorCount < 3) return false;
+
+    uint8_t usedCount = 0;
+    uint32_t newest = 0;
+    for (uint8_t s = 0; s < sectorCount; s++) {
+        uint32_t generation;
+        if (readSectorHeader(s, generation)) {
+            states[s] = SECTOR_USED;
+            generations[s] = generation;
+            usedCount++;
+            if (generation > newest) {
+                newest = generation;
+                head = s;
+            }
+        } else {
+            states[s] = isSectorErased(s) ? SECTOR_ERASED : SECTOR_DIRTY;
+            generations[s] = 0;
+        }
+    }
+    if (usedCount == 0) {
+        format();
+        return true;
+    }
+    nextGeneration = newest + 1;
+
+    // Replay the log oldest sector first, so newer records win
+    uint32_t previous = 0;
+    for (uint8_t n = 0; n < usedCount; n++) {
+        uint8_t next = 0;
+        uint32_t lowest = 0xFFFFFFFFUL;
+        for (uint8_t s = 0; s < sectorCount; s++) {
+            if (states[s] == SECTOR_USED && generations[s] > previous && generations[s] < lowest) {
+                lowest = generations[s];
+                next = s;
+            }
+        }
+        scanSector(next);
+        previous = lowest;
+    }
+
+    // An uncommitted transaction at the end of the log is dropped
+    transaction = 0;
+    transactionMask = 0;
+    mounted = true;
+
+    // Power was lost before the last reclamation finished
+    bool spare = false;
+    for (uint8_t s = 0; s < sectorCount; s++) {
+        if (states[s] != SECTOR_USED) spare = true;
+    }
+    if (!spare) {
+        startRelocation();
+    }
+    return true;
+}
+
+void LogStore::format() {
+    for (uint8_t s = 0; s < sectorCount; s++) {
+        flash.eraseSector(s);
+        states[s] = SECTOR_ERASED;
+        generations[s] = 0;
+    }
+    for (uint8_t k = 0; k < STORE_MAX_KEYS; k++) {
+        index[k].length = 0;
+    }
+    staged = false;
+    relocating = false;
+    transaction = 0;
+    transactionMask = 0;
+    nextGeneration = 1;
+    openSector(0);
+    mounted = true;
+}
+
+uint16_t LogStore::getLength(uint8_t key) const {
+    return key < STORE_MAX_KEYS ? index[key].length : 0;
+}
+
+bool LogStore::read(uint8_t key, void* data, uint16_t length) {
+    if (!mounted || key >= STORE_MAX_KEYS || length == 0 || index[key].length != length) {
+        return false;
+    }
+    flash.read(addressOf(index[key].sector, index[key].page) + STORE_RECORD_HEADER_SIZE, data, length);
+    return true;
+}
+
+bool LogStore::write(uint8_t key, const void* data, uint16_t length, bool commit) {
+    if (!canWrite() || key >= STORE_MAX_KEYS || length > STORE_MAX_PAYLOAD) {
+        return false;
+    }
+    if (transaction == 0) {
+        transaction = nextTransaction++;
+        if (nextTransaction == 0) nextTransaction = 1; // 0 marks standalone records
+    }
+
+    RecordHeader header;
+    header.magic = RECORD_MAGIC;
+    header.key = key;
+    header.flags = commit ? RECORD_FLAG_COMMIT : 0;
+    header.length = length;
+    header.transaction = transaction;
+    header.sequence = nextSequence++;
+    uint32_t crc = crc32Update(CRC32_INIT, &header, RECORD_CRC_OFFSET);
+    header.crc = crc32Update(crc, data, length) ^ CRC32_INIT;
+
+    memset(stagedData, 0xFF, sizeof(stagedData));
+    memcpy(stagedData, &header, sizeof(header));
+    memcpy(stagedData + STORE_RECORD_HEADER_SIZE, data, length);
+    stagedKey = key;
+    stagedCommit = commit;
+    stagedPages = pagesFor(length);
+    stagedWritten = 0;
+    stagedLocation.length = length; // Zero length deletes the key
+    stagedPlaced = false;
+    staged = true;
+    return true;
+}
+
+bool LogStore::needsErase() const {
+    for (uint8_t s = 0; s < sectorCount; s++) {
+        if (states[s] == SECTOR_DIRTY) return true;
+    }
+    return false;
+}
+
+void LogStore::service(bool eraseAllowed) {
+    if (!mounted) return;
+
+    // Reclamation first: it must finish before the head can take new records
+    if (relocating) {
+        relocateStep();
+        return;
+    }
+    if (eraseAllowed) {
+        for (uint8_t s = 0; s < sectorCount; s++) {
+            if (states[s] == SECTOR_DIRTY) {
+                flash.eraseSector(s);
+                states[s] = SECTOR_ERASED;
+                generations[s] = 0;
+                sectorsErased++;
+                return;
+            }
+        }
+    }
+    if (staged) {
+        programStagedPage();
+    }
+}
+
+// --- Mount helpers ---
+
+bool LogStore::readSectorHeader(uint8_t sector, uint32_t& generation) {
+    SectorHeader header;
+    flash.read(addressOf(sector, 0), &header, sizeof(header));
+    if (header.magic != SECTOR_MAGIC ||
+        header.crc != crc32(&header, sizeof(header) - sizeof(header.crc)) ||
+        header.generation == 0) {
+        return false;
+    }
+    generation = header.generation;
+    return true;
+}
+
+bool LogStore::isSectorErased(uint8_t sector) {
+    for (uint8_t page = 0; page < STORE_PAGES_PER_SECTOR; page++) {
+        flash.read(addressOf(sector, page), pageBuffer, STORE_PAGE_SIZE);
+        for (uint16_t i = 0; i < STORE_PAGE_SIZE; i++) {
+            if (pageBuffer[i] != 0xFF) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Replay the records of one sector into the index.
+ * A header that cannot be parsed ends the sector (its tail is never reused).
+ */
+void LogStore::scanSector(uint8_t sector) {
+    uint8_t page = 1;
+    while (page < STORE_PAGES_PER_SECTOR) {
+        RecordHeader header;
+        flash.read(addressOf(sector, page), &header, sizeof(header));
+
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&header);
+        bool erased = true;
+        for (uint8_t i = 0; i < sizeof(header); i++) {
+            if (raw[i] != 0xFF) erased = false;
+        }
+        if (erased) break;
+
+        if (header.magic != RECORD_MAGIC || header.key >= STORE_MAX_KEYS ||
+            header.length > STORE_MAX_PAYLOAD ||
+            page + pagesFor(header.length) > STORE_PAGES_PER_SECTOR) {
+            page = STORE_PAGES_PER_SECTOR;
+            break;
+        }
+
+        if (recordCrc(header, sector, page) == header.crc) {
+            if (header.sequence >= nextSequence) nextSequence = header.sequence + 1;
+            const Location location = {sector, page, header.length};
+            if (header.transaction == 0) {
+                index[header.key] = location;
+            } else {
+                nextTransaction = header.transaction + 1;
+                if (nextTransaction == 0) nextTransaction = 1;
+                if (header.transaction != transaction) {
+                    transaction = header.transaction; // Previous one never committed
+                    transactionMask = 0;
+                }
+                transactionLocations[header.key] = location;
+                transactionMask |= 1UL << header.key;
+                if (header.flags & RECORD_FLAG_COMMIT) {
+                    applyTransaction(transactionLocations, transactionMask);
+                    transactionMask = 0;
+                    transaction = 0;
+                }
+            }
+        }
+        page += pagesFor(header.length);
+    }
+    if (sector == head) {
+        headPage = page;
+    }
+}
+
+uint32_t LogStore::recordCrc(const RecordHeader& header, uint8_t sector, uint8_t page) {
+    uint32_t crc = crc32Update(CRC32_INIT, &header, RECORD_CRC_OFFSET);
+    uint32_t address = addressOf(sector, page) + STORE_RECORD_HEADER_SIZE;
+    uint16_t remaining = header.length;
+    uint8_t chunk[32];
+    while (remaining > 0) {
+        const uint16_t n = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        flash.read(address, chunk, n);
+        crc = crc32Update(crc, chunk, n);
+        address += n;
+        remaining -= n;
+    }
+    return crc ^ CRC32_INIT;
+}
+
+void LogStore::applyTransaction(Location* locations, uint32_t mask) {
+    for (uint8_t k = 0; k < STORE_MAX_KEYS; k++) {
+        if (mask & (1UL << k)) index[k] = locations[k];
+    }
+}
+
+// --- Appending ---
+
+/**
+ * @brief Find room for a record in the head sector.
+ * @return true if location was assigned; false if this call opened a new
+ *         sector (one flash operation) or the log is full.
+ */
+bool LogStore::reserve(uint8_t pages, Location& location) {
+    if (headPage + pages <= STORE_PAGES_PER_SECTOR) {
+        location.sector = head;
+        location.page = headPage;
+        headPage += pages;
+        return true;
+    }
+
+    // Continue in ring order, so every sector sees the same number of erases
+    for (uint8_t i = 1; i < sectorCount; i++) {
+        const uint8_t sector = (head + i) % sectorCount;
+        if (states[sector] == SECTOR_ERASED) {
+            openSector(sector);
+            bool spare = false;
+            for (uint8_t s = 0; s < sectorCount; s++) {
+                if (states[s] == SECTOR_ERASED) spare = true;
+            }
+            if (!spare) {
+                startRelocation(); // Refill the reserve
+            }
+            return false;
+        }
+    }
+    return false; // Full until a dirty sector is erased
+}
+
+void LogStore::openSector(uint8_t sector) {
+    SectorHeader header;
+    header.magic = SECTOR_MAGIC;
+    header.generation = nextGeneration++;
+    header.reserved = 0xFFFFFFFFUL;
+    header.crc = crc32(&header, sizeof(header) - sizeof(header.crc));
+
+    memset(pageBuffer, 0xFF, sizeof(pageBuffer));
+    memcpy(pageBuffer, &header, sizeof(header));
+    flash.programPage(addressOf(sector, 0), pageBuffer);
+
+    states[sector] = SECTOR_USED;
+    generations[sector] = header.generation;
+    head = sector;
+    headPage = 1;
+}
+
+void LogStore::programStagedPage() {
+    if (!stagedPlaced) {
+        if (!reserve(stagedPages, stagedLocation)) {
+            return;
+        }
+        stagedPlaced = true;
+    }
+
+    flash.programPage(addressOf(stagedLocation.sector, stagedLocation.page + stagedWritten),
+                      stagedData + stagedWritten * STORE_PAGE_SIZE);
+    if (++stagedWritten < stagedPages) {
+        return;
+    }
+
+    transactionLocations[stagedKey] = stagedLocation;
+    transactionMask |= 1UL << stagedKey;
+    if (stagedCommit) {
+        applyTransaction(transactionLocations, transactionMask);
+        transactionMask = 0;
+        transaction = 0;
+    }
+    staged = false;
+    recordsWritten++;
+}
+
+// --- Space reclamation ---
+
+void LogStore::startRelocation() {
+    uint32_t oldest = 0xFFFFFFFFUL;
+    for (uint8_t s = 0; s < sectorCount; s++) {
+        if (s != head && states[s] == SECTOR_USED && generations[s] < oldest) {
+            oldest = generations[s];
+            victim = s;
+        }
+    }
+    if (oldest == 0xFFFFFFFFUL) return;
+    relocating = true;
+    relocateKey = 0;
+    relocatePage = 0;
+}
+
+/**
+ * @brief Copy one page of the victim's live records to the head.
+ * Copies are standalone committed records, so they survive on their own.
+ */
+void LogStore::relocateStep() {
+    if (relocatePage == 0) {
+        while (relocateKey < STORE_MAX_KEYS &&
+               !(index[relocateKey].length > 0 && index[relocateKey].sector == victim)) {
+            relocateKey++;
+        }
+        if (relocateKey >= STORE_MAX_KEYS) {
+            relocating = false;
+            states[victim] = SECTOR_DIRTY; // Nothing live left
+            return;
+        }
+        const Location& source = index[relocateKey];
+        const uint8_t pages = pagesFor(source.length);
+        if (headPage + pages > STORE_PAGES_PER_SECTOR) {
+            relocating = false; // Cannot happen with one reserve sector
+            return;
+        }
+        relocateTarget = Location{head, headPage, source.length};
+        headPage += pages;
+
+        RecordHeader header;
+        flash.read(addressOf(source.sector, source.page), pageBuffer, STORE_PAGE_SIZE);
+        memcpy(&header, pageBuffer, sizeof(header));
+        header.flags = RECORD_FLAG_COMMIT;
+        header.transaction = 0;
+        header.sequence = nextSequence++;
+        header.crc = recordCrc(header, source.sector, source.page);
+        memcpy(pageBuffer, &header, sizeof(header));
+    } else {
+        const Location& source = index[relocateKey];
+        flash.read(addressOf(source.sector, source.page + relocatePage), pageBuffer, STORE_PAGE_SIZE);
+    }
+
+    flash.programPage(addressOf(relocateTarget.sector, relocateTarget.page + relocatePage), pageBuffer);
+    if (++relocatePage == pagesFor(relocateTarget.length)) {
+        index[relocateKey] = relocateTarget;
+        relocateKey++;
+        relocatePage = 0;
+        recordsWritten++;
+    }
+}
@@ -0,0 +1,186 @@
+/**
+ * @file LogStore.h
+ * @brief Log-structured, wear-levelled key/value store for a flash region
+ *
+ * Records are only ever appended. A record holds one key's new value plus a
+ * 16-byte header (key, length, transaction id, sequence number, CRC-32);
+ * the newest committed record of a key wins. Sectors are filled in a ring,
+ * so every sector is erased equally often.
+ *
+ * Crash safety:
+ * - A record whose CRC does not match (torn write) is ignored on mount.
+ * - Records are written in transactions; the last record carries a commit
+ *   flag. Records of a transaction without a commit record are ignored on
+ *   mount, so a set of keys is updated atomically or not at all.
+ *
+ * Space is reclaimed one sector at a time: when the last erased sector is
+ * opened, the live records of the oldest sector are copied forward and
+ * the sector is erased. One erased sector is always kept in reserve, so
+ * the copy never runs out of room.
+ *
+ * Nothing blocks except mount() and format(). service() performs at most one
+ * flash operation per call (one page program, or one sector erase only when
+ * the caller allows it), so the caller controls how long the other core is
+ * held off the flash.
+ *
+ * Example:
+ *   LogStore store(flash);
+ *   store.mount();                                   // In setup()
+ *   if (store.canWrite()) store.write(KEY, &value, sizeof(value), true);
+ *   store.service(eraseAllowed);                     // In loop()
+ *   store.read(KEY, &value, sizeof(value));
+ */
+
+#ifndef LOG_STORE_H
+#define LOG_STORE_H
+
+#include <stdint.h>
+#include "FlashDevice.h"
+
+// Keys are 0 to STORE_MAX_KEYS-1
+constexpr uint8_t STORE_MAX_KEYS = 32;
+
+// Maximum sectors managed (region size up to 64KB)
+constexpr uint8_t STORE_MAX_SECTORS = 16;
+
+// Record size limit, header included (two pages)
+constexpr uint16_t STORE_RECORD_HEADER_SIZE = 16;
+constexpr uint16_t STORE_MAX_RECORD_SIZE = 2 * STORE_PAGE_SIZE;
+constexpr uint16_t STORE_MAX_PAYLOAD = STORE_MAX_RECORD_SIZE - STORE_RECORD_HEADER_SIZE;
+
+class LogStore {
+public:
+    explicit LogStore(FlashDevice& flash);
+
+    /**
+     * @brief Scan the region and rebuild the index (blocking).
+     * An empty or unrecognisable region is formatted.
+     * @return false if the region is too small (fewer than 3 sectors).
+     */
+    bool mount();
+
+    /**
+     * @brief Erase the whole region (blocking).
+     */
+    void format();
+
+    // Stored payload length of a key, 0 if absent
+    uint16_t getLength(uint8_t key) const;
+
+    /**
+     * @brief Read the newest committed value of a key.
+     * @return false if the key is absent or its length differs.
+     */
+    bool read(uint8_t key, void* data, uint16_t length);
+
+    // A record can be handed over with write()
+    bool canWrite() const { return mounted && !staged; }
+
+    /**
+     * @brief Queue one record of the current transaction (data is copied).
+     * @param commit Last record of the transaction
+     * @return false if busy with the previous record or the arguments are invalid.
+     */
+    bool write(uint8_t key, const void* data, uint16_t length, bool commit);
+
+    // Records or space reclamation still in flight
+    bool isBusy() const { return staged || relocating; }
+
+    // Sectors waiting for an erase (see service())
+    bool needsErase() const;
+
+    /**
+     * @brief Perform at most one flash operation.
+     * @param eraseAllowed Sector erases stall the flash for tens of
+     *        milliseconds; they only run when this is true (e.g. while the
+     *        transport is stopped). Writes wait if the log is full.
+     */
+    void service(bool eraseAllowed);
+
+    uint32_t getRecordsWritten() const { return recordsWritten; }
+    uint32_t getSectorsErased() const { return sectorsErased; }
+
+private:
+    enum SectorState : uint8_t {
+        SECTOR_ERASED = 0,  // Ready to open
+        SECTOR_DIRTY,       // Needs an erase before use
+        SECTOR_USED         // Holds records
+    };
+
+    struct Location {
+        uint8_t sector;
+        uint8_t page;
+        uint16_t length; // 0 = absent
+    };
+
+    struct RecordHeader {
+        uint16_t magic;
+        uint8_t key;
+        uint8_t flags;
+        uint16_t length;
+        uint16_t transaction;
+        uint32_t sequence;
+        uint32_t crc;      // Over the first 12 header bytes and the payload
+    };
+
+    static uint8_t pagesFor(uint16_t length) {
+        return static_cast<uint8_t>((STORE_RECORD_HEADER_SIZE + length + STORE_PAGE_SIZE - 1) / STORE_PAGE_SIZE);
+    }
+    static uint32_t addressOf(uint8_t sector, uint8_t page) {
+        return static_cast<uint32_t>(sector) * STORE_SECTOR_SIZE + static_cast<uint32_t>(page) * STORE_PAGE_SIZE;
+    }
+
+    bool readSectorHeader(uint8_t sector, uint32_t& generation);
+    bool isSectorErased(uint8_t sector);
+    void scanSector(uint8_t sector);
+    uint32_t recordCrc(const RecordHeader& header, uint8_t sector, uint8_t page);
+    void applyTransaction(Location* locations, uint32_t mask);
+
+    bool reserve(uint8_t pages, Location& location);
+    void openSector(uint8_t sector);
+    void startRelocation();
+    void relocateStep();
+    void programStagedPage();
+
+    FlashDevice& flash;
+    uint8_t sectorCount = 0;
+    bool mounted = false;
+
+    SectorState states[STORE_MAX_SECTORS];
+    uint32_t generations[STORE_MAX_SECTORS];
+    Location index[STORE_MAX_KEYS];
+
+    uint8_t head = 0;       // Sector being appended to
+    uint8_t headPage = 0;   // Next free page in it
+    uint32_t nextGeneration = 1;
+    uint32_t nextSequence = 1;
+    uint16_t nextTransaction = 1;
+
+    // Transaction being written; applied to the index on commit
+    uint16_t transaction = 0;
+    uint32_t transactionMask = 0;
+    Location transactionLocations[STORE_MAX_KEYS];
+
+    // Record being written
+    bool staged = false;
+    uint8_t stagedKey = 0;
+    bool stagedCommit = false;
+    uint8_t stagedPages = 0;
+    uint8_t stagedWritten = 0;
+    bool stagedPlaced = false;
+    Location stagedLocation = {0, 0, 0};
+    uint8_t stagedData[STORE_MAX_RECORD_SIZE];
+
+    // Space reclamation: live records of the victim are copied forward
+    bool relocating = false;
+    uint8_t victim = 0;
+    uint8_t relocateKey = 0;
+    uint8_t relocatePage = 0;
+    Location relocateTarget = {0, 0, 0};
+    uint8_t pageBuffer[STORE_PAGE_SIZE];
+
+    uint32_t recordsWritten = 0;
+    uint32_t sectorsErased = 0;
+};
+
+#endif // LOG_STORE_H
@@ -0,0 +1,84 @@
+/**
+ * @file Persistence.cpp
+ * @brief Pattern and settings persistence on top of LogStore.
+ */
+
+#include "Persistence.h"
+#include <string.h>
+
+Persistence::Persistence(FlashDevice& flash, Sequencer& sequencer, Quantizer& quantizer)
+    : store(flash), sequencer(sequencer), quantizer(quantizer) {
+    memset(&saved, 0, sizeof(saved));
+    memset(&current, 0, sizeof(current));
+}
+
+bool Persistence::begin() {
+    if (!store.mount()) {
+        return false;
+    }
+
+    PersistedSettings settings;
+    if (!store.read(STORE_KEY_SETTINGS, &settings, sizeof(settings)) ||
+        !settingsCompatible(settings)) {
+        return false;
+    }
+
+    PatternBank& bank = sequencer.getPatternBank();
+    for (uint8_t slot = 0; slot < PATTERN_BANK_SIZE; slot++) {
+        // Slots never saved keep their empty pattern
+        store.read(STORE_KEY_PATTERN_BASE + slot, &bank.getSlot(slot), sizeof(PackedPattern));
+        bank.clearDirty(slot);
+    }
+
+    applySettings(sequencer, quantizer, settings);
+    sequencer.restorePattern(settings.currentPattern < PATTERN_BANK_SIZE ? settings.currentPattern : 0);
+    captureSettings(sequencer, quantizer, saved);
+    return true;
+}
+
+void Persistence::update(uint32_t nowMillis, bool eraseAllowed) {
+    if (!isSaving() && (saveRequested || nowMillis - lastCheck >= PERSIST_AUTOSAVE_MS)) {
+        lastCheck = nowMillis;
+        saveRequested = false;
+        startSave();
+    }
+    if ((pendingPatterns != 0 || pendingSettings) && store.canWrite()) {
+        writeNext();
+    }
+    store.service(eraseAllowed);
+}
+
+/**
+ * @brief Collect what changed since the last save.
+ */
+void Persistence::startSave() {
+    // Edits of the current pattern only reach the bank when stored
+    sequencer.storePattern(sequencer.getCurrentPattern());
+    pendingPatterns = sequencer.getPatternBank().getDirtyMask();
+
+    captureSettings(sequencer, quantizer, current);
+    pendingSettings = memcmp(&current, &saved, sizeof(current)) != 0;
+}
+
+/**
+ * @brief Hand the next changed key to the store; the last one commits.
+ * Each pattern is copied at the moment it is handed over, so a pattern
+ * edited during the save is simply saved again next time.
+ */
+void Persistence::writeNext() {
+    PatternBank& bank = sequencer.getPatternBank();
+    if (pendingPatterns != 0) {
+        uint8_t slot = 0;
+        while (!(pendingPatterns & (1u << slot))) {
+            slot++;
+        }
+        pendingPatterns &= ~(1u << slot);
+        const bool last = pendingPatterns == 0 && !pendingSettings;
+        store.write(STORE_KEY_PATTERN_BASE + slot, &bank.get(slot), sizeof(PackedPattern), last);
+        bank.clearDirty(slot);
+        return;
+    }
+    pendingSettings = false;
+    store.write(STORE_KEY_SETTINGS, &current, sizeof(current), true);
+    saved = current;
+}
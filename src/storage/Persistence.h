@@ -0,0 +1,87 @@
+/**
+ * @file Persistence.h
+ * @brief Saves patterns and settings to flash and restores them at boot
+ *
+ * Each pattern slot and the settings block is one LogStore key. Saving is
+ * incremental: only slots whose packed content changed (PatternBank dirty
+ * mask) and settings that differ from the last save are written, as one
+ * transaction, so after a power cut the store holds either the previous
+ * or the new state, never a mix.
+ *
+ * update() runs from the main loop. It checks for changes every
+ * PERSIST_AUTOSAVE_MS and then writes one flash page per call, so the
+ * audio core is only held off the flash for one page program (well under
+ * a millisecond) at a time. Sector erases only run while erases are
+ * allowed, normally while the transport is stopped.
+ *
+ * Example:
+ *   PicoFlash flash(PicoFlash::defaultOffset(), PERSIST_FLASH_SECTORS, pause, resume);
+ *   Persistence persistence(flash, sequencer, quantizer);
+ *   if (!persistence.begin()) { ... seed factory defaults ... }
+ *   // loop()
+ *   persistence.update(millis(), !sequencer.isRunning());
+ */
+
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include <stdint.h>
+#include "LogStore.h"
+#include "Settings.h"
+
+// Store keys: settings, then one key per pattern slot
+constexpr uint8_t STORE_KEY_SETTINGS = 0;
+constexpr uint8_t STORE_KEY_PATTERN_BASE = 0x10;
+
+// How often the loop looks for unsaved changes
+constexpr uint32_t PERSIST_AUTOSAVE_MS = 2000;
+
+static_assert(STORE_KEY_PATTERN_BASE + PATTERN_BANK_SIZE <= STORE_MAX_KEYS, "Too many store keys");
+static_assert(sizeof(PackedPattern) <= STORE_MAX_PAYLOAD, "Pattern does not fit a record");
+
+class Persistence {
+public:
+    Persistence(FlashDevice& flash, Sequencer& sequencer, Quantizer& quantizer);
+
+    /**
+     * @brief Mount the store and restore patterns and settings (blocking,
+     * call from setup()).
+     * @return false if nothing was stored (first boot or format change);
+     *         the caller then sets up its defaults.
+     */
+    bool begin();
+
+    /**
+     * @brief Check for changes now instead of waiting for the autosave.
+     */
+    void requestSave() { saveRequested = true; }
+
+    /**
+     * @brief Autosave and flash work; call from the main loop.
+     * @param nowMillis Current time in milliseconds
+     * @param eraseAllowed Sector erases may run (tens of ms flash stall)
+     */
+    void update(uint32_t nowMillis, bool eraseAllowed);
+
+    // Changes are waiting to be written or being written
+    bool isSaving() const { return pendingPatterns != 0 || pendingSettings || store.isBusy(); }
+
+    LogStore& getStore() { return store; }
+
+private:
+    void startSave();
+    void writeNext();
+
+    LogStore store;
+    Sequencer& sequencer;
+    Quantizer& quantizer;
+
+    PersistedSettings saved;    // Last settings written (or loaded)
+    PersistedSettings current;  // Settings being written
+    uint16_t pendingPatterns = 0;
+    bool pendingSettings = false;
+    bool saveRequested = false;
+    uint32_t lastCheck = 0;
+};
+
+#endif // PERSISTENCE_H
@@ -0,0 +1,49 @@
+/**
+ * @file PicoFlash.cpp
+ * @brief Flash access through the pico-sdk flash API.
+ */
+
+#include "PicoFlash.h"
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <string.h>
+#include <hardware/flash.h>
+#include <hardware/sync.h>
+
+PicoFlash::PicoFlash(uint32_t offset, uint8_t sectors,
+                     void (*pauseOtherCore)(), void (*resumeOtherCore)())
+    : offset(offset), sectors(sectors),
+      pauseOtherCore(pauseOtherCore), resumeOtherCore(resumeOtherCore) {}
+
+uint32_t PicoFlash::defaultOffset() {
+    return PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE -
+           static_cast<uint32_t>(PERSIST_FLASH_SECTORS) * FLASH_SECTOR_SIZE;
+}
+
+void PicoFlash::read(uint32_t address, void* data, uint32_t length) {
+    // Flash is memory mapped; the cache is flushed after every program/erase
+    memcpy(data, reinterpret_cast<const void*>(XIP_BASE + offset + address), length);
+}
+
+void PicoFlash::programPage(uint32_t address, const uint8_t* data) {
+    if (pauseOtherCore) pauseOtherCore();
+    uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_program(offset + address, data, FLASH_PAGE_SIZE);
+    restore_interrupts(interrupts);
+    if (resumeOtherCore) resumeOtherCore();
+}
+
+void PicoFlash::eraseSector(uint8_t sector) {
+    if (pauseOtherCore) pauseOtherCore();
+    uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_erase(offset + static_cast<uint32_t>(sector) * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    restore_interrupts(interrupts);
+    if (resumeOtherCore) resumeOtherCore();
+}
+
+static_assert(FLASH_PAGE_SIZE == STORE_PAGE_SIZE, "Flash page size mismatch");
+static_assert(FLASH_SECTOR_SIZE == STORE_SECTOR_SIZE, "Flash sector size mismatch");
+
+#endif // ARDUINO_ARCH_RP2040
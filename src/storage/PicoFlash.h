@@ -0,0 +1,53 @@
+/**
+ * @file PicoFlash.h
+ * @brief FlashDevice on the RP2040/RP2350 program flash
+ *
+ * Erasing or programming the QSPI flash takes it away from execute-in-place,
+ * so the other core must not run code from flash meanwhile. The caller
+ * passes two plain functions that park and release the other core (for
+ * example rp2040.idleOtherCore()/resumeOtherCore() with setup1()/loop1(),
+ * or multicore_lockout_start_blocking()/end_blocking() for a core started
+ * with multicore_launch_core1()). Interrupts are disabled for the duration
+ * of each operation.
+ *
+ * The region is placed at the top of flash, just below the sector used by
+ * the EEPROM library, so no filesystem may be configured in the board's
+ * Flash Size menu.
+ */
+
+#ifndef PICO_FLASH_H
+#define PICO_FLASH_H
+
+#include <stdint.h>
+#include "FlashDevice.h"
+
+// Sectors reserved for persistence (32KB)
+constexpr uint8_t PERSIST_FLASH_SECTORS = 8;
+
+class PicoFlash : public FlashDevice {
+public:
+    /**
+     * @param offset Start of the region from the start of flash (sector aligned)
+     * @param sectors Region size in sectors
+     * @param pauseOtherCore Parks the other core (may be nullptr)
+     * @param resumeOtherCore Releases it again (may be nullptr)
+     */
+    PicoFlash(uint32_t offset, uint8_t sectors,
+              void (*pauseOtherCore)(), void (*resumeOtherCore)());
+
+    // Default region: the PERSIST_FLASH_SECTORS below the EEPROM sector
+    static uint32_t defaultOffset();
+
+    uint8_t getSectorCount() const override { return sectors; }
+    void read(uint32_t address, void* data, uint32_t length) override;
+    void programPage(uint32_t address, const uint8_t* data) override;
+    void eraseSector(uint8_t sector) override;
+
+private:
+    uint32_t offset;
+    uint8_t sectors;
+    void (*pauseOtherCore)();
+    void (*resumeOtherCore)();
+};
+
+#endif // PICO_FLASH_H
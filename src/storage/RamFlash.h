@@ -0,0 +1,82 @@
+/**
+ * @file RamFlash.h
+ * @brief RAM-backed flash simulator for testing the store on the host
+ *
+ * Behaves like NOR flash: erase sets a sector to 0xFF and programming ANDs
+ * data into a page. A power cut can be simulated: after setPowerCut(n) the
+ * n-th following operation is only half done (half a page programmed, or a
+ * sector left half erased) and every later operation is ignored, until
+ * setPowerCut(0) "powers the device up" again.
+ *
+ * Example:
+ *   RamFlash<8> flash;
+ *   LogStore store(flash);
+ *   store.mount();
+ */
+
+#ifndef RAM_FLASH_H
+#define RAM_FLASH_H
+
+#include <string.h>
+#include "FlashDevice.h"
+
+template <uint8_t Sectors>
+class RamFlash : public FlashDevice {
+public:
+    RamFlash() {
+        memset(memory, 0xFF, sizeof(memory));
+        for (uint8_t i = 0; i < Sectors; i++) eraseCounts[i] = 0;
+    }
+
+    uint8_t getSectorCount() const override { return Sectors; }
+
+    void read(uint32_t address, void* data, uint32_t length) override {
+        memcpy(data, &memory[address], length);
+    }
+
+    void programPage(uint32_t address, const uint8_t* data) override {
+        uint16_t length = STORE_PAGE_SIZE;
+        if (!consumeOperation(length)) return;
+        for (uint16_t i = 0; i < length; i++) memory[address + i] &= data[i];
+        programCount++;
+    }
+
+    void eraseSector(uint8_t sector) override {
+        uint16_t length = STORE_SECTOR_SIZE;
+        if (!consumeOperation(length)) return;
+        memset(&memory[sector * STORE_SECTOR_SIZE], 0xFF, length);
+        eraseCounts[sector]++;
+    }
+
+    /**
+     * @brief Interrupt the n-th next operation (0 restores power).
+     */
+    void setPowerCut(uint32_t operations) {
+        cutAfter = operations;
+        poweredOff = false;
+    }
+    bool isPoweredOff() const { return poweredOff; }
+
+    uint32_t getEraseCount(uint8_t sector) const { return eraseCounts[sector]; }
+    uint32_t getProgramCount() const { return programCount; }
+    uint8_t* data() { return memory; }
+
+private:
+    // Returns false if the operation must be dropped; shortens a torn one
+    bool consumeOperation(uint16_t& length) {
+        if (poweredOff) return false;
+        if (cutAfter > 0 && --cutAfter == 0) {
+            poweredOff = true;
+            length /= 2;
+        }
+        return true;
+    }
+
+    uint8_t memory[Sectors * STORE_SECTOR_SIZE];
+    uint32_t eraseCounts[Sectors];
+    uint32_t programCount = 0;
+    uint32_t cutAfter = 0;
+    bool poweredOff = false;
+};
+
+#endif // RAM_FLASH_H
@@ -0,0 +1,47 @@
+/**
+ * @file Settings.cpp
+ * @brief Capture and apply of the settings block.
+ */
+
+#include "Settings.h"
+#include <string.h>
+
+void captureSettings(Sequencer& sequencer, Quantizer& quantizer, PersistedSettings& settings) {
+    memset(&settings, 0, sizeof(settings));
+    settings.version = PERSIST_SETTINGS_VERSION;
+    settings.patternFormat = PATTERN_FORMAT_VERSION;
+    settings.stepLength = sequencer.getStepLength();
+    settings.currentPattern = sequencer.getCurrentPattern();
+    settings.scale = quantizer.getScale();
+    settings.root = quantizer.getRoot();
+    settings.randomSeed = sequencer.getRandomSeed();
+    for (uint8_t i = 0; i < QUANTIZER_USER_SCALES; i++) {
+        settings.userScales[i] = quantizer.getScaleMask(static_cast<ScaleId>(SCALE_USER_1 + i));
+    }
+
+    PatternChain& chain = sequencer.getChain();
+    settings.songLength = chain.getLength();
+    settings.songMode = chain.isSongMode();
+    for (uint8_t i = 0; i < SONG_MAX_ENTRIES; i++) {
+        settings.song[i] = chain.getEntry(i);
+    }
+}
+
+void applySettings(Sequencer& sequencer, Quantizer& quantizer, const PersistedSettings& settings) {
+    sequencer.setStepLength(settings.stepLength);
+    sequencer.setRandomSeed(settings.randomSeed);
+    for (uint8_t i = 0; i < QUANTIZER_USER_SCALES; i++) {
+        quantizer.setUserScale(i, settings.userScales[i]);
+    }
+    if (settings.scale < SCALE_COUNT) {
+        quantizer.setScale(static_cast<ScaleId>(settings.scale));
+    }
+    quantizer.setRoot(settings.root);
+
+    PatternChain& chain = sequencer.getChain();
+    for (uint8_t i = 0; i < SONG_MAX_ENTRIES; i++) {
+        chain.setEntry(i, settings.song[i].pattern, settings.song[i].repeats);
+    }
+    chain.setLength(settings.songLength);
+    chain.setSongMode(settings.songMode != 0);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file Settings.h
+ * @brief Settings block shared by flash persistence and pattern dumps
+ *
+ * Everything that is not a pattern: step length, current pattern, scale
+ * and root, user scales, the song chain and the random seed. The block is
+ * stored as raw bytes, so any change of layout must bump
+ * PERSIST_SETTINGS_VERSION.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include "../sequencer/Sequencer.h"
+#include "../quantizer/Quantizer.h"
+
+// Bumped whenever PersistedSettings changes layout
+constexpr uint8_t PERSIST_SETTINGS_VERSION = 1;
+
+struct PersistedSettings {
+    uint8_t version;
+    uint8_t patternFormat;
+    uint8_t stepLength;
+    uint8_t currentPattern;
+    uint8_t scale;
+    uint8_t root;
+    uint8_t songLength;
+    uint8_t songMode;
+    uint32_t randomSeed;
+    uint16_t userScales[QUANTIZER_USER_SCALES];
+    SongEntry song[SONG_MAX_ENTRIES];
+};
+
+/**
+ * @brief Fill a settings block from the sequencer and quantizer
+ * (unused bytes are zeroed, so blocks can be compared with memcmp).
+ */
+void captureSettings(Sequencer& sequencer, Quantizer& quantizer, PersistedSettings& settings);
+
+/**
+ * @brief Apply a settings block; out-of-range values are ignored or
+ * clamped by the setters. The current pattern is not switched.
+ */
+void applySettings(Sequencer& sequencer, Quantizer& quantizer, const PersistedSettings& settings);
+
+/**
+ * @brief Check that a block was written by this firmware's layout
+ */
+inline bool settingsCompatible(const PersistedSettings& settings) {
+    return settings.version == PERSIST_SETTINGS_VERSION &&
+           settings.patternFormat == PATTERN_FORMAT_VERSION;
+}
+
+#endif // SETTINGS_H
@@ -0,0 +1,46 @@
+/**
+ * @file HostTest.h
+ * @brief Minimal check macros for the host test programs
+ *
+ * Each test is a plain program: CHECK() reports a failed condition with its
+ * location and keeps going, and main() returns hostTestResult(), so the
+ * Makefile stops on the first program that failed. Benchmarks time their
+ * runs with hostMicros().
+ *
+ * Example:
+ *   int main() {
+ *       CHECK(clock.getTickCount() == 96);
+ *       return hostTestResult("clock_drift_test");
+ *   }
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+static int hostTestFailures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            hostTestFailures++;                                                 \
+        }                                                                       \
+    } while (0)
+
+static inline int hostTestResult(const char* name) {
+    printf("%s: %s\n", name, hostTestFailures ? "FAILED" : "passed");
+    return hostTestFailures ? 1 : 0;
+}
+
+// Wall clock for benchmark figures, wrapping like micros()
+static inline uint32_t hostMicros() {
+    using namespace std::chrono;
+    return static_cast<uint32_t>(
+        duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+#endif // HOST_TEST_H
@@ -0,0 +1,65 @@
+/**
+ * @file SequencerScenario.h
+ * @brief Pattern set-up shared by the sequencer golden test and benchmarks
+ *
+ * Two patterns that exercise the whole playback path: slides and ties,
+ * ratchets, gate lengths, swing and micro-timing, probability and A:B
+ * conditions, parameter locks, transpose, and a song chain that switches
+ * between them. The content is part of the golden files: changing it
+ * means regenerating them (sequencer_golden_test --update).
+ */
+
+#ifndef SEQUENCER_SCENARIO_H
+#define SEQUENCER_SCENARIO_H
+
+#include <stdint.h>
+#include "sequencer/Sequencer.h"
+
+inline void setUpScenarioPattern(Sequencer& sequencer) {
+    static const uint8_t NOTES[SEQUENCER_NUM_STEPS] = {0, 7, 3, 10, 5, 5, 12, 2, 0, 9, 4, 14, 7, 7, 1, 11};
+
+    // Pattern 0: a 303-style line
+    sequencer.setSwing(58);
+    for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; i++) {
+        sequencer.setStep(i, i % 5 != 3, i % 4 == 1, NOTES[i], 0.4f + 0.035f * i, 0.1f + 0.05f * i);
+        sequencer.setStepGateLength(i, 6 + (i * 5) % 18);
+    }
+    sequencer.setStepRatchets(2, 3);
+    sequencer.setStepRatchets(11, 2);
+    sequencer.setStepMicroTiming(6, -4);
+    sequencer.setStepMicroTiming(14, 5);
+    sequencer.setStepProbability(7, 50);
+    sequencer.setStepProbability(12, 75);
+    sequencer.setStepCondition(10, 2, 4);
+    sequencer.setParamLock(4, SYNTH_PARAM_DECAY, 0.08f);
+    sequencer.setParamLock(8, SYNTH_PARAM_RESONANCE, 0.9f);
+    sequencer.setParamLock(8, SYNTH_PARAM_DRIVE, 0.6f);
+    sequencer.storePattern(0);
+
+    // Pattern 1: sparser, shorter gates, transposed copy of the same line
+    sequencer.storePattern(1);
+    sequencer.selectPattern(1);
+    sequencer.update();
+    sequencer.fillEuclidean(5, 2);
+    for (uint8_t i = 0; i < SEQUENCER_NUM_STEPS; i++) {
+        sequencer.setStepGateLength(i, 4);
+    }
+    sequencer.setStepRatchets(0, 4);
+    sequencer.setParamLock(3, SYNTH_PARAM_GLIDE, 0.02f);
+    sequencer.storePattern(1);
+    sequencer.selectPattern(0);
+    sequencer.update();
+
+    // Song: pattern 0 twice, pattern 1 once
+    PatternChain& chain = sequencer.getChain();
+    chain.setEntry(0, 0, 2);
+    chain.setEntry(1, 1, 1);
+    chain.setLength(2);
+    chain.setSongMode(true);
+
+    sequencer.setTranspose(-5);
+    sequencer.setRandomSeed(0xC0FFEE);
+    sequencer.update();
+}
+
+#endif // SEQUENCER_SCENARIO_H
@@ -0,0 +1,113 @@
+/**
+ * @file clock_dispatch_bench.cpp
+ * @brief Per-tick cost of the ClockManager dispatch paths
+ *
+ * Runs 10^7 ticks on simulated time through each way of reaching the
+ * listeners and reports nanoseconds per tick (deadline scheduling and the
+ * step timer wheel included):
+ *   - static: update(now, ClockListeners<...>), direct calls
+ *   - function pointer: setClockCallback/setStepCallback and update(now)
+ *   - std::function: the callbacks ClockManager used to store, wrapped in
+ *     a listener for comparison
+ * The listeners only count, so the figures are the dispatch overhead.
+ */
+
+#include <stdint.h>
+#include <functional>
+#include "HostTest.h"
+#include "clock/ClockManager.h"
+#include "clock/SimulatedClock.h"
+
+static const uint32_t BENCH_TICKS = 10000000;
+static const int BENCH_ROUNDS = 3;
+
+struct Counts {
+    uint32_t ticks = 0;
+    uint32_t steps = 0;
+};
+
+struct CountingListener {
+    Counts& counts;
+    void onClockTick() { counts.ticks++; }
+    void onClockStep(uint8_t step) { counts.steps += step + 1; }
+    int8_t getStepOffset(uint8_t step) { return (step & 1) ? 2 : 0; }
+};
+
+static void countTick(void* context) { static_cast<Counts*>(context)->ticks++; }
+static void countStep(void* context, uint8_t step) { static_cast<Counts*>(context)->steps += step + 1; }
+static int8_t stepOffset(void*, uint8_t step) { return (step & 1) ? 2 : 0; }
+
+struct FunctionListener {
+    std::function<void()> tick;
+    std::function<void(uint8_t)> step;
+    std::function<int8_t(uint8_t)> offset;
+    void onClockTick() { tick(); }
+    void onClockStep(uint8_t s) { step(s); }
+    int8_t getStepOffset(uint8_t s) { return offset(s); }
+};
+
+// Same loop for every path: jump to the deadline, dispatch
+template <typename Update>
+static double runTicks(ClockManager& clock, SimulatedClock& time, Update update) {
+    const uint32_t started = hostMicros();
+    while (clock.getTickCount() < BENCH_TICKS) {
+        time.advance(clock.getMicrosUntilNextTick(time.micros()));
+        update(time.micros());
+    }
+    return (hostMicros() - started) * 1000.0 / BENCH_TICKS;
+}
+
+static void startClock(ClockManager& clock, SimulatedClock& time) {
+    clock.setBPM(140.0f);
+    time.sync(clock);
+    clock.start();
+}
+
+int main() {
+    double best[3] = {1e9, 1e9, 1e9};
+    Counts expected;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        {
+            Counts counts;
+            SimulatedClock time;
+            ClockManager clock;
+            CountingListener counter{counts};
+            ClockListeners<CountingListener> listeners(counter);
+            startClock(clock, time);
+            const double ns = runTicks(clock, time, [&](uint32_t now) { clock.update(now, listeners); });
+            if (ns < best[0]) best[0] = ns;
+            expected = counts;
+        }
+        {
+            Counts counts;
+            SimulatedClock time;
+            ClockManager clock;
+            clock.setClockCallback(countTick, &counts);
+            clock.setStepCallback(countStep, &counts);
+            clock.setStepOffsetCallback(stepOffset, nullptr);
+            startClock(clock, time);
+            const double ns = runTicks(clock, time, [&](uint32_t now) { clock.update(now); });
+            if (ns < best[1]) best[1] = ns;
+            CHECK(counts.ticks == expected.ticks && counts.steps == expected.steps);
+        }
+        {
+            Counts counts;
+            SimulatedClock time;
+            ClockManager clock;
+            FunctionListener listener{[&] { counts.ticks++; },
+                                      [&](uint8_t step) { counts.steps += step + 1; },
+                                      [](uint8_t step) -> int8_t { return (step & 1) ? 2 : 0; }};
+            startClock(clock, time);
+            const double ns = runTicks(clock, time, [&](uint32_t now) { clock.update(now, listener); });
+            if (ns < best[2]) best[2] = ns;
+            CHECK(counts.ticks == expected.ticks && counts.steps == expected.steps);
+        }
+    }
+
+    printf("Clock dispatch, %u ticks, best of %d (ns per tick)\n", BENCH_TICKS, BENCH_ROUNDS);
+    printf("  static listeners   %6.2f\n", best[0]);
+    printf("  function pointers  %6.2f\n", best[1]);
+    printf("  std::function      %6.2f\n", best[2]);
+    return hostTestResult("clock_dispatch_bench");
+}
@@ -0,0 +1,141 @@
+/**
+ * @file clock_drift_test.cpp
+ * @brief ClockManager keeps an exact tick grid over 10^6 ticks
+ *
+ * Every tick is checked against the exact rational grid
+ *   t(k) = anchor + k * 60e9 / (milliBPM * 96) microseconds (rounded down),
+ * so a single microsecond of accumulated error fails the test. Across
+ * setBPM() the phase within the current tick is kept; the grid then
+ * continues from the rescaled deadline, again exactly.
+ */
+
+#include <stdint.h>
+#include "HostTest.h"
+#include "clock/ClockManager.h"
+#include "clock/SimulatedClock.h"
+
+static const uint64_t MICROS_PER_MINUTE_MILLI = 60000000ULL * 1000ULL;
+static const uint32_t TEST_TICKS = 1000000;
+
+// Exact deadline: whole microseconds plus a fraction over the denominator
+struct ExactGrid {
+    uint64_t anchorWhole = 0;
+    uint64_t anchorFraction = 0;
+    uint64_t denominator = 1;
+    uint32_t firstTick = 0;
+
+    void setTempo(uint32_t milliBPM) { denominator = static_cast<uint64_t>(milliBPM) * CLOCK_PPQN; }
+
+    uint64_t deadline(uint32_t tick) const {
+        const uint64_t numerator = anchorFraction + (tick - firstTick) * MICROS_PER_MINUTE_MILLI;
+        return anchorWhole + numerator / denominator;
+    }
+
+    // Keep the phase within the tick that is running at 'now'
+    void rescale(uint64_t now, uint32_t nextTick, uint32_t newMilliBPM) {
+        const uint64_t numerator = anchorFraction + (nextTick - firstTick) * MICROS_PER_MINUTE_MILLI;
+        const uint64_t remaining = (anchorWhole + numerator / denominator - now) * denominator +
+                                   numerator % denominator;
+        setTempo(newMilliBPM);
+        anchorWhole = now + remaining / denominator;
+        anchorFraction = remaining % denominator;
+        firstTick = nextTick;
+    }
+};
+
+struct GridListener {
+    const SimulatedClock& time;
+    const ClockManager& clock;
+    const ExactGrid& grid;
+    uint32_t errors = 0;
+
+    void onClockTick() {
+        if (time.getTime() != grid.deadline(clock.getTickCount())) {
+            errors++;
+        }
+    }
+    void onClockStep(uint8_t) {}
+    int8_t getStepOffset(uint8_t) { return 0; }
+};
+
+static uint32_t toMilliBPM(float bpm) {
+    return static_cast<uint32_t>(bpm * 1000.0f + 0.5f);
+}
+
+/**
+ * @brief 10^6 ticks at a constant tempo land exactly on the grid
+ */
+static void testConstantTempo(float bpm) {
+    SimulatedClock time;
+    time.advance(12345); // Start off a round number
+    ClockManager clock;
+    clock.setBPM(bpm);
+    time.sync(clock);
+    clock.start();
+
+    ExactGrid grid;
+    grid.setTempo(toMilliBPM(bpm));
+    grid.anchorWhole = time.getTime();
+
+    GridListener listener{time, clock, grid};
+    CHECK(time.runTicks(clock, listener, TEST_TICKS) == TEST_TICKS);
+    CHECK(listener.errors == 0);
+    CHECK(clock.getNextTickTime() == grid.deadline(TEST_TICKS));
+    printf("  %.3f BPM: %u ticks over %.1f s, %u off-grid\n", bpm, TEST_TICKS,
+           (time.getTime() - grid.anchorWhole) / 1e6, listener.errors);
+}
+
+/**
+ * @brief Tempo changes every 50000 ticks (both at a tick and between
+ * ticks); the grid stays exact from each change on
+ */
+static void testTempoChanges() {
+    static const float TEMPOS[] = {120.0f, 133.333f, 97.5f, 174.0f, 60.0f, 300.0f, 20.0f, 128.25f};
+    const uint32_t segmentTicks = 50000;
+
+    SimulatedClock time;
+    ClockManager clock;
+    clock.setBPM(TEMPOS[0]);
+    time.sync(clock);
+    clock.start();
+
+    ExactGrid grid;
+    grid.setTempo(toMilliBPM(TEMPOS[0]));
+    grid.anchorWhole = time.getTime();
+
+    GridListener listener{time, clock, grid};
+    uint32_t segment = 0;
+    uint32_t changes = 0;
+    while (clock.getTickCount() < TEST_TICKS) {
+        time.runTicks(clock, listener, segmentTicks);
+        if (clock.getTickCount() >= TEST_TICKS) break;
+
+        // Every other change falls part-way into the next tick
+        const uint32_t untilNext = clock.getMicrosUntilNextTick(time.micros());
+        if (segment & 1) {
+            time.advance(untilNext / 3);
+            clock.update(time.micros(), listener);
+        }
+        const uint64_t changedAt = time.getTime();
+
+        segment++;
+        const float bpm = TEMPOS[segment % (sizeof(TEMPOS) / sizeof(TEMPOS[0]))];
+        grid.rescale(changedAt, clock.getTickCount(), toMilliBPM(bpm));
+        clock.setBPM(bpm);
+        changes++;
+    }
+
+    CHECK(clock.getTickCount() == TEST_TICKS);
+    CHECK(listener.errors == 0);
+    printf("  %u tempo changes: %u ticks, %u off-grid\n", changes, TEST_TICKS, listener.errors);
+}
+
+int main() {
+    testConstantTempo(120.0f);
+    testConstantTempo(133.333f);
+    testConstantTempo(97.5f);
+    testConstantTempo(300.0f);
+    testConstantTempo(20.0f); // Runs past the 32-bit micros() wrap
+    testTempoChanges();
+    return hostTestResult("clock_drift_test");
+}
@@ -0,0 +1,228 @@
+/**
+ * @file clock_jitter_sim.cpp
+ * @brief External clock sync on simulated time: output jitter and lock
+ *
+ * Feeds ClockManager a pulse train with uniform timestamp jitter, optional
+ * lost pulses and tempo changes, dispatching ticks on simulated time
+ * between pulses. Reports the jitter of the input pulse intervals and of
+ * the output tick intervals (rms deviation from the nominal period, in
+ * microseconds) and the phase error of the ticks against the ideal grid,
+ * measured once the tracker has locked.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include "HostTest.h"
+#include "clock/ClockManager.h"
+#include "clock/SimulatedClock.h"
+#include "sequencer/Generative.h"
+
+struct JitterScenario {
+    const char* name;
+    ClockSource source;
+    uint8_t ppqn;            // Pulses per quarter note of the source
+    float bpm;
+    float jumpToBpm;         // Tempo after half the run, 0 for none
+    uint32_t jitterMicros;   // Timestamps move by up to +/- this much
+    uint32_t dropEvery;      // Every n-th pulse is lost, 0 for none
+    float syncGain;          // Tracker alpha, 0 for the default
+    uint32_t pulses;
+};
+
+struct JitterResult {
+    double inputIntervalRms = 0.0;
+    double outputIntervalRms = 0.0;
+    double phaseRms = 0.0;
+    double phaseMax = 0.0;
+    uint32_t ticks = 0;
+    uint32_t expectedTicks = 0;
+    uint32_t reacquires = 0;
+    float finalBpm = 0.0f;
+};
+
+// Accumulates the rms of a series of deviations
+struct Rms {
+    double sum = 0.0;
+    uint32_t count = 0;
+    void add(double value) { sum += value * value; count++; }
+    double get() const { return count ? sqrt(sum / count) : 0.0; }
+};
+
+struct TickRecorder {
+    explicit TickRecorder(const SimulatedClock& time) : time(time) {}
+
+    const SimulatedClock& time;
+    double idealStart = 0.0;    // Ideal time of tick 0
+    double idealPeriod = 0.0;   // Ideal tick period
+    uint32_t measureFrom = 0;   // First tick measured (after lock)
+    uint32_t measureTo = 0;     // Ticks from here on belong to another tempo
+    uint32_t ticks = 0;
+    uint64_t lastTime = 0;
+    Rms interval;
+    Rms phase;
+    double phaseMax = 0.0;
+
+    void onClockTick() {
+        const uint64_t now = time.getTime();
+        if (ticks > measureFrom && ticks < measureTo) {
+            interval.add(static_cast<double>(now - lastTime) - idealPeriod);
+            const double error = static_cast<double>(now) - (idealStart + ticks * idealPeriod);
+            phase.add(error);
+            if (fabs(error) > phaseMax) phaseMax = fabs(error);
+        }
+        lastTime = now;
+        ticks++;
+    }
+    void onClockStep(uint8_t) {}
+    int8_t getStepOffset(uint8_t) { return 0; }
+};
+
+static JitterResult runScenario(const JitterScenario& scenario) {
+    SimulatedClock time;
+    time.advance(1000);
+    ClockManager clock;
+    clock.setBPM(scenario.bpm);
+    if (scenario.source == CLOCK_SOURCE_ANALOG) {
+        clock.setAnalogClockPPQN(scenario.ppqn);
+    }
+    clock.setClockSource(scenario.source);
+    if (scenario.syncGain > 0.0f) {
+        clock.setSyncGain(scenario.syncGain);
+    }
+    time.sync(clock);
+    clock.start();
+
+    const uint8_t ticksPerPulse = CLOCK_PPQN / scenario.ppqn;
+    double pulsePeriod = 60e6 / (scenario.bpm * scenario.ppqn);
+    const uint32_t jumpAt = scenario.jumpToBpm > 0.0f ? scenario.pulses / 2 : scenario.pulses;
+
+    // The first pulse is sent without jitter so tick 0 has a known ideal time
+    const double firstPulse = 5000.0;
+    TickRecorder recorder(time);
+    recorder.idealStart = firstPulse;
+    recorder.idealPeriod = pulsePeriod / ticksPerPulse;
+    recorder.measureFrom = 8 * CLOCK_PPQN; // Two bars to lock
+    recorder.measureTo = jumpAt * ticksPerPulse;
+
+    Xorshift32 rng(12345);
+    Rms inputInterval;
+    double idealPulse = firstPulse;
+    double lastSent = 0.0;
+    bool previousSent = false;
+    bool locked = false;
+    uint32_t lockedGeneration = 0;
+    JitterResult result;
+
+    for (uint32_t pulse = 0; pulse < scenario.pulses; pulse++) {
+        if (pulse == jumpAt) {
+            pulsePeriod = 60e6 / (scenario.jumpToBpm * scenario.ppqn);
+        }
+        if (pulse > 0) {
+            idealPulse += pulsePeriod;
+        }
+        const double jitter = pulse == 0 ? 0.0 :
+            static_cast<double>(rng.range(-static_cast<int32_t>(scenario.jitterMicros),
+                                          static_cast<int32_t>(scenario.jitterMicros) + 1));
+        const uint64_t pulseAt = static_cast<uint64_t>(idealPulse + jitter);
+        const bool dropped = scenario.dropEvery && pulse > 0 && pulse % scenario.dropEvery == 0;
+
+        // Dispatch the ticks due before the pulse; stop when the clock is
+        // waiting for the pulse
+        for (;;) {
+            const uint32_t before = clock.getTickCount();
+            clock.update(time.micros(), recorder);
+            if (clock.getTickCount() != before) continue;
+            const uint32_t wait = clock.getMicrosUntilNextTick(time.micros());
+            if (wait == 0 || time.getTime() + wait >= pulseAt) break;
+            time.advance(wait);
+        }
+        time.advance(static_cast<uint32_t>(pulseAt - time.getTime()));
+        if (dropped) {
+            previousSent = false;
+            continue;
+        }
+
+        if (previousSent && pulse < jumpAt) {
+            inputInterval.add(static_cast<double>(pulseAt) - lastSent - pulsePeriod);
+        }
+        lastSent = static_cast<double>(pulseAt);
+        previousSent = true;
+
+        clock.onExternalPulse(time.micros());
+        if (!locked && clock.isExternalLocked()) {
+            locked = true;
+            lockedGeneration = clock.getTracker().getGeneration();
+        }
+    }
+    if (locked) {
+        result.reacquires = clock.getTracker().getGeneration() - lockedGeneration;
+    }
+
+    result.inputIntervalRms = inputInterval.get();
+    result.outputIntervalRms = recorder.interval.get();
+    result.phaseRms = recorder.phase.get();
+    result.phaseMax = recorder.phaseMax;
+    result.ticks = recorder.ticks;
+    result.expectedTicks = (scenario.pulses - 1) * ticksPerPulse;
+    result.finalBpm = clock.getBPM();
+    return result;
+}
+
+static JitterResult report(const JitterScenario& scenario) {
+    const JitterResult r = runScenario(scenario);
+    printf("  %-28s in %6.1f us rms | out %5.1f us rms, phase %5.1f rms %6.1f max | "
+           "%u/%u ticks, %u re-acquires, %.2f BPM\n",
+           scenario.name, r.inputIntervalRms, r.outputIntervalRms, r.phaseRms, r.phaseMax,
+           r.ticks, r.expectedTicks, r.reacquires, r.finalBpm);
+    return r;
+}
+
+int main() {
+    printf("External clock jitter (interval rms = deviation from the nominal period)\n");
+
+    // MIDI clock with +/-1ms of timestamp jitter (USB polling, busy host)
+    JitterScenario midi = {"MIDI 128 BPM +/-1ms", CLOCK_SOURCE_MIDI, MIDI_CLOCK_PPQN,
+                           128.0f, 0.0f, 1000, 0, 0.0f, 24 * 4 * 64};
+    JitterResult r = report(midi);
+    CHECK(r.outputIntervalRms < r.inputIntervalRms / 20.0);
+    CHECK(r.reacquires == 0);
+    CHECK(r.ticks + CLOCK_PPQN / MIDI_CLOCK_PPQN >= r.expectedTicks);
+    CHECK(fabs(r.finalBpm - 128.0f) < 0.5f);
+
+    midi.name = "MIDI 128 BPM +/-1ms, a=0.02";
+    midi.syncGain = 0.02f;
+    JitterResult smooth = report(midi);
+    CHECK(smooth.outputIntervalRms < r.outputIntervalRms);
+
+    // One lost MIDI clock pulse in every 50 is bridged, not re-acquired
+    JitterScenario lossy = {"MIDI 120 BPM, 1 in 50 lost", CLOCK_SOURCE_MIDI, MIDI_CLOCK_PPQN,
+                            120.0f, 0.0f, 200, 50, 0.0f, 24 * 4 * 64};
+    r = report(lossy);
+    CHECK(r.reacquires == 0);
+    CHECK(r.phaseMax < 1000.0);
+    CHECK(r.ticks + CLOCK_PPQN / MIDI_CLOCK_PPQN >= r.expectedTicks);
+
+    // Tempo jumps: the tracker re-acquires and follows. Half tempo looks
+    // like every other pulse lost and must not be bridged.
+    JitterScenario jump = {"MIDI 120 -> 90 BPM", CLOCK_SOURCE_MIDI, MIDI_CLOCK_PPQN,
+                           120.0f, 90.0f, 200, 0, 0.0f, 24 * 4 * 64};
+    r = report(jump);
+    CHECK(fabs(r.finalBpm - 90.0f) < 0.5f);
+    CHECK(r.ticks <= r.expectedTicks + 2 * CLOCK_PPQN / MIDI_CLOCK_PPQN);
+
+    jump.name = "MIDI 120 -> 60 BPM";
+    jump.jumpToBpm = 60.0f;
+    r = report(jump);
+    CHECK(fabs(r.finalBpm - 60.0f) < 0.5f);
+    CHECK(r.ticks <= r.expectedTicks + 2 * CLOCK_PPQN / MIDI_CLOCK_PPQN);
+
+    // Analog clock input at 4 PPQN (sixteenths) with +/-500us of jitter
+    JitterScenario analog = {"Clock in 4 PPQN 100 BPM", CLOCK_SOURCE_ANALOG, 4,
+                             100.0f, 0.0f, 500, 0, 0.0f, 4 * 4 * 64};
+    r = report(analog);
+    CHECK(r.outputIntervalRms < r.inputIntervalRms / 20.0);
+    CHECK(r.reacquires == 0);
+    CHECK(fabs(r.finalBpm - 100.0f) < 0.5f);
+
+    return hostTestResult("clock_jitter_sim");
+}
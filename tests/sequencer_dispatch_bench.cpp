@@ -0,0 +1,50 @@
+/**
+ * @file sequencer_dispatch_bench.cpp
+ * @brief Step throughput of the virtual and the templated playback path
+ *
+ * Plays SequencerScenario through SequencerSimulation with the I/O in
+ * count-only mode, so only the sequencer is timed. Each round runs both
+ * dispatch modes back to back (alternating which goes first) and the best
+ * round of each is reported in steps per second. Both modes must produce
+ * the same events.
+ */
+
+#include <stdint.h>
+#include "HostTest.h"
+#include "SequencerScenario.h"
+#include "sequencer/SequencerSimulation.h"
+
+static const uint32_t BENCH_BARS = 20000;
+static const int BENCH_ROUNDS = 5;
+
+int main() {
+    Quantizer quantizer;
+    static SequencerSimulation virtualSim(quantizer);
+    static SequencerSimulation directSim(quantizer);
+    SequencerSimulation* sims[2] = {&virtualSim, &directSim};
+    for (int mode = 0; mode < 2; mode++) {
+        sims[mode]->setDispatch(static_cast<SimulationDispatch>(mode));
+        sims[mode]->getIO().setCountOnly(true);
+        setUpScenarioPattern(sims[mode]->getSequencer());
+    }
+
+    float best[2] = {0.0f, 0.0f};
+    uint32_t events[2] = {0, 0};
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < 2; i++) {
+            const int mode = (round + i) & 1;
+            sims[mode]->begin(132.0f);
+            const SimulationResult result = sims[mode]->runBars(BENCH_BARS, hostMicros);
+            CHECK(result.valid);
+            events[mode] = result.events;
+            if (result.stepsPerSecond() > best[mode]) best[mode] = result.stepsPerSecond();
+        }
+    }
+    CHECK(events[SIM_DISPATCH_VIRTUAL] == events[SIM_DISPATCH_DIRECT]);
+
+    printf("Sequencer playback, %u bars, best of %d (steps per second)\n", BENCH_BARS, BENCH_ROUNDS);
+    printf("  virtual SequencerIO   %9.0f\n", best[SIM_DISPATCH_VIRTUAL]);
+    printf("  BasicSequencer<IO>    %9.0f  (%+.1f%%)\n", best[SIM_DISPATCH_DIRECT],
+           (best[SIM_DISPATCH_DIRECT] / best[SIM_DISPATCH_VIRTUAL] - 1.0f) * 100.0f);
+    return hostTestResult("sequencer_dispatch_bench");
+}
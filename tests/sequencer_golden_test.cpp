@@ -0,0 +1,179 @@
+/**
+ * @file sequencer_golden_test.cpp
+ * @brief Sequencer event stream against checked-in golden files
+ *
+ * Runs SequencerScenario on simulated time and compares:
+ *   - the first GOLDEN_BARS bars, written as text lines, with
+ *     golden/sequencer_events.txt (the first differing line is printed),
+ *   - the digest, event and step counts of a LONG_BARS run with
+ *     golden/sequencer_digest.txt.
+ * The same scenario runs through the virtual and the direct (templated)
+ * dispatch, which must give the same stream. The long run reports steps
+ * per second.
+ *
+ * Usage: sequencer_golden_test [--update] [golden directory]
+ * --update rewrites the golden files from the current code; review the
+ * diff before committing them. The event stream is also written to
+ * build/sequencer_events.txt for inspection.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "HostTest.h"
+#include "SequencerScenario.h"
+#include "sequencer/SequencerSimulation.h"
+
+static const uint32_t GOLDEN_BARS = 8;
+static const uint32_t LONG_BARS = 5000;
+static const float SCENARIO_BPM = 132.0f;
+
+static void writeLine(void* file, const SequencerEvent& event) {
+    char line[64];
+    formatSequencerEvent(event, line, sizeof(line));
+    fprintf(static_cast<FILE*>(file), "%s\n", line);
+}
+
+/**
+ * @brief Run the golden bars: two bars of recorded filter motion, then
+ * playback with the sensor moving
+ */
+static SimulationResult runGoldenBars(SequencerSimulation& sim, FILE* events) {
+    sim.getIO().setSink(events ? writeLine : nullptr, events);
+    sim.begin(SCENARIO_BPM);
+
+    SimulationResult result;
+    Sequencer& sequencer = sim.getSequencer();
+    sequencer.armMotionRecord(MOTION_DEST_FILTER);
+    for (uint32_t bar = 0; bar < GOLDEN_BARS; bar++) {
+        sim.getIO().setDistanceMM(80 + 37 * bar);
+        if (bar == 2) {
+            sequencer.disarmMotionRecord();
+        }
+        const SimulationResult part = sim.runBars(1);
+        result.steps += part.steps;
+        result.events += part.events;
+        result.valid = result.valid && part.valid;
+        result.digest = part.digest;
+    }
+    sim.getIO().setSink(nullptr);
+    return result;
+}
+
+/**
+ * @brief Line-by-line comparison; prints the first difference
+ */
+static bool compareFiles(const char* actualPath, const char* goldenPath) {
+    FILE* actual = fopen(actualPath, "r");
+    FILE* golden = fopen(goldenPath, "r");
+    bool same = actual && golden;
+    if (!golden) {
+        printf("  missing %s (run with --update)\n", goldenPath);
+    }
+    char a[128];
+    char g[128];
+    uint32_t line = 0;
+    while (same) {
+        const bool moreActual = fgets(a, sizeof(a), actual) != nullptr;
+        const bool moreGolden = fgets(g, sizeof(g), golden) != nullptr;
+        line++;
+        if (!moreActual && !moreGolden) break;
+        if (moreActual != moreGolden || strcmp(a, g) != 0) {
+            printf("  %s:%u differs\n    expected: %s    actual:   %s", goldenPath, line,
+                   moreGolden ? g : "(end)\n", moreActual ? a : "(end)\n");
+            same = false;
+        }
+    }
+    if (actual) fclose(actual);
+    if (golden) fclose(golden);
+    return same;
+}
+
+static bool copyFile(const char* from, const char* to) {
+    FILE* in = fopen(from, "r");
+    FILE* out = fopen(to, "w");
+    if (!in || !out) {
+        if (in) fclose(in);
+        if (out) fclose(out);
+        return false;
+    }
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, length, out);
+    }
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool update = false;
+    const char* goldenDir = "golden";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            goldenDir = argv[i];
+        }
+    }
+    char eventsGolden[256];
+    char digestGolden[256];
+    snprintf(eventsGolden, sizeof(eventsGolden), "%s/sequencer_events.txt", goldenDir);
+    snprintf(digestGolden, sizeof(digestGolden), "%s/sequencer_digest.txt", goldenDir);
+    const char* eventsActual = "build/sequencer_events.txt";
+
+    Quantizer quantizer;
+
+    // Event stream of the first bars
+    static SequencerSimulation sim(quantizer);
+    setUpScenarioPattern(sim.getSequencer());
+    FILE* events = fopen(eventsActual, "w");
+    CHECK(events != nullptr);
+    const SimulationResult golden = runGoldenBars(sim, events);
+    if (events) fclose(events);
+    CHECK(golden.valid);
+    printf("  %u bars: %u steps, %u events, digest %08x\n", GOLDEN_BARS, golden.steps,
+           golden.events, golden.digest);
+
+    // The virtual dispatch plays the same stream
+    static SequencerSimulation virtualSim(quantizer);
+    virtualSim.setDispatch(SIM_DISPATCH_VIRTUAL);
+    setUpScenarioPattern(virtualSim.getSequencer());
+    CHECK(runGoldenBars(virtualSim, nullptr).digest == golden.digest);
+
+    // Long run, continuing from the golden bars
+    const SimulationResult longRun = sim.runBars(LONG_BARS, hostMicros);
+    CHECK(longRun.valid);
+    printf("  %u more bars: %u steps, %u events, digest %08x, %.0f steps/s\n", LONG_BARS,
+           longRun.steps, longRun.events, longRun.digest, longRun.stepsPerSecond());
+
+    char digestLine[96];
+    snprintf(digestLine, sizeof(digestLine), "%08x %u %u %08x %u %u\n", golden.digest,
+             golden.steps, golden.events, longRun.digest, longRun.steps, longRun.events);
+
+    if (update) {
+        CHECK(copyFile(eventsActual, eventsGolden));
+        FILE* file = fopen(digestGolden, "w");
+        CHECK(file != nullptr);
+        if (file) {
+            fputs(digestLine, file);
+            fclose(file);
+        }
+        printf("  golden files updated in %s\n", goldenDir);
+        return hostTestResult("sequencer_golden_test");
+    }
+
+    CHECK(compareFiles(eventsActual, eventsGolden));
+    char expected[96] = "";
+    FILE* file = fopen(digestGolden, "r");
+    if (file) {
+        if (!fgets(expected, sizeof(expected), file)) expected[0] = '\0';
+        fclose(file);
+    }
+    if (strcmp(expected, digestLine) != 0) {
+        printf("  %s\n    expected: %s    actual:   %s", digestGolden, expected[0] ? expected : "(none)\n",
+               digestLine);
+    }
+    CHECK(strcmp(expected, digestLine) == 0);
+    return hostTestResult("sequencer_golden_test");
+}
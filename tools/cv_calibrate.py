@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+cv_calibrate.py - Fit CV output calibration tables for CVOutput.
+
+Measure each CV output with a voltmeter at a handful of duty codes (write
+the code with analogWrite at 16-bit range, or use the identity table and the
+serial console) and record the readings in a CSV file:
+
+    channel,code,volts
+    0,0,0.012
+    0,16384,1.262
+    0,32768,2.509
+    ...
+
+For every channel the script fits a straight line (gain and offset, reported
+for reference) and builds the inverse of the measured curve by piecewise
+linear interpolation: breakpoint i receives the duty code that produces
+i/SEGMENTS of full scale. Targets outside the measured span are extrapolated
+from the linear fit. The result is written as src/audio/CVCalibrationData.h.
+
+Usage:
+    tools/cv_calibrate.py measurements.csv -o src/audio/CVCalibrationData.h
+    tools/cv_calibrate.py --identity -o src/audio/CVCalibrationData.h
+"""
+
+import argparse
+import csv
+import sys
+
+CHANNELS = 4
+SEGMENTS = 16            # Must match CV_CAL_SEGMENTS in CVOutput.h
+FULL_SCALE_CODE = 65535  # Must match CV_CODE_FULL_SCALE
+CHANNEL_NAMES = ["Pitch", "Velocity", "Filter", "Envelope"]
+
+
+def read_measurements(path):
+    data = {ch: [] for ch in range(CHANNELS)}
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            ch = int(row["channel"])
+            if ch not in data:
+                raise ValueError("channel %d out of range" % ch)
+            data[ch].append((int(row["code"]), float(row["volts"])))
+    return data
+
+
+def linear_fit(points):
+    """Least-squares volts = gain * code + offset."""
+    n = len(points)
+    sx = sum(c for c, _ in points)
+    sy = sum(v for _, v in points)
+    sxx = sum(c * c for c, _ in points)
+    sxy = sum(c * v for c, v in points)
+    det = n * sxx - sx * sx
+    if det == 0:
+        raise ValueError("need at least two distinct codes per channel")
+    gain = (n * sxy - sx * sy) / det
+    offset = (sy - gain * sx) / n
+    return gain, offset
+
+
+def fit_channel(points, full_scale_volts):
+    points = sorted(points)
+    gain, offset = linear_fit(points)
+    if gain <= 0:
+        raise ValueError("output does not rise with the duty code")
+    for (c0, v0), (c1, v1) in zip(points, points[1:]):
+        if v1 <= v0:
+            raise ValueError("measurements are not monotonic near code %d" % c1)
+
+    table = []
+    for i in range(SEGMENTS + 1):
+        target = full_scale_volts * i / SEGMENTS
+        code = None
+        for (c0, v0), (c1, v1) in zip(points, points[1:]):
+            if v0 <= target <= v1:
+                code = c0 + (target - v0) * (c1 - c0) / (v1 - v0)
+                break
+        if code is None:
+            code = (target - offset) / gain
+        table.append(min(max(int(round(code)), 0), FULL_SCALE_CODE))
+
+    residual = max(abs(v - (gain * c + offset)) for c, v in points)
+    return table, gain, offset, residual
+
+
+def identity_table():
+    return [(i * FULL_SCALE_CODE + SEGMENTS // 2) // SEGMENTS for i in range(SEGMENTS + 1)]
+
+
+def write_header(path, tables, source):
+    lines = [
+        "/**",
+        " * @file CVCalibrationData.h",
+        " * @brief CV output calibration tables (generated by tools/cv_calibrate.py)",
+        " *",
+        " * Source: %s" % source,
+        " * Breakpoint i is the 16-bit duty code for i/%d of full scale." % SEGMENTS,
+        " */",
+        "",
+        "#ifndef CV_CALIBRATION_DATA_H",
+        "#define CV_CALIBRATION_DATA_H",
+        "",
+        '#include "CVOutput.h"',
+        "",
+        "static const uint16_t CV_CALIBRATION_DEFAULT[CV_OUTPUT_CHANNELS][CV_CAL_POINTS] = {",
+    ]
+    for ch, table in enumerate(tables):
+        lines.append("    // %s" % CHANNEL_NAMES[ch])
+        lines.append("    {" + ", ".join(str(v) for v in table[:9]) + ",")
+        lines.append("     " + ", ".join(str(v) for v in table[9:]) + "},")
+    lines += ["};", "", "#endif // CV_CALIBRATION_DATA_H", ""]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("csv", nargs="?", help="measurement CSV (channel,code,volts)")
+    parser.add_argument("-o", "--output", default="src/audio/CVCalibrationData.h")
+    parser.add_argument("--full-scale", type=float, default=5.0,
+                        help="ideal full-scale output voltage (default 5.0)")
+    parser.add_argument("--identity", action="store_true",
+                        help="write uncalibrated (linear) tables")
+    args = parser.parse_args()
+
+    if args.identity:
+        write_header(args.output, [identity_table()] * CHANNELS, "identity (uncalibrated)")
+        return 0
+    if not args.csv:
+        parser.error("a measurement CSV is required unless --identity is given")
+
+    data = read_measurements(args.csv)
+    tables = []
+    for ch in range(CHANNELS):
+        if len(data[ch]) < 2:
+            print("%-8s no measurements, using identity" % CHANNEL_NAMES[ch])
+            tables.append(identity_table())
+            continue
+        table, gain, offset, residual = fit_channel(data[ch], args.full_scale)
+        print("%-8s gain %.4f V/FS  offset %+.4f V  max linear residual %.4f V"
+              % (CHANNEL_NAMES[ch], gain * FULL_SCALE_CODE, offset, residual))
+        tables.append(table)
+
+    write_header(args.output, tables, args.csv)
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except ValueError as e:
+        sys.exit("error: %s" % e)